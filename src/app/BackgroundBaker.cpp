@@ -0,0 +1,103 @@
+#include "app/BackgroundBaker.hpp"
+
+#include "scene/SceneExporter.hpp"
+#include "scene/UiBinWriter.hpp"
+
+#include <QTimer>
+
+namespace
+{
+    constexpr int kPollMs = 100;
+}
+
+BackgroundBaker::BackgroundBaker(QObject* parent) : QObject(parent)
+{
+    poll = new QTimer(this);
+    poll->setInterval(kPollMs);
+    connect(poll, &QTimer::timeout, this, &BackgroundBaker::Poll);
+
+    pool.setMaxThreadCount(1);
+    pool.setExpiryTimeout(-1);
+}
+
+BackgroundBaker::~BackgroundBaker()
+{
+    // The worker uses the mirror, bakeCache and progress; stop it before
+    // they go, and drop the mirror on the thread its objects live on.
+    progress.Cancel();
+    pool.start([this]() { mirror.Clear(); });
+    pool.waitForDone();
+}
+
+QString BackgroundBaker::PhaseName(BakeProgress::Phase phase)
+{
+    switch (phase)
+    {
+    case BakeProgress::PHASE_LOAD:     return QStringLiteral("Loading");
+    case BakeProgress::PHASE_ENCODE:   return QStringLiteral("Encoding");
+    case BakeProgress::PHASE_FINISH:   return QStringLiteral("Writing");
+    case BakeProgress::PHASE_VALIDATE: return QStringLiteral("Validating");
+    case BakeProgress::PHASE_DONE:     return QStringLiteral("Done");
+    default:                           return QString();
+    }
+}
+
+bool BackgroundBaker::Start(const SceneDocument* doc, const QString& filePath)
+{
+    if (running || !doc)
+        return false;
+
+    // The only step on the GUI thread: the worker sees the snapshot, never
+    // the live tree the editor keeps changing.
+    const SceneSnapshot snapshot = snapshotter.Take(doc);
+
+    progress.Reset();
+    running = true;
+    poll->start();
+    Poll();
+
+    pool.start([this, snapshot, filePath]()
+    {
+        progress.Begin(BakeProgress::PHASE_LOAD);
+
+        SceneExporter::BakeStats stats;
+        bool ok = false;
+
+        QString error;
+        if (!mirror.Update(snapshot, &error))
+            stats.error = QStringLiteral("cannot load the document snapshot: ") + error;
+        else if (progress.IsCancelled())
+        {
+            stats.cancelled = true;
+            stats.error = QStringLiteral("cancelled");
+        }
+        else
+        {
+            UiBinWriteOptions options;
+            options.bakeCache = &bakeCache;
+            options.progress = &progress;
+            ok = SceneExporter::BakeToUiBin(mirror.Document(), filePath, &stats, true, options);
+        }
+
+        // Last touch of this object from the worker.
+        QMetaObject::invokeMethod(this, [this, filePath, ok, stats]()
+        {
+            running = false;
+            poll->stop();
+            emit Finished(filePath, ok, stats.cancelled, stats.error, stats.bytes);
+        }, Qt::QueuedConnection);
+    });
+
+    return true;
+}
+
+void BackgroundBaker::Cancel()
+{
+    if (running)
+        progress.Cancel();
+}
+
+void BackgroundBaker::Poll()
+{
+    emit Progress(progress.Permille(), PhaseName(progress.CurrentPhase()));
+}
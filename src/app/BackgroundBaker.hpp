@@ -0,0 +1,68 @@
+#ifndef APP_BACKGROUNDBAKER_HPP
+#define APP_BACKGROUNDBAKER_HPP
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+#include "scene/BakeCache.hpp"
+#include "scene/BakeProgress.hpp"
+#include "scene/SceneMirror.hpp"
+
+class QTimer;
+class SceneDocument;
+
+// File>Bake off the GUI thread. Start takes a SceneSnapshot (the same plain
+// representation the live link uses) and returns at once; a worker brings
+// its SceneMirror up to date from it and runs SceneExporter::BakeToUiBin on
+// the mirror, so encode, write, validate and rename all happen away from
+// the editor, which stays free to edit meanwhile.
+// Progress is polled from a BakeProgress while the bake runs.
+//
+// Cancel takes effect at the writer's next checkpoint, or before the
+// rename; either way the existing file at the target path is left alone.
+// At most one bake runs at a time.
+class BackgroundBaker : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    explicit BackgroundBaker(QObject* parent = nullptr);
+    ~BackgroundBaker() override;
+
+    // Returns false if a bake is already running.
+    bool Start(const SceneDocument* doc, const QString& filePath);
+    void Cancel();
+    bool IsRunning() const { return running; }
+
+    static QString PhaseName(BakeProgress::Phase phase);
+
+signals:
+
+    // permille is 0..1000; phase is PhaseName of the current phase.
+    void Progress(int permille, const QString& phase);
+
+    // Exactly once per successful Start. bytes is the size of the .uibin.
+    void Finished(const QString& filePath, bool ok, bool cancelled, const QString& error, qint64 bytes);
+
+private:
+
+    void Poll();
+
+    QTimer* poll = nullptr;
+    bool running = false;
+
+    SceneSnapshotter snapshotter;       // GUI thread
+
+    // Worker state: one thread that never expires, so the mirror's objects
+    // stay on it and nothing is shared between bakes. The mirror keeps
+    // unchanged components (and their revisions) alive, so the cache keeps
+    // repeated bakes of the session incremental.
+    QThreadPool pool;
+    SceneMirror mirror;
+    BakeCache bakeCache;
+    BakeProgress progress;
+};
+
+#endif
@@ -0,0 +1,412 @@
+#include "app/LiveLinkServer.hpp"
+
+#include "scene/LiveLinkFrame.hpp"
+#include "scene/SceneDocument.hpp"
+#include "scene/SceneExporter.hpp"
+#include "scene/UiBinCommon.hpp"
+#include "scene/UiBinPatch.hpp"
+#include "scene/UiBinWriter.hpp"
+
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSet>
+#include <QTimer>
+
+namespace
+{
+    constexpr int kDefaultDebounceMs = 50;
+
+    QString FormatBytes(qint64 n)
+    {
+        if (n < 1024)
+            return QString::number(n) + " B";
+        if (n < 1024 * 1024)
+            return QString::number(double(n) / 1024.0, 'f', 1) + " KB";
+        return QString::number(double(n) / (1024.0 * 1024.0), 'f', 1) + " MB";
+    }
+}
+
+LiveLinkServer::LiveLinkServer(QObject* parent) : QObject(parent)
+{
+    debounce = new QTimer(this);
+    debounce->setSingleShot(true);
+    debounce->setInterval(kDefaultDebounceMs);
+    connect(debounce, &QTimer::timeout, this, &LiveLinkServer::StartBake);
+
+    // Replacing an image or font on disk is an edit too. Editors that save by
+    // rename drop the file from the watcher; every bake re-adds the set.
+    watcher = new QFileSystemWatcher(this);
+    connect(watcher, &QFileSystemWatcher::fileChanged, this, &LiveLinkServer::DocumentEdited);
+
+    pool.setMaxThreadCount(1);
+    pool.setExpiryTimeout(-1);
+}
+
+LiveLinkServer::~LiveLinkServer()
+{
+    // The worker uses the mirror, bakeCache and tempDir; let it finish
+    // before they go, and drop the mirror on the thread it lives on.
+    pool.start([this]() { mirror.Clear(); });
+    pool.waitForDone();
+}
+
+bool LiveLinkServer::Start(const QString& serverName, QString* error)
+{
+    if (server)
+        return true;
+
+    if (!tempDir.isValid())
+    {
+        if (error) *error = QStringLiteral("cannot create a temporary directory for bakes");
+        return false;
+    }
+
+    const QString name = serverName.isEmpty() ? QString::fromLatin1(uibin::kLiveLinkServerName) : serverName;
+
+    server = new QLocalServer(this);
+
+    // A crashed editor leaves a stale socket file behind on Unix.
+    QLocalServer::removeServer(name);
+    if (!server->listen(name))
+    {
+        if (error) *error = server->errorString();
+        delete server;
+        server = nullptr;
+        return false;
+    }
+
+    connect(server, &QLocalServer::newConnection, this, &LiveLinkServer::OnNewConnection);
+
+    DocumentEdited();
+    return true;
+}
+
+void LiveLinkServer::Stop()
+{
+    if (!server)
+        return;
+
+    debounce->stop();
+
+    for (auto it = clients.begin(); it != clients.end(); ++it)
+    {
+        it.key()->disconnect(this);
+        it.key()->abort();
+        it.key()->deleteLater();
+    }
+    clients.clear();
+
+    server->close();
+    server->deleteLater();
+    server = nullptr;
+
+    if (!watcher->files().isEmpty())
+        watcher->removePaths(watcher->files());
+
+    // Nobody holds anything any more; the next start pushes a full bake.
+    current.clear();
+    currentPatch.clear();
+    currentHash = 0;
+    patchBase = 0;
+    pendingEditMs = 0;
+}
+
+bool LiveLinkServer::IsRunning() const
+{
+    return server != nullptr;
+}
+
+void LiveLinkServer::SetDocument(const SceneDocument* doc)
+{
+    document = doc;
+    DocumentEdited();
+}
+
+void LiveLinkServer::SetDebounce(int ms)
+{
+    debounce->setInterval(qMax(0, ms));
+}
+
+int LiveLinkServer::ClientCount() const
+{
+    return clients.size();
+}
+
+void LiveLinkServer::DocumentEdited()
+{
+    if (!server || !document)
+        return;
+
+    if (pendingEditMs == 0)
+        pendingEditMs = QDateTime::currentMSecsSinceEpoch();
+
+    debounce->start();
+}
+
+// ---------------------------------------------------------------------------
+// Background bake. The GUI thread only snapshots the tree; updating the
+// mirror, encoding, and diffing against the previous bake all happen on the
+// worker, which touches nothing the editor owns.
+// ---------------------------------------------------------------------------
+
+void LiveLinkServer::StartBake()
+{
+    if (!server || !document)
+        return;
+
+    if (baking)
+    {
+        rebake = true;
+        return;
+    }
+
+    const SceneSnapshot snapshot = snapshotter.Take(document);
+    const QString path = tempDir.filePath(QStringLiteral("live.uibin"));
+    const QByteArray previous = current;
+    const quint64 previousHash = currentHash;
+    const qint64 editMs = pendingEditMs;
+
+    pendingEditMs = 0;
+    baking = true;
+
+    pool.start([this, snapshot, path, previous, previousHash, editMs]()
+    {
+        BakeResult r;
+        r.editMs = editMs;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        UiBinWriteOptions options;
+        options.bakeCache = &bakeCache;
+
+        QString error;
+        if (!mirror.Update(snapshot, &error))
+            r.error = QStringLiteral("cannot load the document snapshot: ") + error;
+        else if (!UiBinWriter::Write(mirror.Document(), path, options))
+            r.error = QStringLiteral("bake failed");
+        else
+        {
+            QFile f(path);
+            if (f.open(QIODevice::ReadOnly))
+                r.bytes = f.readAll();
+            else
+                r.error = QStringLiteral("cannot read the bake back");
+        }
+
+        r.bakeNs = timer.nsecsElapsed();
+        r.reloaded = mirror.Reloaded();
+
+        if (r.error.isEmpty())
+        {
+            r.ok = true;
+            r.hash = uibin::Hash64(r.bytes.constData(), r.bytes.size());
+
+            // A patch only pays off if it is smaller than the bake itself.
+            if (!previous.isEmpty() && previousHash != r.hash)
+            {
+                timer.restart();
+                const QByteArray patch = UiBinPatch::Diff(previous, r.bytes);
+                r.diffNs = timer.nsecsElapsed();
+
+                if (!patch.isEmpty() && patch.size() < r.bytes.size())
+                {
+                    r.patch = patch;
+                    r.baseHash = previousHash;
+                }
+            }
+
+            QSet<QString> assets;
+            for (const SceneSnapshot::Element& e : snapshot.elements)
+                for (const SceneSnapshot::Comp& c : e.comps)
+                    SceneExporter::CollectComponentAssetPaths(c.json, assets);
+
+            const QString& baseDir = snapshot.baseDir;
+            for (const QString& p : assets)
+            {
+                const QString abs = (QDir::isAbsolutePath(p) || baseDir.isEmpty()) ? p : QDir(baseDir).filePath(p);
+                if (QFileInfo::exists(abs))
+                    r.assets.append(abs);
+            }
+        }
+
+        QMetaObject::invokeMethod(this, [this, r]() { FinishBake(r); }, Qt::QueuedConnection);
+    });
+}
+
+void LiveLinkServer::FinishBake(const BakeResult& result)
+{
+    baking = false;
+
+    if (!server)
+        return;
+
+    if (!result.ok)
+    {
+        emit StatusChanged(QStringLiteral("Live link: ") + result.error);
+    }
+    else if (result.hash != currentHash)
+    {
+        current = result.bytes;
+        currentHash = result.hash;
+        currentPatch = result.patch;
+        patchBase = result.baseHash;
+        currentEditMs = result.editMs;
+
+        for (auto it = clients.begin(); it != clients.end(); ++it)
+            Push(it.key(), it.value());
+
+        QString message = QStringLiteral("Live link: baked %1 in %2 ms (%3 element(s) re-read)")
+            .arg(FormatBytes(current.size()))
+            .arg(double(result.bakeNs) / 1.0e6, 0, 'f', 1)
+            .arg(result.reloaded);
+        if (!currentPatch.isEmpty())
+            message += QStringLiteral(", patch %1").arg(FormatBytes(currentPatch.size()));
+        message += QStringLiteral(", %1 runtime(s)").arg(clients.size());
+        emit StatusChanged(message);
+    }
+
+    // Keep watching exactly the files this bake read.
+    if (result.ok)
+    {
+        const QStringList watched = watcher->files();
+        if (!watched.isEmpty())
+            watcher->removePaths(watched);
+        if (!result.assets.isEmpty())
+            watcher->addPaths(result.assets);
+    }
+
+    if (rebake)
+    {
+        rebake = false;
+        StartBake();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Sockets
+// ---------------------------------------------------------------------------
+
+void LiveLinkServer::Push(QLocalSocket* socket, Client& client)
+{
+    if (current.isEmpty() || client.held == currentHash || client.refused == currentHash)
+        return;
+
+    LiveLinkFrame frame;
+    frame.sequence = ++sequence;
+    frame.bakeHash = currentHash;
+    frame.editMs = currentEditMs;
+
+    if (!currentPatch.isEmpty() && client.held == patchBase && !client.needsFull)
+    {
+        frame.kind = uibin::LINK_PATCH;
+        frame.payload = currentPatch;
+    }
+    else
+    {
+        frame.kind = uibin::LINK_FULL;
+        frame.payload = current;
+        client.needsFull = false;
+    }
+
+    frame.sentMs = QDateTime::currentMSecsSinceEpoch();
+    socket->write(frame.Encode());
+
+    // Assume it lands; the ACK corrects this if the runtime could not apply it.
+    client.held = currentHash;
+    client.lastSequence = frame.sequence;
+    client.lastFull = frame.kind == uibin::LINK_FULL;
+}
+
+void LiveLinkServer::OnNewConnection()
+{
+    while (QLocalSocket* socket = server->nextPendingConnection())
+    {
+        Client& client = clients[socket];
+
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { OnReadyRead(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]()
+        {
+            clients.remove(socket);
+            socket->deleteLater();
+        });
+
+        Push(socket, client);
+    }
+}
+
+void LiveLinkServer::OnReadyRead(QLocalSocket* socket)
+{
+    auto it = clients.find(socket);
+    if (it == clients.end())
+        return;
+
+    Client& client = it.value();
+    client.inbox += socket->readAll();
+
+    LiveLinkFrame frame;
+    QString error;
+    int taken;
+    while ((taken = LiveLinkFrame::Take(client.inbox, &frame, &error)) > 0)
+    {
+        if (frame.kind != uibin::LINK_ACK)
+            continue;
+
+        const QJsonObject status = QJsonDocument::fromJson(frame.payload).object();
+        OnAck(socket, client, frame, status);
+    }
+
+    if (taken < 0)
+    {
+        emit StatusChanged(QStringLiteral("Live link: dropped a runtime: ") + error);
+        clients.remove(socket);
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+    }
+}
+
+void LiveLinkServer::OnAck(QLocalSocket* socket, Client& client, const LiveLinkFrame& ack, const QJsonObject& status)
+{
+    // An ACK for an older push says nothing about what the runtime holds now.
+    if (ack.sequence != client.lastSequence)
+        return;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    if (!status["ok"].toBool())
+    {
+        emit StatusChanged(QStringLiteral("Live link: runtime rejected push %1 (%2), %3")
+            .arg(ack.sequence).arg(status["error"].toString())
+            .arg(client.lastFull ? QStringLiteral("waiting for the next bake") : QStringLiteral("sending the full bake")));
+    }
+    else
+    {
+        emit StatusChanged(QStringLiteral("Live link: push %1 applied in %2 ms, edit to screen %3 ms, round trip %4 ms")
+            .arg(ack.sequence)
+            .arg(status["applyMs"].toDouble(), 0, 'f', 1)
+            .arg(ack.editMs > 0 ? now - ack.editMs : 0)
+            .arg(now - ack.sentMs));
+    }
+
+    // A runtime that could not apply a patch still holds its base, which
+    // Push would answer with the same patch again. One that could not load
+    // the whole bake waits for the next one.
+    if (!status["ok"].toBool())
+    {
+        if (client.lastFull)
+            client.refused = currentHash;
+        else
+            client.needsFull = true;
+    }
+
+    client.held = ack.bakeHash;
+    Push(socket, client);
+}
@@ -0,0 +1,135 @@
+#ifndef APP_LIVELINKSERVER_HPP
+#define APP_LIVELINKSERVER_HPP
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QThreadPool>
+
+#include "scene/BakeCache.hpp"
+#include "scene/SceneMirror.hpp"
+
+class QFileSystemWatcher;
+class QLocalServer;
+class QLocalSocket;
+class QTimer;
+class SceneDocument;
+struct LiveLinkFrame;
+
+// Editor side of the live link: re-bakes the open document in the
+// background shortly after each edit and pushes the result to every
+// connected runtime over a QLocalSocket (uibin_patch_spec.txt section 6).
+//
+// An edit (DocumentEdited, or a change to any asset file the scene
+// references) restarts a short debounce timer; when it fires, the document
+// is snapshotted on the GUI thread (SceneSnapshotter, which re-serialises
+// only edited components) and a worker brings its SceneMirror up to date
+// and bakes it with an incremental BakeCache, so only edited elements are
+// re-read and re-encoded. A
+// runtime that holds the previous bake gets a UiBinPatch, anyone else the
+// whole .uibin. Runtimes acknowledge what they hold, so one that failed to
+// apply a patch is sent the full bake next.
+//
+// At most one bake runs at a time; edits made during it are folded into a
+// single follow-up bake.
+class LiveLinkServer : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    explicit LiveLinkServer(QObject* parent = nullptr);
+    ~LiveLinkServer() override;
+
+    // Listens on serverName (a QLocalServer name, default
+    // "UIMaker2LiveLink") and bakes the current document once.
+    bool Start(const QString& serverName = QString(), QString* error = nullptr);
+    void Stop();
+    bool IsRunning() const;
+
+    // The document to watch; call again whenever the editor swaps documents.
+    void SetDocument(const SceneDocument* doc);
+
+    // Quiet period after the last edit before re-baking.
+    void SetDebounce(int ms);
+
+    int ClientCount() const;
+
+public slots:
+
+    void DocumentEdited();
+
+signals:
+
+    // One-line human summary of the last bake or acknowledgement.
+    void StatusChanged(const QString& message);
+
+private:
+
+    struct Client
+    {
+        QByteArray inbox;          // bytes read but not yet framed
+        quint64 held = 0;          // hash of the bake the runtime holds
+        quint32 lastSequence = 0;  // last frame pushed to it
+        bool lastFull = false;     // last frame was a whole bake
+        bool needsFull = false;    // rejected a patch; send the whole bake
+        quint64 refused = 0;       // whole bake it could not load; not resent
+    };
+
+    struct BakeResult
+    {
+        bool ok = false;
+        QString error;
+        QByteArray bytes;
+        quint64 hash = 0;
+        QByteArray patch;          // from baseHash to hash; empty if none
+        quint64 baseHash = 0;
+        qint64 editMs = 0;
+        qint64 bakeNs = 0;
+        qint64 diffNs = 0;
+        int reloaded = 0;          // elements whose components were re-read
+        QStringList assets;        // absolute asset paths, for the watcher
+    };
+
+    void StartBake();
+    void FinishBake(const BakeResult& result);
+    void Push(QLocalSocket* socket, Client& client);
+
+    void OnNewConnection();
+    void OnReadyRead(QLocalSocket* socket);
+    void OnAck(QLocalSocket* socket, Client& client, const LiveLinkFrame& ack, const QJsonObject& status);
+
+    QLocalServer* server = nullptr;
+    QTimer* debounce = nullptr;
+    QFileSystemWatcher* watcher = nullptr;
+    const SceneDocument* document = nullptr;
+
+    QHash<QLocalSocket*, Client> clients;
+
+    // Latest bake, and the patch to it from the bake before it.
+    QByteArray current;
+    quint64 currentHash = 0;
+    QByteArray currentPatch;
+    quint64 patchBase = 0;
+    qint64 currentEditMs = 0;
+    quint32 sequence = 0;
+
+    qint64 pendingEditMs = 0;      // first edit not yet covered by a bake
+    bool baking = false;
+    bool rebake = false;           // an edit arrived while baking
+
+    SceneSnapshotter snapshotter;  // GUI thread
+
+    // Worker state: one thread that never expires, so the mirror's objects
+    // stay on it and the cache is never shared between bakes.
+    QThreadPool pool;
+    QTemporaryDir tempDir;
+    SceneMirror mirror;
+    BakeCache bakeCache;
+};
+
+#endif
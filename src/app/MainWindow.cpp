@@ -15,6 +15,9 @@
 #include <QSettings>
 #include <QMenu>
 #include <QMenuBar>
+#include <QStatusBar>
+#include <QProgressBar>
+#include <QToolButton>
 #include <QInputDialog>
 #include <QItemSelection>
 #include <QSignalBlocker>
@@ -26,6 +29,8 @@
 #include "scene/SceneElementItem.hpp"
 #include "scene/SceneExporter.hpp"
 #include "scene/SceneDocument.hpp"
+#include "app/BackgroundBaker.hpp"
+#include "app/LiveLinkServer.hpp"
 #include "app/MainWindow.hpp"
 #include "ui/EntityTreeModel.hpp"
 #include "ui/PropertyEditorPanel.hpp"
@@ -425,7 +430,9 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), ui(new Ui::UIMake
     BuildPropertyDock();
     BuildToolbar();
     BuildViewMenu();
+    BuildBaker();
     ConnectActions();
+    BuildLiveLink();
 
     // Reopen the scene the user last had open; fall back to seeding demo
     // content on a fresh install or if that file is missing/unreadable.
@@ -489,6 +496,9 @@ bool MainWindow::OpenSceneFile(const QString& path)
     WireHierarchySignals();
     propertyPanel->SetTarget(document->GetRoot());
 
+    if (m_liveLink)
+        m_liveLink->SetDocument(document);
+
     return true;
 }
 
@@ -742,6 +752,102 @@ void MainWindow::BuildViewMenu()
     SyncSnapChecks();
 }
 
+void MainWindow::BuildLiveLink()
+{
+    m_liveLinkAction = new QAction("Live Link", this);
+    m_liveLinkAction->setCheckable(true);
+    m_liveLinkAction->setToolTip("Re-bake after every edit and push the result to running instances");
+    ui->MenuFile->addAction(m_liveLinkAction);
+
+    connect(m_liveLinkAction, &QAction::toggled, this, [this](bool on)
+    {
+        QSettings().setValue(QStringLiteral("liveLink/enabled"), on);
+
+        if (!on)
+        {
+            if (m_liveLink)
+                m_liveLink->Stop();
+            statusBar()->showMessage("Live link stopped", 3000);
+            return;
+        }
+
+        if (!m_liveLink)
+        {
+            m_liveLink = new LiveLinkServer(this);
+            m_liveLink->SetDebounce(QSettings().value(QStringLiteral("liveLink/debounceMs"), 50).toInt());
+
+            // Every edit the user can undo is an edit the runtime should see.
+            connect(undoStack, &QUndoStack::indexChanged, m_liveLink, &LiveLinkServer::DocumentEdited);
+            connect(m_liveLink, &LiveLinkServer::StatusChanged, this, [this](const QString& message)
+            {
+                statusBar()->showMessage(message, 5000);
+            });
+        }
+
+        m_liveLink->SetDocument(document);
+
+        QString error;
+        if (!m_liveLink->Start(QString(), &error))
+        {
+            QMessageBox::warning(this, "Live Link", "Could not start the live link:\n" + error);
+            QSignalBlocker block(m_liveLinkAction);
+            m_liveLinkAction->setChecked(false);
+            QSettings().setValue(QStringLiteral("liveLink/enabled"), false);
+            return;
+        }
+
+        statusBar()->showMessage("Live link listening; run UIMaker2LiveLink to connect", 5000);
+    });
+
+    if (QSettings().value(QStringLiteral("liveLink/enabled"), false).toBool())
+        m_liveLinkAction->setChecked(true);
+}
+
+void MainWindow::BuildBaker()
+{
+    m_baker = new BackgroundBaker(this);
+
+    m_bakeProgress = new QProgressBar(this);
+    m_bakeProgress->setRange(0, 1000);
+    m_bakeProgress->setMaximumWidth(200);
+    m_bakeProgress->hide();
+
+    m_bakeCancel = new QToolButton(this);
+    m_bakeCancel->setText("Cancel");
+    m_bakeCancel->setToolTip("Stop the bake; the existing file is kept");
+    m_bakeCancel->hide();
+
+    statusBar()->addPermanentWidget(m_bakeProgress);
+    statusBar()->addPermanentWidget(m_bakeCancel);
+
+    connect(m_bakeCancel, &QToolButton::clicked, m_baker, &BackgroundBaker::Cancel);
+
+    connect(m_baker, &BackgroundBaker::Progress, this, [this](int permille, const QString& phase)
+    {
+        m_bakeProgress->setValue(permille);
+        m_bakeProgress->setFormat(phase + " %p%");
+    });
+
+    connect(m_baker, &BackgroundBaker::Finished, this,
+            [this](const QString& path, bool ok, bool cancelled, const QString& error, qint64 bytes)
+    {
+        m_bakeProgress->hide();
+        m_bakeCancel->hide();
+        ui->ActionBake->setEnabled(true);
+
+        if (ok)
+        {
+            QSettings().setValue(QStringLiteral("io/lastDir"), QFileInfo(path).absolutePath());
+            statusBar()->showMessage(QString("Baked %1 (%2 KB)").arg(QFileInfo(path).fileName())
+                                         .arg(double(bytes) / 1024.0, 0, 'f', 1), 5000);
+        }
+        else if (cancelled)
+            statusBar()->showMessage("Bake cancelled", 3000);
+        else
+            QMessageBox::warning(this, "Bake Failed", "Could not bake scene:\n" + error);
+    });
+}
+
 void MainWindow::SaveSnapSettings()
 {
     QSettings settings;
@@ -842,6 +948,9 @@ void MainWindow::ConnectActions()
         hierarchyView->setModel(hierarchyModel); hierarchyView->setSelectionModel(hierarchySelection);
         WireHierarchySignals();
         propertyPanel->SetTarget(document->GetRoot());
+
+        if (m_liveLink)
+            m_liveLink->SetDocument(document);
     });
 
     connect(ui->ActionExport, &QAction::triggered, this, [this]()
@@ -875,13 +984,14 @@ void MainWindow::ConnectActions()
         if (path.isEmpty())
             return;
 
-        if (SceneExporter::BakeToUiBin(document, path))
-        {
-            settings.setValue(QStringLiteral("io/lastDir"), QFileInfo(path).absolutePath());
-            QMessageBox::information(this, "Bake", "Scene baked to .uibin successfully.");
-        }
-        else
-            QMessageBox::warning(this, "Bake Failed", "Could not bake scene.");
+        // Snapshots the document and returns; BuildBaker reports the result.
+        if (!m_baker->Start(document, path))
+            return;
+
+        ui->ActionBake->setEnabled(false);
+        m_bakeProgress->setValue(0);
+        m_bakeProgress->show();
+        m_bakeCancel->show();
     });
 
     connect(ui->ActionLoad, &QAction::triggered, this, [this]()
@@ -14,7 +14,11 @@ class UiElement;
 class SceneDocument;
 class EntityTreeModel;
 class PropertyEditorPanel;
+class LiveLinkServer;
+class BackgroundBaker;
 class QAction;
+class QProgressBar;
+class QToolButton;
 
 QT_BEGIN_NAMESPACE
 class QGraphicsScene;
@@ -43,6 +47,8 @@ private:
     void BuildPropertyDock();
     void BuildToolbar();
     void BuildViewMenu();
+    void BuildLiveLink();
+    void BuildBaker();
     void ConnectActions();
 
     // Grid-snapping menu helpers: persist the current GridSnap state to
@@ -92,6 +98,18 @@ private:
 
     QUndoStack* undoStack = nullptr;
 
+    // File>Bake runs on a worker; it also keeps the session's incremental
+    // bake cache. The bar and its cancel button sit in the status bar and
+    // show only while a bake runs.
+    BackgroundBaker* m_baker = nullptr;
+    QProgressBar* m_bakeProgress = nullptr;
+    QToolButton* m_bakeCancel = nullptr;
+
+    // File>Live Link: background re-bake and push to running instances.
+    // Created on first enable; follows the active document.
+    LiveLinkServer* m_liveLink = nullptr;
+    QAction* m_liveLinkAction = nullptr;
+
     static constexpr const char* kElementMime = "application/x-uimaker2-element";
 };
 
@@ -0,0 +1,325 @@
+#include "bake/HeadlessBaker.hpp"
+
+#include "core/UiElement.hpp"
+#include "scene/AssetCache.hpp"
+#include "scene/BakeCache.hpp"
+#include "scene/SceneDocument.hpp"
+#include "scene/SceneExporter.hpp"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+    double Ms(qint64 ns)
+    {
+        return double(ns) / 1.0e6;
+    }
+}
+
+QJsonObject HeadlessBaker::BakeScene(const Job& job, const Settings& settings, AssetCache* cache)
+{
+    QElapsedTimer total;
+    total.start();
+
+    QJsonObject report;
+    report["scene"] = job.scenePath;
+    report["output"] = job.outputPath;
+
+    QJsonObject ms;
+
+    auto finish = [&](ExitCode code, const QString& error) -> QJsonObject
+    {
+        ms["total"] = Ms(total.nsecsElapsed());
+        report["ms"] = ms;
+        report["ok"] = (code == ExitOk);
+        report["exitCode"] = int(code);
+        if (!error.isEmpty())
+            report["error"] = error;
+
+        return report;
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile in(job.scenePath);
+    if (!in.open(QIODevice::ReadOnly))
+        return finish(ExitLoadFailed, QStringLiteral("cannot open scene: ") + in.errorString());
+
+    const QByteArray json = in.readAll();
+    in.close();
+
+    SceneDocument doc(nullptr, SceneDocument::Mode::Headless);
+    doc.SetBaseDir(QFileInfo(job.scenePath).absolutePath());
+
+    const bool loaded = doc.LoadJson(json);
+    ms["load"] = Ms(timer.nsecsElapsed());
+
+    if (!loaded)
+        return finish(ExitLoadFailed, QStringLiteral("invalid or corrupt scene JSON"));
+
+    report["elements"] = qint64(doc.GetRoot()->findChildren<UiElement*>().size() + 1);
+
+    UiBinWriteOptions options = settings.output;
+    options.assetCache = cache;
+    options.bakeCache = nullptr;
+
+    // The incremental cache lives next to the output; a missing or stale one
+    // just means a full encode this time.
+    BakeCache bakeCache;
+    const QString cachePath = job.outputPath + QStringLiteral(".bakecache");
+    if (settings.incremental)
+    {
+        bakeCache.Load(cachePath);
+        options.bakeCache = &bakeCache;
+    }
+
+    SceneExporter::BakeStats stats;
+    const bool baked = SceneExporter::BakeToUiBin(&doc, job.outputPath, &stats, settings.validate, options);
+
+    ms["write"] = Ms(stats.writeNs);
+    if (settings.validate)
+        ms["validate"] = Ms(stats.validateNs);
+
+    report["bytes"] = stats.bytes;
+
+    if (settings.incremental)
+    {
+        QJsonObject nodes;
+        nodes["reused"] = bakeCache.NodeHits();
+        nodes["encoded"] = bakeCache.NodeMisses();
+        report["cache"] = nodes;
+    }
+
+    if (!baked)
+        return finish(stats.validationFailed ? ExitValidateFailed : ExitBakeFailed, stats.error);
+
+    if (settings.incremental && !bakeCache.Save(cachePath))
+        std::fprintf(stderr, "UIMaker2Bake: cannot write bake cache '%s'\n", qPrintable(cachePath));
+
+    return finish(ExitOk, QString());
+}
+
+bool HeadlessBaker::LoadManifest(const QString& path, QList<Job>& out, QString* error)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly))
+    {
+        if (error) *error = QStringLiteral("cannot open manifest: ") + f.errorString();
+        return false;
+    }
+
+    QJsonParseError err;
+    const QJsonDocument doc = QJsonDocument::fromJson(f.readAll(), &err);
+    if (err.error != QJsonParseError::NoError || !doc.isArray())
+    {
+        if (error) *error = QStringLiteral("manifest must be a JSON array of {\"scene\", \"output\"} objects");
+        return false;
+    }
+
+    const QDir base = QFileInfo(path).absoluteDir();
+
+    for (const QJsonValue& v : doc.array())
+    {
+        const QJsonObject o = v.toObject();
+        const QString scene = o["scene"].toString();
+        const QString output = o["output"].toString();
+
+        if (scene.isEmpty() || output.isEmpty())
+        {
+            if (error) *error = QStringLiteral("manifest entry without \"scene\" or \"output\"");
+            return false;
+        }
+
+        Job job;
+        job.scenePath = QDir::cleanPath(base.absoluteFilePath(scene));
+        job.outputPath = QDir::cleanPath(base.absoluteFilePath(output));
+        job.sizeHint = QFileInfo(job.scenePath).size();
+        out.push_back(job);
+    }
+
+    return true;
+}
+
+QJsonObject HeadlessBaker::BakeBatch(const QList<Job>& jobs, const Settings& settings, int threads, QList<QJsonObject>& reports)
+{
+    QElapsedTimer wall;
+    wall.start();
+
+    AssetCache cache;
+
+    // Largest scene first (longest-processing-time scheduling). The pool runs
+    // tasks in submission order, so the big scenes start immediately and the
+    // small ones fill in around them; wall-clock time then tracks the largest
+    // scene rather than whichever big scene happened to be queued last.
+    std::vector<int> order(size_t(jobs.size()));
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b)
+    {
+        return jobs[a].sizeHint > jobs[b].sizeHint;
+    });
+
+    reports.clear();
+    reports.resize(jobs.size());
+    QJsonObject* out = reports.data();
+
+    const int threadCount = threads > 0 ? threads : QThread::idealThreadCount();
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threadCount);
+
+    for (int i : order)
+    {
+        pool.start([&, out, i]()
+        {
+            out[i] = BakeScene(jobs[i], settings, &cache);
+        });
+    }
+
+    pool.waitForDone();
+
+    int failed = 0;
+    qint64 bytes = 0;
+    double sceneMs = 0.0;
+    QJsonArray largestFirst;
+
+    for (const QJsonObject& r : reports)
+    {
+        if (ExitCodeOf(r) != ExitOk)
+            ++failed;
+
+        bytes += r["bytes"].toInteger();
+        sceneMs += r["ms"].toObject()["total"].toDouble();
+    }
+
+    for (int i : order)
+        largestFirst.append(jobs[i].scenePath);
+
+    QJsonObject cacheStats;
+    cacheStats["hits"] = cache.Hits();
+    cacheStats["misses"] = cache.Misses();
+
+    QJsonObject summary;
+    summary["batch"] = true;
+    summary["scenes"] = int(jobs.size());
+    summary["failed"] = failed;
+    summary["threads"] = threadCount;
+    summary["bytes"] = bytes;
+    summary["wallMs"] = Ms(wall.nsecsElapsed());
+    summary["sumSceneMs"] = sceneMs;
+    summary["assetCache"] = cacheStats;
+    summary["schedule"] = largestFirst;
+    summary["ok"] = (failed == 0);
+    summary["exitCode"] = int(failed == 0 ? ExitOk : ExitBatchFailed);
+
+    return summary;
+}
+
+QJsonObject HeadlessBaker::BakeBundle(const QStringList& scenePaths, const QString& outputPath, const Settings& settings)
+{
+    QElapsedTimer total;
+    total.start();
+
+    QJsonObject report;
+    report["bundle"] = true;
+    report["output"] = outputPath;
+
+    QJsonObject ms;
+
+    auto finish = [&](ExitCode code, const QString& error) -> QJsonObject
+    {
+        ms["total"] = Ms(total.nsecsElapsed());
+        report["ms"] = ms;
+        report["ok"] = (code == ExitOk);
+        report["exitCode"] = int(code);
+        if (!error.isEmpty())
+            report["error"] = error;
+
+        return report;
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+
+    std::vector<std::unique_ptr<SceneDocument>> docs;
+    QVector<UiBinScene> scenes;
+    QSet<QString> names;
+    QJsonArray sceneReports;
+
+    for (const QString& path : scenePaths)
+    {
+        const QString name = QFileInfo(path).completeBaseName();
+        if (names.contains(name))
+            return finish(ExitUsage, QStringLiteral("duplicate scene name '%1' (%2)").arg(name, path));
+        names.insert(name);
+
+        QFile in(path);
+        if (!in.open(QIODevice::ReadOnly))
+            return finish(ExitLoadFailed, QStringLiteral("cannot open scene %1: %2").arg(path, in.errorString()));
+
+        docs.push_back(std::make_unique<SceneDocument>(nullptr, SceneDocument::Mode::Headless));
+        SceneDocument* doc = docs.back().get();
+        doc->SetBaseDir(QFileInfo(path).absolutePath());
+
+        if (!doc->LoadJson(in.readAll()))
+            return finish(ExitLoadFailed, QStringLiteral("invalid or corrupt scene JSON: ") + path);
+
+        QJsonObject entry;
+        entry["name"] = name;
+        entry["scene"] = path;
+        entry["elements"] = qint64(doc->GetRoot()->findChildren<UiElement*>().size() + 1);
+        sceneReports.append(entry);
+
+        scenes.push_back(UiBinScene { name, doc });
+    }
+
+    ms["load"] = Ms(timer.nsecsElapsed());
+    report["scenes"] = sceneReports;
+
+    UiBinWriteOptions options = settings.output;
+    options.assetCache = nullptr;
+    options.bakeCache = nullptr;
+
+    BakeCache bakeCache;
+    const QString cachePath = outputPath + QStringLiteral(".bakecache");
+    if (settings.incremental)
+    {
+        bakeCache.Load(cachePath);
+        options.bakeCache = &bakeCache;
+    }
+
+    SceneExporter::BakeStats stats;
+    const bool baked = SceneExporter::BakeBundleToUiBin(scenes, outputPath, &stats, settings.validate, options);
+
+    ms["write"] = Ms(stats.writeNs);
+    if (settings.validate)
+        ms["validate"] = Ms(stats.validateNs);
+
+    report["bytes"] = stats.bytes;
+
+    if (!baked)
+        return finish(stats.validationFailed ? ExitValidateFailed : ExitBakeFailed, stats.error);
+
+    if (settings.incremental && !bakeCache.Save(cachePath))
+        std::fprintf(stderr, "UIMaker2Bake: cannot write bake cache '%s'\n", qPrintable(cachePath));
+
+    return finish(ExitOk, QString());
+}
+
+int HeadlessBaker::ExitCodeOf(const QJsonObject& report)
+{
+    return report["exitCode"].toInt(ExitBakeFailed);
+}
@@ -0,0 +1,74 @@
+#ifndef BAKE_HEADLESSBAKER_HPP
+#define BAKE_HEADLESSBAKER_HPP
+
+#include "scene/UiBinWriter.hpp"
+
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class AssetCache;
+
+// Scene baking without any editor UI, shared by the single-scene and batch
+// modes of UIMaker2Bake. Each scene bake yields a flat JSON report (exit code,
+// per-phase milliseconds, element count, output bytes) that the tool prints
+// verbatim, so build scripts get machine-readable results.
+class HeadlessBaker
+{
+public:
+
+    // Stable process exit codes; build scripts branch on these. A scene
+    // report's "exitCode" uses the same values.
+    enum ExitCode
+    {
+        ExitOk             = 0,
+        ExitUsage          = 1,
+        ExitLoadFailed     = 2,
+        ExitBakeFailed     = 3,
+        ExitValidateFailed = 4,
+        ExitBatchFailed    = 5    // batch: at least one scene failed
+    };
+
+    struct Settings
+    {
+        bool validate = true;     // round-trip UiBinReader validation
+        bool incremental = false; // reuse/update <output>.bakecache (BakeCache)
+
+        // Container layout/mask/alignment. The cache pointers are ignored;
+        // BakeScene fills them in per bake.
+        UiBinWriteOptions output;
+    };
+
+    struct Job
+    {
+        QString scenePath;
+        QString outputPath;
+        qint64 sizeHint = 0;      // scene.json bytes; batches schedule largest first
+    };
+
+    // Loads job.scenePath into a headless SceneDocument and bakes it to
+    // job.outputPath. Safe to call concurrently from worker threads: each
+    // call owns its document and only the (thread-safe) cache is shared.
+    static QJsonObject BakeScene(const Job& job, const Settings& settings, AssetCache* cache = nullptr);
+
+    // Parses a batch manifest: a JSON array of {"scene": ..., "output": ...}
+    // objects. Relative paths resolve against the manifest's directory.
+    static bool LoadManifest(const QString& path, QList<Job>& out, QString* error = nullptr);
+
+    // Bakes every job on a thread pool (threads <= 0 means one per core),
+    // sharing one AssetCache so an asset used by many scenes is read once.
+    // reports receives one scene report per job, in manifest order; the
+    // return value is the batch summary.
+    static QJsonObject BakeBatch(const QList<Job>& jobs, const Settings& settings, int threads, QList<QJsonObject>& reports);
+
+    // Loads every scene and bakes them into one multi-scene bundle
+    // (UiBinWriter::WriteBundle) at outputPath, each named by its file's
+    // base name ("menus/main.json" -> "main"). One report for the bundle,
+    // with per-scene element counts; a repeated name is a usage error.
+    static QJsonObject BakeBundle(const QStringList& scenePaths, const QString& outputPath, const Settings& settings);
+
+    static int ExitCodeOf(const QJsonObject& report);
+};
+
+#endif
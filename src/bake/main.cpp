@@ -0,0 +1,284 @@
+#include "bake/HeadlessBaker.hpp"
+#include "core/AssetContext.hpp"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cstdio>
+
+// ---------------------------------------------------------------------------
+// UIMaker2Bake: headless scene.json -> .uibin baker for build farms and CI.
+//
+// Runs the exact editor bake path (SceneDocument::LoadJson, then
+// SceneExporter::BakeToUiBin -> UiBinWriter::Write + UiBinReader::Validate)
+// on headless SceneDocuments under an offscreen QGuiApplication, so no
+// display, QApplication or QGraphicsScene is needed.
+//
+//   UIMaker2Bake [--no-validate] [--incremental] <scene.json> <output.uibin>
+//   UIMaker2Bake [--no-validate] [--incremental] [--jobs N] --batch <manifest.json>
+//   UIMaker2Bake [--no-validate] [--incremental] --bundle <output.uibin> <scene.json>...
+//
+// --bundle bakes every listed scene into one multi-scene container with a
+// shared string and asset table, each scene named by its file's base name.
+//
+// Layout options: --layout v5 writes the aligned, mmap-able profile;
+// --no-mask and --asset-align N only apply to it. --compress-assets,
+// --dedup-assets, --decode-images, --glyphs, --shape-text, --atlas (with --atlas-page N),
+// --schemas, --string-lookup, --element-index, --subtree-sizes and
+// --resolve-layout WxH (repeatable, one target per use) work with either
+// layout.
+//
+// stdout carries compact JSON only: one report object per scene, and in
+// batch mode a final summary object. Human diagnostics go to stderr. The exit
+// code is a HeadlessBaker::ExitCode.
+// ---------------------------------------------------------------------------
+
+namespace
+{
+    void EmitReport(const QJsonObject& report)
+    {
+        const QByteArray line = QJsonDocument(report).toJson(QJsonDocument::Compact);
+        std::fwrite(line.constData(), 1, size_t(line.size()), stdout);
+        std::fputc('\n', stdout);
+        std::fflush(stdout);
+    }
+
+    void WarnIfFailed(const QJsonObject& report)
+    {
+        if (HeadlessBaker::ExitCodeOf(report) != HeadlessBaker::ExitOk)
+            std::fprintf(stderr, "UIMaker2Bake: %s: %s\n",
+                         qPrintable(report[report.contains("scene") ? "scene" : "output"].toString()),
+                         qPrintable(report["error"].toString()));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    QElapsedTimer total;
+    total.start();
+
+    // Font registration (Text/Button fontPath) still goes through
+    // QFontDatabase, which needs a platform plugin. "offscreen" needs no
+    // display server; an explicit QT_QPA_PLATFORM still wins.
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+    QGuiApplication::setOrganizationName("UIMaker");
+    QGuiApplication::setApplicationName("UIMaker2Bake");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Bakes UIMaker2 scene.json files into .uibin containers.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("scene", "Input scene.json. Asset paths resolve against its directory.");
+    parser.addPositionalArgument("output", "Output .uibin path.");
+
+    const QCommandLineOption noValidateOpt(QStringLiteral("no-validate"), "Skip the round-trip UiBinReader validation.");
+    const QCommandLineOption batchOpt(QStringLiteral("batch"),
+        "Bake every scene listed in a JSON manifest ([{\"scene\": ..., \"output\": ...}]) in parallel.", "manifest");
+    const QCommandLineOption jobsOpt(QStringLiteral("jobs"), "Worker threads for --batch (default: one per core).", "n");
+    const QCommandLineOption bundleOpt(QStringLiteral("bundle"),
+        "Bake every scene argument into one multi-scene bundle at this path.", "output");
+
+    const QCommandLineOption incrementalOpt(QStringLiteral("incremental"),
+        "Keep <output>.bakecache and re-encode only elements changed since the last bake.");
+
+    const QCommandLineOption layoutOpt(QStringLiteral("layout"),
+        "Container layout: v4 (default) or v5 (aligned, memory-mappable).", "layout", QStringLiteral("v4"));
+    const QCommandLineOption noMaskOpt(QStringLiteral("no-mask"), "v5: leave the body unmasked so it can be read in place.");
+    const QCommandLineOption assetAlignOpt(QStringLiteral("asset-align"),
+        "v5: asset blob alignment in bytes, a power of two >= 8 (default 64).", "bytes");
+
+    const QCommandLineOption compressOpt(QStringLiteral("compress-assets"),
+        "zlib-compress asset blobs that shrink (sets the asset-codec header flag).");
+
+    const QCommandLineOption dedupOpt(QStringLiteral("dedup-assets"),
+        "Store byte-identical asset blobs once, shared between their records.");
+
+    const QCommandLineOption decodeOpt(QStringLiteral("decode-images"),
+        "Store images as pre-decoded, premultiplied RGBA8 pixels.");
+    const QCommandLineOption glyphsOpt(QStringLiteral("glyphs"),
+        "Bake glyph atlases, metrics and kerning for the text the scene uses.");
+    const QCommandLineOption shapeOpt(QStringLiteral("shape-text"),
+        "Store pre-shaped glyph runs for every Text/Button label.");
+    const QCommandLineOption atlasOpt(QStringLiteral("atlas"),
+        "Pack Image/Icon/Button/DragSlot images into shared atlas pages.");
+    const QCommandLineOption atlasPageOpt(QStringLiteral("atlas-page"),
+        "Atlas page edge in pixels, 64..65535 (default 2048).", "pixels");
+    const QCommandLineOption schemasOpt(QStringLiteral("schemas"),
+        "Write component records as packed values behind a per-type schema table.");
+    const QCommandLineOption stringLookupOpt(QStringLiteral("string-lookup"),
+        "Store a hash index from string bytes to string id.");
+    const QCommandLineOption elementIndexOpt(QStringLiteral("element-index"),
+        "Store a UUID-sorted element index with subtree offsets and sizes.");
+    const QCommandLineOption subtreeSizesOpt(QStringLiteral("subtree-sizes"),
+        "Store each element's children byte size so readers can skip or parallel-decode subtrees.");
+    const QCommandLineOption resolveLayoutOpt(QStringLiteral("resolve-layout"),
+        "Store the layout resolved for a WxH canvas; repeat for more targets.", "WxH");
+
+    parser.addOption(noValidateOpt);
+    parser.addOption(compressOpt);
+    parser.addOption(dedupOpt);
+    parser.addOption(decodeOpt);
+    parser.addOption(glyphsOpt);
+    parser.addOption(shapeOpt);
+    parser.addOption(atlasOpt);
+    parser.addOption(atlasPageOpt);
+    parser.addOption(schemasOpt);
+    parser.addOption(stringLookupOpt);
+    parser.addOption(elementIndexOpt);
+    parser.addOption(subtreeSizesOpt);
+    parser.addOption(resolveLayoutOpt);
+    parser.addOption(layoutOpt);
+    parser.addOption(noMaskOpt);
+    parser.addOption(assetAlignOpt);
+    parser.addOption(incrementalOpt);
+    parser.addOption(batchOpt);
+    parser.addOption(jobsOpt);
+    parser.addOption(bundleOpt);
+
+    // process() exits with status 1 (ExitUsage) on unknown options.
+    parser.process(app);
+
+    HeadlessBaker::Settings settings;
+    settings.validate = !parser.isSet(noValidateOpt);
+    settings.incremental = parser.isSet(incrementalOpt);
+
+    const QString layout = parser.value(layoutOpt);
+    if (layout == QLatin1String("v5"))
+    {
+        settings.output.layout = UiBinLayout::V5Aligned;
+    }
+    else if (layout != QLatin1String("v4"))
+    {
+        std::fprintf(stderr, "UIMaker2Bake: unknown layout '%s'\n", qPrintable(layout));
+        return HeadlessBaker::ExitUsage;
+    }
+
+    settings.output.mask = !parser.isSet(noMaskOpt);
+    settings.output.compressAssets = parser.isSet(compressOpt);
+    settings.output.dedupAssets = parser.isSet(dedupOpt);
+    settings.output.decodeImages = parser.isSet(decodeOpt);
+    settings.output.bakeGlyphs = parser.isSet(glyphsOpt);
+    settings.output.shapeText = parser.isSet(shapeOpt);
+    settings.output.packAtlas = parser.isSet(atlasOpt);
+    settings.output.componentSchemas = parser.isSet(schemasOpt);
+    settings.output.stringLookup = parser.isSet(stringLookupOpt);
+    settings.output.elementIndex = parser.isSet(elementIndexOpt);
+    settings.output.subtreeSizes = parser.isSet(subtreeSizesOpt);
+
+    if (parser.isSet(atlasPageOpt))
+    {
+        const int page = parser.value(atlasPageOpt).toInt();
+        if (page < 64 || page > 0xFFFF)
+        {
+            std::fprintf(stderr, "UIMaker2Bake: --atlas-page must be between 64 and 65535\n");
+            return HeadlessBaker::ExitUsage;
+        }
+        settings.output.atlasPageSize = page;
+    }
+
+    for (const QString& target : parser.values(resolveLayoutOpt))
+    {
+        const QStringList wh = target.split(QLatin1Char('x'));
+        const int w = wh.size() == 2 ? wh[0].toInt() : 0;
+        const int h = wh.size() == 2 ? wh[1].toInt() : 0;
+        if (w <= 0 || h <= 0)
+        {
+            std::fprintf(stderr, "UIMaker2Bake: --resolve-layout expects WxH, e.g. 1920x1080\n");
+            return HeadlessBaker::ExitUsage;
+        }
+        settings.output.layoutTargets.push_back(QSize(w, h));
+    }
+
+    if (parser.isSet(assetAlignOpt))
+    {
+        const uint align = parser.value(assetAlignOpt).toUInt();
+        if (align < 8 || (align & (align - 1)) != 0)
+        {
+            std::fprintf(stderr, "UIMaker2Bake: --asset-align must be a power of two >= 8\n");
+            return HeadlessBaker::ExitUsage;
+        }
+        settings.output.assetAlignment = align;
+    }
+
+    const QStringList args = parser.positionalArguments();
+    const qint64 startupNs = total.nsecsElapsed();
+
+    // Baking only reflects component properties; preview pixmaps are never
+    // needed, so skip decoding every referenced image during LoadJson.
+    AssetContext::SetPreviewEnabled(false);
+
+    if (parser.isSet(batchOpt))
+    {
+        if (!args.isEmpty())
+        {
+            std::fputs(qPrintable(parser.helpText()), stderr);
+            return HeadlessBaker::ExitUsage;
+        }
+
+        QList<HeadlessBaker::Job> jobs;
+        QString error;
+        if (!HeadlessBaker::LoadManifest(parser.value(batchOpt), jobs, &error))
+        {
+            std::fprintf(stderr, "UIMaker2Bake: %s\n", qPrintable(error));
+            return HeadlessBaker::ExitUsage;
+        }
+
+        QList<QJsonObject> reports;
+        QJsonObject summary = HeadlessBaker::BakeBatch(jobs, settings, parser.value(jobsOpt).toInt(), reports);
+        summary["startupMs"] = double(startupNs) / 1.0e6;
+
+        for (const QJsonObject& r : reports)
+        {
+            WarnIfFailed(r);
+            EmitReport(r);
+        }
+
+        EmitReport(summary);
+        return HeadlessBaker::ExitCodeOf(summary);
+    }
+
+    if (parser.isSet(bundleOpt))
+    {
+        if (args.isEmpty())
+        {
+            std::fputs(qPrintable(parser.helpText()), stderr);
+            return HeadlessBaker::ExitUsage;
+        }
+
+        QJsonObject report = HeadlessBaker::BakeBundle(args, parser.value(bundleOpt), settings);
+
+        QJsonObject ms = report["ms"].toObject();
+        ms["startup"] = double(startupNs) / 1.0e6;
+        ms["process"] = double(total.nsecsElapsed()) / 1.0e6;
+        report["ms"] = ms;
+
+        WarnIfFailed(report);
+        EmitReport(report);
+        return HeadlessBaker::ExitCodeOf(report);
+    }
+
+    if (args.size() != 2)
+    {
+        std::fputs(qPrintable(parser.helpText()), stderr);
+        return HeadlessBaker::ExitUsage;
+    }
+
+    HeadlessBaker::Job job;
+    job.scenePath = args.at(0);
+    job.outputPath = args.at(1);
+
+    QJsonObject report = HeadlessBaker::BakeScene(job, settings);
+
+    QJsonObject ms = report["ms"].toObject();
+    ms["startup"] = double(startupNs) / 1.0e6;
+    ms["process"] = double(total.nsecsElapsed()) / 1.0e6;
+    report["ms"] = ms;
+
+    WarnIfFailed(report);
+    EmitReport(report);
+    return HeadlessBaker::ExitCodeOf(report);
+}
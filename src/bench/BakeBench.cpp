@@ -0,0 +1,138 @@
+#include "scene/SceneDocument.hpp"
+#include "scene/UiBinWriter.hpp"
+#include "core/UiElement.hpp"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <cstdio>
+
+// ---------------------------------------------------------------------------
+// UIMaker2BakeBench: builds a headless scene of N elements cycling through
+// the common element kinds, times UiBinWriter::Write over it (no caches, so
+// every component is encoded every pass) and prints one JSON line. Run it
+// before and after a writer change to compare components per second.
+//
+//   UIMaker2BakeBench [--elements N] [--reps N] [--v5] [--schemas]
+// ---------------------------------------------------------------------------
+
+namespace
+{
+    int CountComponents(const UiElement* e)
+    {
+        int n = int(e->GetComponents().size());
+        for (QObject* o : e->children())
+            if (auto* c = qobject_cast<UiElement*>(o))
+                n += CountComponents(c);
+        return n;
+    }
+
+    // Panels of ten mixed children, so the tree has some depth and every
+    // common component class is encoded many times.
+    void Populate(SceneDocument& doc, int elements)
+    {
+        UiElement* panel = nullptr;
+        for (int i = 0; i < elements; ++i)
+        {
+            const QString name = QStringLiteral("e%1").arg(i);
+            if (i % 11 == 0)
+            {
+                panel = doc.CreatePanelElement(name);
+                continue;
+            }
+
+            switch (i % 5)
+            {
+                case 0: doc.CreateTextElement(name, panel); break;
+                case 1: doc.CreateButtonElement(name, panel); break;
+                case 2: doc.CreateImageElement(name, panel); break;
+                case 3: doc.CreateToggleElement(name, panel); break;
+                default: doc.CreateProgressBarElement(name, panel); break;
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // Text components measure with QFont, which needs a QGuiApplication.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmark for UiBinWriter component encoding.");
+    parser.addHelpOption();
+
+    const QCommandLineOption elementsOpt(QStringLiteral("elements"), "Element count (default 20000).", "n", QStringLiteral("20000"));
+    const QCommandLineOption repsOpt(QStringLiteral("reps"), "Repetitions; the best time is reported (default 5).", "n", QStringLiteral("5"));
+    const QCommandLineOption v5Opt(QStringLiteral("v5"), "Write the aligned v5 layout.");
+    const QCommandLineOption schemasOpt(QStringLiteral("schemas"), "Write schema-form component records.");
+    parser.addOption(elementsOpt);
+    parser.addOption(repsOpt);
+    parser.addOption(v5Opt);
+    parser.addOption(schemasOpt);
+    parser.process(app);
+
+    const int elements = qMax(1, parser.value(elementsOpt).toInt());
+    const int reps = qMax(1, parser.value(repsOpt).toInt());
+
+    SceneDocument doc(nullptr, SceneDocument::Mode::Headless);
+    Populate(doc, elements);
+
+    QTemporaryDir dir;
+    if (!dir.isValid())
+    {
+        std::fprintf(stderr, "BakeBench: cannot create a temporary directory\n");
+        return 1;
+    }
+    const QString out = dir.filePath(QStringLiteral("bench.uibin"));
+
+    UiBinWriteOptions options;
+    options.layout = parser.isSet(v5Opt) ? UiBinLayout::V5Aligned : UiBinLayout::V4;
+    options.componentSchemas = parser.isSet(schemasOpt);
+
+    // The first pass also builds the per-class property plans; it is
+    // reported separately so the steady state is not skewed by it.
+    QElapsedTimer first;
+    first.start();
+    if (!UiBinWriter::Write(&doc, out, options))
+    {
+        std::fprintf(stderr, "BakeBench: write failed\n");
+        return 1;
+    }
+    const double firstMs = double(first.nsecsElapsed()) / 1.0e6;
+
+    qint64 best = -1;
+    for (int r = 0; r < reps; ++r)
+    {
+        QElapsedTimer t;
+        t.start();
+        UiBinWriter::Write(&doc, out, options);
+        const qint64 ns = t.nsecsElapsed();
+        if (best < 0 || ns < best)
+            best = ns;
+    }
+    const double bestMs = double(best) / 1.0e6;
+
+    const int components = CountComponents(doc.GetRoot());
+
+    QJsonObject report;
+    report["elements"] = elements;
+    report["components"] = components;
+    report["bytes"] = QFileInfo(out).size();
+    report["firstMs"] = firstMs;
+    report["bestMs"] = bestMs;
+    report["componentsPerSec"] = bestMs > 0.0 ? double(components) / (bestMs / 1000.0) : 0.0;
+
+    const QByteArray line = QJsonDocument(report).toJson(QJsonDocument::Compact);
+    std::fwrite(line.constData(), 1, size_t(line.size()), stdout);
+    std::fputc('\n', stdout);
+
+    return 0;
+}
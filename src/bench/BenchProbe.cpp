@@ -0,0 +1,155 @@
+#include "bench/BenchProbe.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(Q_OS_LINUX)
+#include <QFile>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    std::atomic<quint64> g_count { 0 };
+    std::atomic<quint64> g_bytes { 0 };
+
+    inline void Count(size_t n)
+    {
+        g_count.fetch_add(1, std::memory_order_relaxed);
+        g_bytes.fetch_add(n, std::memory_order_relaxed);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Allocation counting. Defined in the executable, so the dynamic linker
+// binds every malloc in the process (Qt included) to these; they forward
+// to glibc's own entry points.
+// ---------------------------------------------------------------------------
+
+#if defined(__GLIBC__)
+
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+
+    void* malloc(size_t n)
+    {
+        Count(n);
+        return __libc_malloc(n);
+    }
+
+    void* calloc(size_t n, size_t size)
+    {
+        Count(n * size);
+        return __libc_calloc(n, size);
+    }
+
+    void* realloc(void* p, size_t n)
+    {
+        Count(n);
+        return __libc_realloc(p, n);
+    }
+}
+
+const char* benchprobe::CounterName() { return "malloc"; }
+
+#else
+
+void* operator new(size_t n)
+{
+    Count(n);
+    if (void* p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t n)
+{
+    return ::operator new(n);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+const char* benchprobe::CounterName() { return "operator-new"; }
+
+#endif
+
+benchprobe::Allocs benchprobe::Allocations()
+{
+    Allocs a;
+    a.count = g_count.load(std::memory_order_relaxed);
+    a.bytes = g_bytes.load(std::memory_order_relaxed);
+    return a;
+}
+
+// ---------------------------------------------------------------------------
+// Peak RSS
+// ---------------------------------------------------------------------------
+
+#if defined(Q_OS_LINUX)
+
+qint64 benchprobe::PeakRss()
+{
+    QFile f(QStringLiteral("/proc/self/status"));
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text))
+        return 0;
+
+    for (QByteArray line = f.readLine(); !line.isEmpty(); line = f.readLine())
+    {
+        if (line.startsWith("VmHWM:"))
+            return line.mid(6).trimmed().split(' ').value(0).toLongLong() * 1024;
+    }
+    return 0;
+}
+
+void benchprobe::ResetPeakRss()
+{
+    // "5" resets the high-water mark to the current RSS (Linux 4.0+).
+    QFile f(QStringLiteral("/proc/self/clear_refs"));
+    if (f.open(QIODevice::WriteOnly))
+        f.write("5");
+}
+
+bool benchprobe::PeakRssResets() { return true; }
+
+#elif defined(Q_OS_WIN)
+
+qint64 benchprobe::PeakRss()
+{
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return 0;
+    return qint64(pmc.PeakWorkingSetSize);
+}
+
+void benchprobe::ResetPeakRss() {}
+bool benchprobe::PeakRssResets() { return false; }
+
+#else
+
+qint64 benchprobe::PeakRss()
+{
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0)
+        return 0;
+#if defined(Q_OS_DARWIN)
+    return qint64(ru.ru_maxrss);            // bytes
+#else
+    return qint64(ru.ru_maxrss) * 1024;     // kilobytes
+#endif
+}
+
+void benchprobe::ResetPeakRss() {}
+bool benchprobe::PeakRssResets() { return false; }
+
+#endif
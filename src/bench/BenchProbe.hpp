@@ -0,0 +1,32 @@
+#ifndef BENCH_BENCHPROBE_HPP
+#define BENCH_BENCHPROBE_HPP
+
+#include <QtGlobal>
+
+// Process-level counters for the benchmarks: heap allocations and peak
+// resident set size.
+//
+// Allocations are counted by interposing malloc/calloc/realloc where the C
+// library allows it (glibc), which also sees Qt's container storage; on
+// other platforms only C++ operator new is counted. CounterName() says
+// which, so reports from different platforms are not compared blindly.
+namespace benchprobe
+{
+    struct Allocs
+    {
+        quint64 count = 0;
+        quint64 bytes = 0;
+    };
+
+    Allocs Allocations();
+    const char* CounterName();
+
+    // Peak resident set size in bytes since the last ResetPeakRss, or since
+    // process start where the OS cannot reset it (then PeakRssResets()
+    // is false). 0 if unknown.
+    qint64 PeakRss();
+    void ResetPeakRss();
+    bool PeakRssResets();
+}
+
+#endif
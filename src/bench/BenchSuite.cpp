@@ -0,0 +1,302 @@
+#include "bench/BenchProbe.hpp"
+#include "bench/SceneGenerator.hpp"
+#include "components/TransformComponent.hpp"
+#include "core/AssetContext.hpp"
+#include "core/UiElement.hpp"
+#include "scene/BakeCache.hpp"
+#include "scene/SceneDocument.hpp"
+#include "scene/SceneMirror.hpp"
+#include "scene/UiBinCommon.hpp"
+#include "scene/UiBinReader.hpp"
+#include "scene/UiBinWriter.hpp"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGuiApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <cstdio>
+#include <functional>
+#include <memory>
+
+// ---------------------------------------------------------------------------
+// UIMaker2BenchSuite: format regression benchmarks over deterministic
+// synthetic scenes (SceneGenerator). For every case in the matrix
+// shape x element count x asset size it generates the scene, then times
+//
+//   bake      UiBinWriter::Write to a file
+//   rebake    after moving one element: snapshot, SceneMirror update and
+//             an incremental Write, as the editor's background bake and
+//             live link do per edit
+//   validate  UiBinReader::Validate of that file
+//   read      UiBinReader::Read of the file bytes into a tree
+//   mask      uibin::Obfuscate over a buffer the size of the body
+//
+// and prints one compact JSON line per case. Each phase reports its best
+// time over --reps runs, MB/s (of the .uibin bytes), elements/s, heap
+// allocations and bytes of one run, and the peak RSS during the phase.
+//
+//   UIMaker2BenchSuite [--shapes flat,deep] [--elements 1000,10000,...]
+//                      [--asset-mb 0,64,...] [--depth N] [--reps N]
+//                      [--v5] [--full]
+//
+// --full runs the whole regression matrix: flat and deep, 1k to 1M
+// elements, 0 to 500 MB of assets. That needs several GB of memory and a
+// few minutes; the default matrix is a quick subset.
+// ---------------------------------------------------------------------------
+
+namespace
+{
+    struct Phase
+    {
+        double bestMs = 0.0;
+        quint64 allocs = 0;
+        quint64 allocBytes = 0;
+        qint64 peakRss = 0;
+        bool ok = true;
+    };
+
+    // Runs fn reps times. Allocations are taken from the first run, which
+    // is the one a one-shot tool pays for; the time is the best run.
+    Phase Measure(int reps, const std::function<bool()>& fn)
+    {
+        Phase p;
+        benchprobe::ResetPeakRss();
+
+        qint64 best = -1;
+        for (int r = 0; r < reps; ++r)
+        {
+            const benchprobe::Allocs before = benchprobe::Allocations();
+
+            QElapsedTimer t;
+            t.start();
+            p.ok = fn() && p.ok;
+            const qint64 ns = t.nsecsElapsed();
+
+            if (r == 0)
+            {
+                const benchprobe::Allocs after = benchprobe::Allocations();
+                p.allocs = after.count - before.count;
+                p.allocBytes = after.bytes - before.bytes;
+            }
+
+            if (best < 0 || ns < best)
+                best = ns;
+        }
+
+        p.bestMs = double(best) / 1.0e6;
+        p.peakRss = benchprobe::PeakRss();
+        return p;
+    }
+
+    QJsonObject PhaseJson(const Phase& p, qint64 bytes, int elements)
+    {
+        const double s = p.bestMs / 1000.0;
+
+        QJsonObject o;
+        o["ok"] = p.ok;
+        o["ms"] = p.bestMs;
+        o["mbPerSec"] = s > 0.0 ? double(bytes) / (1024.0 * 1024.0) / s : 0.0;
+        if (elements > 0)
+            o["elementsPerSec"] = s > 0.0 ? double(elements) / s : 0.0;
+        o["allocs"] = qint64(p.allocs);
+        o["allocBytes"] = qint64(p.allocBytes);
+        o["peakRssMB"] = double(p.peakRss) / (1024.0 * 1024.0);
+        return o;
+    }
+
+    QList<int> ParseInts(const QString& csv)
+    {
+        QList<int> out;
+        for (const QString& part : csv.split(QLatin1Char(','), Qt::SkipEmptyParts))
+        {
+            bool ok = false;
+            const int v = part.trimmed().toInt(&ok);
+            if (ok && v >= 0)
+                out.append(v);
+        }
+        return out;
+    }
+
+    QJsonObject RunCase(const SceneGenerator::Spec& spec, int reps, const UiBinWriteOptions& options)
+    {
+        QJsonObject report;
+        report["shape"] = SceneGenerator::ShapeName(spec.shape);
+        report["requestedElements"] = spec.elements;
+        report["assetMB"] = double(spec.assetBytes) / (1024.0 * 1024.0);
+
+        QTemporaryDir dir;
+        if (!dir.isValid())
+        {
+            report["error"] = QStringLiteral("cannot create a temporary directory");
+            return report;
+        }
+
+        SceneDocument doc(nullptr, SceneDocument::Mode::Headless);
+        doc.SetBaseDir(dir.path());
+
+        SceneGenerator::Result scene;
+        QElapsedTimer gen;
+        gen.start();
+        if (!SceneGenerator::Generate(doc, spec, dir.path(), &scene))
+        {
+            report["error"] = QStringLiteral("cannot write the asset files");
+            return report;
+        }
+        report["generateMs"] = double(gen.nsecsElapsed()) / 1.0e6;
+        report["elements"] = scene.elements;
+        report["components"] = scene.components;
+        report["assetFiles"] = scene.assetFiles;
+
+        const QString path = dir.filePath(QStringLiteral("bench.uibin"));
+
+        const Phase bake = Measure(reps, [&]() { return UiBinWriter::Write(&doc, path, options); });
+
+        QByteArray bytes;
+        QFile f(path);
+        if (!bake.ok || !f.open(QIODevice::ReadOnly))
+        {
+            report["error"] = QStringLiteral("bake failed");
+            return report;
+        }
+        bytes = f.readAll();
+        f.close();
+        report["bytes"] = qint64(bytes.size());
+
+        // One warm bake fills the mirror and the cache; each measured run
+        // then moves one element, so it sees exactly one edited component.
+        UiElement* edited = doc.GetRoot()->findChild<UiElement*>();
+        TransformComponent* xform = edited ? edited->GetComponent<TransformComponent>() : nullptr;
+
+        SceneSnapshotter snapshotter;
+        SceneMirror mirror;
+        BakeCache cache;
+        UiBinWriteOptions incremental = options;
+        incremental.bakeCache = &cache;
+
+        const QString rebakePath = dir.filePath(QStringLiteral("rebake.uibin"));
+        const auto rebake = [&]()
+        {
+            return mirror.Update(snapshotter.Take(&doc)) && UiBinWriter::Write(mirror.Document(), rebakePath, incremental);
+        };
+
+        Phase edit;
+        if (xform && rebake())
+        {
+            int step = 0;
+            edit = Measure(reps, [&]()
+            {
+                ++step;
+                xform->SetPosition(QPointF(step, step));
+                return rebake();
+            });
+            report["rebakeReloaded"] = mirror.Reloaded();
+        }
+        else
+        {
+            edit.ok = false;
+        }
+
+        const Phase validate = Measure(reps, [&]() { return UiBinReader::Validate(path); });
+
+        const Phase read = Measure(reps, [&]()
+        {
+            const std::unique_ptr<UiElement> root(UiBinReader::Read(bytes));
+            return root != nullptr;
+        });
+
+        // The mask alone, over a private copy so the file bytes stay intact.
+        QByteArray body = bytes.mid(int(uibin::kHeaderSize));
+        const Phase mask = Measure(reps, [&]()
+        {
+            uibin::Obfuscate(body.data(), int(body.size()));
+            return true;
+        });
+
+        report["bake"] = PhaseJson(bake, bytes.size(), scene.elements);
+        report["rebake"] = PhaseJson(edit, bytes.size(), scene.elements);
+        report["validate"] = PhaseJson(validate, bytes.size(), scene.elements);
+        report["read"] = PhaseJson(read, bytes.size(), scene.elements);
+        report["mask"] = PhaseJson(mask, body.size(), 0);
+        return report;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // Text components measure with QFont, which needs a QGuiApplication.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Bake/validate/read/mask benchmark suite over synthetic scenes.");
+    parser.addHelpOption();
+
+    const QCommandLineOption shapesOpt(QStringLiteral("shapes"), "Tree shapes: flat, deep (default both).", "list",
+                                       QStringLiteral("flat,deep"));
+    const QCommandLineOption elementsOpt(QStringLiteral("elements"), "Element counts (default 1000,10000,100000).", "list",
+                                         QStringLiteral("1000,10000,100000"));
+    const QCommandLineOption assetsOpt(QStringLiteral("asset-mb"), "Total asset MiB per scene (default 0,16).", "list",
+                                       QStringLiteral("0,16"));
+    const QCommandLineOption depthOpt(QStringLiteral("depth"), "Nesting depth of deep trees (default 64).", "n",
+                                      QStringLiteral("64"));
+    const QCommandLineOption repsOpt(QStringLiteral("reps"), "Repetitions; the best time is reported (default 3).", "n",
+                                     QStringLiteral("3"));
+    const QCommandLineOption v5Opt(QStringLiteral("v5"), "Write the aligned v5 layout.");
+    const QCommandLineOption fullOpt(QStringLiteral("full"), "Full matrix: 1k-1M elements, 0-500 MiB assets.");
+    parser.addOption(shapesOpt);
+    parser.addOption(elementsOpt);
+    parser.addOption(assetsOpt);
+    parser.addOption(depthOpt);
+    parser.addOption(repsOpt);
+    parser.addOption(v5Opt);
+    parser.addOption(fullOpt);
+    parser.process(app);
+
+    // Loading never needs preview pixmaps; keep them out of the numbers.
+    AssetContext::SetPreviewEnabled(false);
+
+    const bool full = parser.isSet(fullOpt);
+    const QList<int> counts = ParseInts(full ? QStringLiteral("1000,10000,100000,1000000") : parser.value(elementsOpt));
+    const QList<int> assetMb = ParseInts(full ? QStringLiteral("0,5,50,500") : parser.value(assetsOpt));
+    const QStringList shapes = parser.value(shapesOpt).split(QLatin1Char(','), Qt::SkipEmptyParts);
+    const int reps = qMax(1, parser.value(repsOpt).toInt());
+
+    UiBinWriteOptions options;
+    options.layout = parser.isSet(v5Opt) ? UiBinLayout::V5Aligned : UiBinLayout::V4;
+
+    int failures = 0;
+    for (const QString& shape : shapes)
+    {
+        for (int elements : counts)
+        {
+            for (int mb : assetMb)
+            {
+                SceneGenerator::Spec spec;
+                spec.shape = shape.trimmed() == QStringLiteral("deep") ? SceneGenerator::Shape::Deep
+                                                                       : SceneGenerator::Shape::Flat;
+                spec.elements = elements;
+                spec.depth = qMax(1, parser.value(depthOpt).toInt());
+                spec.assetBytes = qint64(mb) * 1024 * 1024;
+
+                QJsonObject report = RunCase(spec, reps, options);
+                report["layout"] = parser.isSet(v5Opt) ? QStringLiteral("v5") : QStringLiteral("v4");
+                report["allocCounter"] = QString::fromLatin1(benchprobe::CounterName());
+                report["peakRssResets"] = benchprobe::PeakRssResets();
+                if (report.contains("error"))
+                    ++failures;
+
+                const QByteArray line = QJsonDocument(report).toJson(QJsonDocument::Compact);
+                std::fwrite(line.constData(), 1, size_t(line.size()), stdout);
+                std::fputc('\n', stdout);
+                std::fflush(stdout);
+            }
+        }
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,102 @@
+#include "scene/UiBinCommon.hpp"
+
+#include <QByteArray>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <cstdio>
+
+// ---------------------------------------------------------------------------
+// UIMaker2ObfuscateBench: times uibin::Obfuscate (jump-ahead, lane-parallel,
+// multi-threaded) against the original one-byte-at-a-time LCG loop on the same
+// buffer, checks the outputs are byte-identical, and prints one JSON line.
+//
+//   UIMaker2ObfuscateBench [--mb N] [--reps N]
+// ---------------------------------------------------------------------------
+
+namespace
+{
+    // The pre-jump-ahead implementation, kept verbatim as the baseline.
+    void ObfuscateSerial(char* data, int n)
+    {
+        quint32 s = 0x5BC8A93Du;
+        for (int i = 0; i < n; ++i)
+        {
+            s = s * 1103515245u + 12345u;
+            data[i] = char(quint8(data[i]) ^ quint8(s >> 16));
+        }
+    }
+
+    template <typename Fn>
+    double BestMs(int reps, QByteArray& buf, Fn fn)
+    {
+        qint64 best = -1;
+        for (int r = 0; r < reps; ++r)
+        {
+            QElapsedTimer t;
+            t.start();
+            fn(buf.data(), int(buf.size()));
+            const qint64 ns = t.nsecsElapsed();
+            if (best < 0 || ns < best)
+                best = ns;
+        }
+        return double(best) / 1.0e6;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Micro-benchmark for the .uibin XOR mask.");
+    parser.addHelpOption();
+
+    const QCommandLineOption mbOpt(QStringLiteral("mb"), "Buffer size in MiB (default 64).", "n", QStringLiteral("64"));
+    const QCommandLineOption repsOpt(QStringLiteral("reps"), "Repetitions; the best time is reported (default 5).", "n", QStringLiteral("5"));
+    parser.addOption(mbOpt);
+    parser.addOption(repsOpt);
+    parser.process(app);
+
+    const int mb = qBound(1, parser.value(mbOpt).toInt(), 2000);
+    const int reps = qMax(1, parser.value(repsOpt).toInt());
+
+    QByteArray source(qsizetype(mb) * 1024 * 1024, Qt::Uninitialized);
+    for (qsizetype i = 0; i < source.size(); ++i)
+        source[i] = char(i * 131 + (i >> 9));
+
+    QByteArray serial = source;
+    QByteArray fast = source;
+
+    const double serialMs = BestMs(reps, serial, ObfuscateSerial);
+    const double fastMs = BestMs(reps, fast, [](char* d, int n) { uibin::Obfuscate(d, n); });
+
+    // Each pass toggles the mask. After an even number both buffers are
+    // clear again, so mask once more to compare actual keystream output.
+    if (reps % 2 == 0)
+    {
+        ObfuscateSerial(serial.data(), int(serial.size()));
+        uibin::Obfuscate(fast.data(), int(fast.size()));
+    }
+
+    const double mib = double(source.size()) / (1024.0 * 1024.0);
+
+    QJsonObject report;
+    report["bytes"] = qint64(source.size());
+    report["threads"] = QThread::idealThreadCount();
+    report["serialMs"] = serialMs;
+    report["jumpAheadMs"] = fastMs;
+    report["serialMiBps"] = mib / (serialMs / 1000.0);
+    report["jumpAheadMiBps"] = mib / (fastMs / 1000.0);
+    report["speedup"] = fastMs > 0.0 ? serialMs / fastMs : 0.0;
+    report["identical"] = serial == fast;
+
+    const QByteArray line = QJsonDocument(report).toJson(QJsonDocument::Compact);
+    std::fwrite(line.constData(), 1, size_t(line.size()), stdout);
+    std::fputc('\n', stdout);
+
+    return serial == fast ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+#include "bench/SceneGenerator.hpp"
+
+#include "components/TransformComponent.hpp"
+#include "core/Component.hpp"
+#include "core/UiElement.hpp"
+#include "scene/SceneDocument.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+#include <QVector>
+
+namespace
+{
+    using CreateFn = UiElement* (SceneDocument::*)(const QString&, UiElement*);
+
+    // The editor's Add menu, in menu order.
+    const CreateFn kCreators[] =
+    {
+        &SceneDocument::CreateTextElement,
+        &SceneDocument::CreateImageElement,
+        &SceneDocument::CreateButtonElement,
+        &SceneDocument::CreateStackLayoutElement,
+        &SceneDocument::CreateGridLayoutElement,
+        &SceneDocument::CreateScrollBoxElement,
+        &SceneDocument::CreatePanelElement,
+        &SceneDocument::CreateProgressBarElement,
+        &SceneDocument::CreateToggleElement,
+        &SceneDocument::CreateDropdownElement,
+        &SceneDocument::CreateTextInputElement,
+        &SceneDocument::CreateIconElement,
+        &SceneDocument::CreateSpriteElement,
+        &SceneDocument::CreateTooltipElement,
+        &SceneDocument::CreateModalElement,
+        &SceneDocument::CreateTabContainerElement,
+        &SceneDocument::CreateRadialMenuElement,
+        &SceneDocument::CreateMinimapElement,
+        &SceneDocument::CreateDragSlotElement,
+        &SceneDocument::CreateListRepeaterElement
+    };
+
+    const int kKinds = int(sizeof(kCreators) / sizeof(kCreators[0]));
+
+    // xorshift32: tiny, and identical on every platform and Qt version.
+    class Rng
+    {
+    public:
+        explicit Rng(quint32 seed) : s(seed ? seed : 1u) {}
+
+        quint32 Next()
+        {
+            s ^= s << 13;
+            s ^= s >> 17;
+            s ^= s << 5;
+            return s;
+        }
+
+        int Range(int lo, int hi) { return lo + int(Next() % quint32(hi - lo + 1)); }
+
+    private:
+        quint32 s;
+    };
+
+    const char* const kWords[] =
+    {
+        "Play", "Options", "Inventory", "Quit", "Health", "Mana", "Quest", "Map",
+        "Level", "Score", "Gold", "Settings", "Back", "Confirm", "Cancel", "Loading"
+    };
+
+    bool WriteAssets(const SceneGenerator::Spec& spec, const QString& assetDir, Rng& rng, QStringList* paths)
+    {
+        if (spec.assetBytes <= 0)
+            return true;
+
+        if (!QDir().mkpath(QDir(assetDir).filePath(QStringLiteral("assets"))))
+            return false;
+
+        const qint64 fileBytes = qMax<qint64>(1, spec.assetFileBytes);
+        qint64 remaining = spec.assetBytes;
+
+        QByteArray chunk;
+        for (int i = 0; remaining > 0; ++i)
+        {
+            const qint64 n = qMin(remaining, fileBytes);
+            remaining -= n;
+
+            // Noise, so a compressing codec cannot shrink it to nothing.
+            chunk.resize(qsizetype(n));
+            quint32* words = reinterpret_cast<quint32*>(chunk.data());
+            for (qint64 w = 0; w < n / 4; ++w)
+                words[w] = rng.Next();
+            for (qint64 b = n & ~qint64(3); b < n; ++b)
+                chunk[qsizetype(b)] = char(rng.Next());
+
+            const QString rel = QStringLiteral("assets/blob_%1.bin").arg(i, 4, 10, QLatin1Char('0'));
+            QFile f(QDir(assetDir).filePath(rel));
+            if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate) || f.write(chunk) != chunk.size())
+                return false;
+
+            paths->append(rel);
+        }
+
+        return true;
+    }
+
+    void Decorate(UiElement* e, Rng& rng, const QStringList& assets, int* nextAsset)
+    {
+        if (auto* t = e->GetComponent<TransformComponent>())
+            t->SetPosition(QPointF(rng.Range(0, 1919), rng.Range(0, 1079)));
+
+        for (Component* c : e->GetComponents())
+        {
+            const QMetaObject* mo = c->metaObject();
+
+            if (mo->indexOfProperty("text") >= 0)
+            {
+                const int words = int(sizeof(kWords) / sizeof(kWords[0]));
+                c->setProperty("text", QStringLiteral("%1 %2")
+                    .arg(QLatin1String(kWords[rng.Next() % quint32(words)]))
+                    .arg(rng.Range(1, 999)));
+            }
+
+            if (!assets.isEmpty() && mo->indexOfProperty("imagePath") >= 0)
+            {
+                const QString& rel = assets[(*nextAsset)++ % assets.size()];
+                c->setProperty("imagePath", rel);
+                if (mo->indexOfProperty("assetRegistryValue") >= 0)
+                    c->setProperty("assetRegistryValue", QStringLiteral("bench:") + rel);
+            }
+        }
+    }
+
+    int CountComponents(const UiElement* e, int* elements)
+    {
+        ++*elements;
+        int n = int(e->GetComponents().size());
+        for (QObject* o : e->children())
+            if (auto* c = qobject_cast<UiElement*>(o))
+                n += CountComponents(c, elements);
+        return n;
+    }
+}
+
+bool SceneGenerator::Generate(SceneDocument& doc, const Spec& spec, const QString& assetDir, Result* result)
+{
+    Rng rng(spec.seed);
+
+    QStringList assets;
+    if (!WriteAssets(spec, assetDir, rng, &assets))
+        return false;
+
+    const int depth = qMax(1, spec.depth);
+    int nextAsset = 0;
+    UiElement* parent = nullptr;
+
+    for (int i = 0; i < spec.elements; ++i)
+    {
+        // Deep: each element nests in the previous one until the chain is
+        // `depth` long, then a new chain starts at the root.
+        if (spec.shape == Shape::Flat || i % depth == 0)
+            parent = nullptr;
+
+        UiElement* e = (doc.*kCreators[i % kKinds])(QStringLiteral("e%1").arg(i), parent);
+        Decorate(e, rng, assets, &nextAsset);
+
+        if (spec.shape == Shape::Deep)
+            parent = e;
+    }
+
+    if (result)
+    {
+        *result = Result();
+        result->components = CountComponents(doc.GetRoot(), &result->elements);
+        result->assetFiles = int(assets.size());
+        result->assetBytes = qMax<qint64>(0, spec.assetBytes);
+    }
+
+    return true;
+}
+
+QString SceneGenerator::ShapeName(Shape shape)
+{
+    return shape == Shape::Deep ? QStringLiteral("deep") : QStringLiteral("flat");
+}
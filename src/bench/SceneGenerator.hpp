@@ -0,0 +1,54 @@
+#ifndef BENCH_SCENEGENERATOR_HPP
+#define BENCH_SCENEGENERATOR_HPP
+
+#include <QString>
+
+class SceneDocument;
+
+// Deterministic synthetic scenes for the benchmarks. The same Spec always
+// produces the same tree, property values and asset bytes, so numbers from
+// two builds are comparable.
+class SceneGenerator
+{
+public:
+
+    enum class Shape
+    {
+        Flat,   // every element a direct child of the root
+        Deep    // chains of `depth` nested elements hanging off the root
+    };
+
+    struct Spec
+    {
+        Shape shape = Shape::Flat;
+        int elements = 1000;        // elements requested (slot children add more)
+        int depth = 64;             // Deep: nesting depth of each chain
+
+        // Total embedded asset bytes, split into files of at most
+        // assetFileBytes and referenced round-robin by the Image, Icon and
+        // Sprite elements. 0: no assets.
+        qint64 assetBytes = 0;
+        qint64 assetFileBytes = 4 * 1024 * 1024;
+
+        quint32 seed = 0x5EED1234u;
+    };
+
+    struct Result
+    {
+        int elements = 0;           // including the root and slot children
+        int components = 0;
+        int assetFiles = 0;
+        qint64 assetBytes = 0;
+    };
+
+    // Populates doc (an empty headless document) in round-robin order over
+    // the 20 element kinds the editor can add, with seeded positions,
+    // sizes and texts. Asset files are written under assetDir, which should
+    // be doc's base directory. Returns false if an asset file cannot be
+    // written.
+    static bool Generate(SceneDocument& doc, const Spec& spec, const QString& assetDir, Result* result = nullptr);
+
+    static QString ShapeName(Shape shape);
+};
+
+#endif
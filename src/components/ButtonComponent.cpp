@@ -108,7 +108,7 @@ void ButtonComponent::SetImagePath(const QString& v)
     if (imagePath == v) return;
     imagePath = v;
     customSkin = QPixmap();
-    if (!imagePath.isEmpty())
+    if (!imagePath.isEmpty() && AssetContext::PreviewEnabled())
     {
         QPixmap loaded(AssetContext::Resolve(imagePath));
         if (!loaded.isNull())
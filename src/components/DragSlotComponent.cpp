@@ -106,7 +106,7 @@ void DragSlotComponent::SetIconPath(const QString& v)
     if (m_iconPath == v) return;
     m_iconPath = v;
     m_iconPixmap = QPixmap();
-    if (!m_iconPath.isEmpty())
+    if (!m_iconPath.isEmpty() && AssetContext::PreviewEnabled())
     {
         QPixmap loaded(AssetContext::Resolve(m_iconPath));
         if (!loaded.isNull())
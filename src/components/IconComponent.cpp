@@ -123,7 +123,7 @@ void IconComponent::ReloadPixmap()
     m_resolvedPath.clear();
     m_resolvedMtime = QDateTime();
 
-    if (m_imagePath.isEmpty())
+    if (m_imagePath.isEmpty() || !AssetContext::PreviewEnabled())
         return;
 
     const QString candidate = AssetContext::Resolve(m_imagePath);
@@ -164,7 +164,7 @@ void ImageComponent::ReloadPixmap()
     resolvedPath.clear();
     resolvedMtime = QDateTime();
 
-    if (imagePath.isEmpty())
+    if (imagePath.isEmpty() || !AssetContext::PreviewEnabled())
         return;
 
     const QString candidate = AssetContext::Resolve(imagePath);
@@ -79,7 +79,7 @@ void SpriteComponent::SetImagePath(const QString& v)
     if (m_imagePath == v) return;
     m_imagePath = v;
     m_pixmap = QPixmap();
-    if (!m_imagePath.isEmpty())
+    if (!m_imagePath.isEmpty() && AssetContext::PreviewEnabled())
     {
         QPixmap loaded(AssetContext::Resolve(m_imagePath));
         if (!loaded.isNull())
@@ -1,11 +1,13 @@
 #include "core/AssetContext.hpp"
 
+#include <QCoreApplication>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QIODevice>
 #include <QString>
 #include <QStringList>
+#include <QThread>
 
 void AssetContext::SetBaseDir(const QString& dir)
 {
@@ -43,6 +45,19 @@ bool AssetContext::IsValidRelative(const QString& v)
     return !parts.contains(QStringLiteral(".."));
 }
 
+void AssetContext::SetPreviewEnabled(bool on)
+{
+    PreviewEnabledRef() = on;
+}
+
+bool AssetContext::PreviewEnabled()
+{
+    // Preview pixmaps are QPixmaps, which only the GUI thread may create;
+    // documents loaded on worker threads (background bakes) skip them.
+    const QCoreApplication* app = QCoreApplication::instance();
+    return PreviewEnabledRef() && (!app || QThread::currentThread() == app->thread());
+}
+
 QString AssetContext::ImportToAssets(const QString& srcAbs)
 {
     if (BaseDirRef().isEmpty() || !QFile::exists(srcAbs))
@@ -74,12 +89,21 @@ QString AssetContext::ImportToAssets(const QString& srcAbs)
     return rel;
 }
 
+// Per thread: the editor only ever touches it from the GUI thread, while the
+// batch baker loads one headless document per worker thread, each with its
+// own project root (fontPath registration resolves through here).
 QString& AssetContext::BaseDirRef()
 {
-    static QString dir;
+    static thread_local QString dir;
     return dir;
 }
 
+bool& AssetContext::PreviewEnabledRef()
+{
+    static bool enabled = true;
+    return enabled;
+}
+
 bool AssetContext::SameContents(const QString& a, const QString& b)
 {
     QFile fa(a);
@@ -10,7 +10,8 @@
 // root). The editor needs that root to load pixmaps/fonts for preview; rather
 // than thread a base directory through every Update()/Paint()/SetXxxPath()
 // signature, components consult this single context. The root is owned by the
-// SceneDocument and mirrored here on every change.
+// SceneDocument and mirrored here on every change. The root is per thread, so
+// documents loaded on different worker threads do not clobber each other.
 class AssetContext
 {
 public:
@@ -30,6 +31,15 @@ public:
     // project root via "..". Empty is allowed (means "no asset").
     static bool IsValidRelative(const QString& v);
 
+    // Whether components decode their referenced images for viewport preview.
+    // On by default; headless tools that only reflect and bake components turn
+    // it off so loading a scene does not decode every referenced pixmap. Paths
+    // and asset identity are unaffected - only the preview pixmaps are skipped.
+    // Always off outside the GUI thread.
+    static void SetPreviewEnabled(bool on);
+
+    static bool PreviewEnabled();
+
     // Copy an arbitrary source file into {baseDir}/assets/, de-duplicating
     // filename collisions (reusing a byte-identical existing copy), and return
     // the stored relative key ("assets/name.ext"). Empty on failure / no root.
@@ -39,6 +49,8 @@ private:
 
     static QString& BaseDirRef();
 
+    static bool& PreviewEnabledRef();
+
     static bool SameContents(const QString& a, const QString& b);
 };
 
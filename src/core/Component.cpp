@@ -2,7 +2,7 @@
 
 #include <QMetaObject>
 
-Component::Component(QObject* parent) : QObject(parent) { }
+Component::Component(QObject* parent) : QObject(parent), revision(NextRevision()) { }
 
 int Component::UpdateOrder() const
 {
@@ -48,6 +48,17 @@ Component* Component::Create(const QString& name, QObject* parent)
     return it != Registry().end() ? it.value()(parent) : nullptr;
 }
 
+quint64 Component::Revision() const noexcept
+{
+    return revision;
+}
+
+quint64 Component::NextRevision()
+{
+    static std::atomic<quint64> counter { 0 };
+    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
 void Component::EmitComponentChanged()
 {
     emit ComponentChanged();
@@ -55,5 +66,6 @@ void Component::EmitComponentChanged()
 
 void Component::NotifyChanged()
 {
+    revision = NextRevision();
     QMetaObject::invokeMethod(this, "EmitComponentChanged", Qt::QueuedConnection);
 }
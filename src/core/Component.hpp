@@ -6,6 +6,7 @@
 #include <QJsonObject>
 #include <QHash>
 #include <QRectF>
+#include <atomic>
 #include <functional>
 
 class SceneElementItem;
@@ -40,6 +41,11 @@ public:
 
     static Component* Create(const QString& name, QObject* parent);
 
+    // Change stamp, bumped by every NotifyChanged() and unique across all
+    // components in the process (a new component never reuses an old stamp).
+    // Bake caches compare it to skip re-reading an unchanged component.
+    quint64 Revision() const noexcept;
+
 public slots:
 
     void EmitComponentChanged();
@@ -52,6 +58,12 @@ signals:
 
     void ComponentChanged();
 
+private:
+
+    static quint64 NextRevision();
+
+    quint64 revision;
+
 };
 
 #define REGISTER_COMPONENT(ClassName, ComponentName) \
@@ -0,0 +1,202 @@
+#include "scene/LiveLinkFrame.hpp"
+#include "scene/UiBinCommon.hpp"
+#include "scene/UiBinPatch.hpp"
+#include "scene/UiBinReader.hpp"
+#include "core/AssetContext.hpp"
+#include "core/UiElement.hpp"
+
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalSocket>
+#include <QTimer>
+#include <cstdio>
+#include <memory>
+
+// ---------------------------------------------------------------------------
+// UIMaker2LiveLink: reference runtime for the editor's live link (File >
+// Live Link). Connects to the editor's local socket, keeps the pushed scene
+// decoded in memory - a full bake through UiBinReader, a patch applied in
+// place with UiBinPatch - and acknowledges every frame, so the editor can
+// resend a full bake when a patch does not fit.
+//
+//   UIMaker2LiveLink [--server <name>] [--frames <n>]
+//
+// stdout carries one compact JSON line per frame: kind, payload bytes,
+// decode/apply time, element count, and the latencies from the edit and
+// from the send (editor and runtime share the machine's wall clock).
+// Reconnects until the editor appears; --frames exits after n frames.
+// ---------------------------------------------------------------------------
+
+namespace
+{
+    class Listener : public QObject
+    {
+    public:
+
+        Listener(const QString& serverName, int maxFrames) : serverName(serverName), maxFrames(maxFrames)
+        {
+            connect(&socket, &QLocalSocket::connected, this, [this]()
+            {
+                std::fprintf(stderr, "UIMaker2LiveLink: connected to '%s'\n", qPrintable(this->serverName));
+            });
+            connect(&socket, &QLocalSocket::disconnected, this, [this]()
+            {
+                // A new editor session starts from a full bake.
+                tree.reset();
+                held = 0;
+                inbox.clear();
+                retry.start();
+            });
+            connect(&socket, &QLocalSocket::errorOccurred, this, [this](QLocalSocket::LocalSocketError)
+            {
+                if (socket.state() == QLocalSocket::UnconnectedState)
+                    retry.start();
+            });
+            connect(&socket, &QLocalSocket::readyRead, this, [this]() { OnReadyRead(); });
+
+            retry.setSingleShot(true);
+            retry.setInterval(500);
+            connect(&retry, &QTimer::timeout, this, [this]() { socket.connectToServer(this->serverName); });
+        }
+
+        void Start()
+        {
+            socket.connectToServer(serverName);
+        }
+
+    private:
+
+        void OnReadyRead()
+        {
+            inbox += socket.readAll();
+
+            LiveLinkFrame frame;
+            QString error;
+            int taken;
+            while ((taken = LiveLinkFrame::Take(inbox, &frame, &error)) > 0)
+                Handle(frame);
+
+            if (taken < 0)
+            {
+                std::fprintf(stderr, "UIMaker2LiveLink: %s\n", qPrintable(error));
+                socket.abort();
+            }
+        }
+
+        void Handle(const LiveLinkFrame& frame)
+        {
+            const qint64 receivedMs = QDateTime::currentMSecsSinceEpoch();
+
+            QElapsedTimer timer;
+            timer.start();
+
+            QString error;
+            if (frame.kind == uibin::LINK_FULL)
+            {
+                tree.reset(UiBinReader::Read(frame.payload));
+                held = tree ? uibin::Hash64(frame.payload.constData(), frame.payload.size()) : 0;
+                if (!tree)
+                    error = QStringLiteral("bake does not decode");
+            }
+            else if (frame.kind == uibin::LINK_PATCH)
+            {
+                quint64 baseHash = 0;
+                quint64 targetHash = 0;
+                if (!UiBinPatch::ReadHeader(frame.payload, &baseHash, &targetHash))
+                    error = QStringLiteral("not a .uibinpatch");
+                else if (!tree || baseHash != held)
+                    error = QStringLiteral("patch is for another base");
+                else if (UiBinPatch::Apply(frame.payload, tree.get(), nullptr, &error))
+                    held = targetHash;
+
+                // On failure the tree is untouched and held still names it;
+                // the editor sees the old hash in the ACK and pushes it all.
+            }
+            else
+            {
+                return;
+            }
+
+            const double applyMs = double(timer.nsecsElapsed()) / 1.0e6;
+            const qint64 doneMs = QDateTime::currentMSecsSinceEpoch();
+
+            QJsonObject status;
+            status["ok"] = error.isEmpty();
+            status["applyMs"] = applyMs;
+            if (!error.isEmpty())
+                status["error"] = error;
+
+            LiveLinkFrame ack;
+            ack.kind = uibin::LINK_ACK;
+            ack.sequence = frame.sequence;
+            ack.bakeHash = held;
+            ack.editMs = frame.editMs;
+            ack.sentMs = frame.sentMs;
+            ack.payload = QJsonDocument(status).toJson(QJsonDocument::Compact);
+            socket.write(ack.Encode());
+            socket.flush();
+
+            QJsonObject report = status;
+            report["sequence"] = qint64(frame.sequence);
+            report["kind"] = frame.kind == uibin::LINK_FULL ? QStringLiteral("full") : QStringLiteral("patch");
+            report["bytes"] = qint64(frame.payload.size());
+            report["transitMs"] = receivedMs - frame.sentMs;
+            if (frame.editMs > 0)
+                report["editToScreenMs"] = doneMs - frame.editMs;
+            if (tree)
+                report["elements"] = qint64(tree->findChildren<UiElement*>().size() + 1);
+
+            const QByteArray line = QJsonDocument(report).toJson(QJsonDocument::Compact);
+            std::fwrite(line.constData(), 1, size_t(line.size()), stdout);
+            std::fputc('\n', stdout);
+            std::fflush(stdout);
+
+            if (maxFrames > 0 && ++frames >= maxFrames)
+                QCoreApplication::exit(0);
+        }
+
+        QString serverName;
+        int maxFrames = 0;
+        int frames = 0;
+
+        QLocalSocket socket;
+        QTimer retry;
+        QByteArray inbox;
+
+        std::unique_ptr<UiElement> tree;
+        quint64 held = 0;
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    // Components measure text with QFont; "offscreen" needs no display.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+    QGuiApplication::setOrganizationName("UIMaker");
+    QGuiApplication::setApplicationName("UIMaker2LiveLink");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Reference runtime for the editor's live link: decodes every push and reports latency.");
+    parser.addHelpOption();
+
+    const QCommandLineOption serverOpt(QStringLiteral("server"), "Local socket name to connect to.", "name",
+                                       QString::fromLatin1(uibin::kLiveLinkServerName));
+    const QCommandLineOption framesOpt(QStringLiteral("frames"), "Exit after n frames (0: run until killed).", "n", "0");
+    parser.addOption(serverOpt);
+    parser.addOption(framesOpt);
+    parser.process(app);
+
+    AssetContext::SetPreviewEnabled(false);
+
+    Listener listener(parser.value(serverOpt), parser.value(framesOpt).toInt());
+    listener.Start();
+
+    return app.exec();
+}
@@ -0,0 +1,151 @@
+#include "scene/UiBinPatch.hpp"
+#include "scene/UiBinReader.hpp"
+#include "core/AssetContext.hpp"
+#include "core/UiElement.hpp"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGuiApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cstdio>
+#include <memory>
+
+// ---------------------------------------------------------------------------
+// UIMaker2Patch: writes the .uibinpatch that turns one bake of a scene into
+// another (see uibin_patch_spec.txt), for pushing small edits to a running
+// instance instead of the whole container.
+//
+//   UIMaker2Patch [--no-verify] <base.uibin> <target.uibin> <output.uibinpatch>
+//
+// Unless --no-verify is given, the patch is checked the way a runtime would
+// use it: the base is decoded with UiBinReader, the patch applied in place,
+// and the result compared with a decode of the target.
+//
+// stdout carries one compact JSON report. Exit code: 0 ok, 1 usage, 2 a bake
+// could not be read or the patch not written, 3 verification failed.
+// ---------------------------------------------------------------------------
+
+namespace
+{
+    enum ExitCode
+    {
+        ExitOk = 0,
+        ExitUsage = 1,
+        ExitFailed = 2,
+        ExitMismatch = 3
+    };
+
+    bool ReadFile(const QString& path, QByteArray* out)
+    {
+        QFile f(path);
+        if (!f.open(QIODevice::ReadOnly))
+            return false;
+        *out = f.readAll();
+        return true;
+    }
+
+    QJsonObject TreeJson(const UiElement* root)
+    {
+        QJsonObject o;
+        root->ToJson(o);
+        return o;
+    }
+
+    int Finish(QJsonObject& report, const QElapsedTimer& total, ExitCode code, const QString& error = QString())
+    {
+        if (!error.isEmpty())
+        {
+            report["error"] = error;
+            std::fprintf(stderr, "UIMaker2Patch: %s\n", qPrintable(error));
+        }
+        report["ok"] = code == ExitOk;
+        report["processMs"] = double(total.nsecsElapsed()) / 1.0e6;
+
+        const QByteArray line = QJsonDocument(report).toJson(QJsonDocument::Compact);
+        std::fwrite(line.constData(), 1, size_t(line.size()), stdout);
+        std::fputc('\n', stdout);
+        return code;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    QElapsedTimer total;
+    total.start();
+
+    // Components measure text with QFont; "offscreen" needs no display.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+    QGuiApplication::setOrganizationName("UIMaker");
+    QGuiApplication::setApplicationName("UIMaker2Patch");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Writes a binary delta between two .uibin bakes of a scene.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("base", "The bake the runtime has loaded.");
+    parser.addPositionalArgument("target", "The new bake.");
+    parser.addPositionalArgument("output", "Output .uibinpatch path.");
+
+    const QCommandLineOption noVerifyOpt(QStringLiteral("no-verify"), "Skip applying the patch to a decode of the base.");
+    parser.addOption(noVerifyOpt);
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.size() != 3)
+    {
+        std::fputs(qPrintable(parser.helpText()), stderr);
+        return ExitUsage;
+    }
+
+    AssetContext::SetPreviewEnabled(false);
+
+    QJsonObject report;
+    report["base"] = args.at(0);
+    report["target"] = args.at(1);
+    report["output"] = args.at(2);
+
+    QByteArray base;
+    QByteArray target;
+    if (!ReadFile(args.at(0), &base) || !ReadFile(args.at(1), &target))
+        return Finish(report, total, ExitFailed, QStringLiteral("cannot read the bakes"));
+
+    QElapsedTimer phase;
+    phase.start();
+
+    QString error;
+    const QByteArray patch = UiBinPatch::Diff(base, target, &error);
+    if (patch.isEmpty())
+        return Finish(report, total, ExitFailed, error);
+
+    report["diffMs"] = double(phase.nsecsElapsed()) / 1.0e6;
+    report["baseBytes"] = qint64(base.size());
+    report["targetBytes"] = qint64(target.size());
+    report["patchBytes"] = qint64(patch.size());
+
+    QFile out(args.at(2));
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate) || out.write(patch) != patch.size())
+        return Finish(report, total, ExitFailed, QStringLiteral("cannot write the patch"));
+    out.close();
+
+    if (parser.isSet(noVerifyOpt))
+        return Finish(report, total, ExitOk);
+
+    const std::unique_ptr<UiElement> patched(UiBinReader::Read(base));
+    const std::unique_ptr<UiElement> expected(UiBinReader::Read(target));
+    if (!patched || !expected)
+        return Finish(report, total, ExitFailed, QStringLiteral("a bake does not decode"));
+
+    phase.restart();
+    if (!UiBinPatch::Apply(patch, patched.get(), nullptr, &error))
+        return Finish(report, total, ExitMismatch, error);
+    report["applyMs"] = double(phase.nsecsElapsed()) / 1.0e6;
+
+    if (TreeJson(patched.get()) != TreeJson(expected.get()))
+        return Finish(report, total, ExitMismatch, QStringLiteral("patched tree differs from the target"));
+
+    return Finish(report, total, ExitOk);
+}
@@ -0,0 +1,68 @@
+#include "scene/AssetCache.hpp"
+#include "scene/UiBinCommon.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QMutexLocker>
+
+AssetCache::Entry AssetCache::Get(const QString& absPath, bool withHash)
+{
+    const QString key = QDir::cleanPath(absPath);
+
+    std::shared_ptr<Slot> slot;
+    {
+        QMutexLocker lock(&mutex);
+
+        std::shared_ptr<Slot>& s = entries[key];
+        if (!s)
+            s = std::make_shared<Slot>();
+
+        slot = s;
+    }
+
+    // The file read happens outside the map lock so unrelated assets load in
+    // parallel; call_once serialises only callers of this one path.
+    bool loadedHere = false;
+    std::call_once(slot->once, [&]()
+    {
+        loadedHere = true;
+
+        QFile f(key);
+        if (f.open(QIODevice::ReadOnly))
+        {
+            slot->entry.data = f.readAll();
+            slot->entry.found = true;
+        }
+    });
+
+    (loadedHere ? misses : hits).fetch_add(1, std::memory_order_relaxed);
+
+    Entry out;
+    out.data = slot->entry.data;
+    out.found = slot->entry.found;
+
+    // The hash fields are read only after this thread has passed hashOnce,
+    // so a caller not asking for them never races the one computing them.
+    if (withHash)
+    {
+        std::call_once(slot->hashOnce, [&]()
+        {
+            slot->entry.hash = uibin::Hash64(slot->entry.data.constData(), slot->entry.data.size());
+            slot->entry.hashed = true;
+        });
+        out.hash = slot->entry.hash;
+        out.hashed = true;
+    }
+
+    return out;
+}
+
+qint64 AssetCache::Hits() const
+{
+    return hits.load(std::memory_order_relaxed);
+}
+
+qint64 AssetCache::Misses() const
+{
+    return misses.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,59 @@
+#ifndef SCENE_ASSETCACHE_HPP
+#define SCENE_ASSETCACHE_HPP
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+// Thread-safe cache of asset file bytes, keyed by absolute path.
+//
+// A single bake reads each asset once already (Bake::RegisterAsset de-dups
+// per scene). When many scenes are baked in one process - the batch baker -
+// the same fonts and icons would otherwise be read from disk for every scene.
+// Sharing one AssetCache across those bakes means each file is read exactly
+// once, and hashed at most once and only if a caller asks for the hash,
+// even when several worker threads ask for it at the same moment: the first
+// caller loads, the others block on that entry only.
+//
+// Entries are never invalidated; the cache is meant to live for one batch,
+// not across edits.
+class AssetCache
+{
+public:
+
+    struct Entry
+    {
+        QByteArray data;         // raw file bytes (implicitly shared)
+        quint64 hash = 0;        // uibin::Hash64 of data, if hashed
+        bool hashed = false;
+        bool found = false;      // false if the file could not be opened
+    };
+
+    // Returns the bytes for absPath, reading the file on first request.
+    // withHash also fills Entry::hash, computed on the first request that
+    // asks for it. Safe to call from any thread.
+    Entry Get(const QString& absPath, bool withHash = false);
+
+    qint64 Hits() const;
+    qint64 Misses() const;
+
+private:
+
+    struct Slot
+    {
+        std::once_flag once;
+        std::once_flag hashOnce;
+        Entry entry;
+    };
+
+    QMutex mutex;
+    QHash<QString, std::shared_ptr<Slot>> entries;
+    std::atomic<qint64> hits { 0 };
+    std::atomic<qint64> misses { 0 };
+};
+
+#endif
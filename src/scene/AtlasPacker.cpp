@@ -0,0 +1,97 @@
+#include "scene/AtlasPacker.hpp"
+
+#include <algorithm>
+
+AtlasPacker::AtlasPacker(int width, int height)
+    : width(width), height(height)
+{
+    skyline.push_back(Segment { 0, 0, width });
+}
+
+int AtlasPacker::FitAt(int i, int w, int h) const
+{
+    const int x = skyline[i].x;
+    if (x + w > width)
+        return -1;
+
+    int y = 0;
+    int left = w;
+    for (int j = i; left > 0; ++j)
+    {
+        y = std::max(y, skyline[j].y);
+        if (y + h > height)
+            return -1;
+        left -= skyline[j].w;
+    }
+
+    return y;
+}
+
+bool AtlasPacker::Insert(int w, int h, QPoint* pos)
+{
+    if (w <= 0 || h <= 0 || w > width || h > height)
+        return false;
+
+    int best = -1;
+    int bestY = 0;
+    for (int i = 0; i < skyline.size(); ++i)
+    {
+        const int y = FitAt(i, w, h);
+        if (y < 0)
+            continue;
+
+        // Segments run left to right, so the first lowest fit is leftmost.
+        if (best < 0 || y < bestY)
+        {
+            best = i;
+            bestY = y;
+        }
+    }
+
+    if (best < 0)
+        return false;
+
+    const int x = skyline[best].x;
+    *pos = QPoint(x, bestY);
+
+    // Raise the skyline under the new rectangle: insert its top edge, then
+    // trim or drop the segments it now covers.
+    skyline.insert(best, Segment { x, bestY + h, w });
+
+    for (int j = best + 1; j < skyline.size(); )
+    {
+        Segment& s = skyline[j];
+        const int coveredTo = x + w;
+        if (s.x >= coveredTo)
+            break;
+
+        const int overlap = coveredTo - s.x;
+        if (overlap >= s.w)
+        {
+            skyline.remove(j);
+            continue;
+        }
+
+        s.x += overlap;
+        s.w -= overlap;
+        break;
+    }
+
+    // Merge neighbours at the same height.
+    for (int j = 0; j + 1 < skyline.size(); )
+    {
+        if (skyline[j].y == skyline[j + 1].y)
+        {
+            skyline[j].w += skyline[j + 1].w;
+            skyline.remove(j + 1);
+        }
+        else
+        {
+            ++j;
+        }
+    }
+
+    usedWidth = std::max(usedWidth, x + w);
+    usedHeight = std::max(usedHeight, bestY + h);
+    return true;
+}
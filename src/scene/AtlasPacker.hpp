@@ -0,0 +1,47 @@
+#ifndef SCENE_ATLASPACKER_HPP
+#define SCENE_ATLASPACKER_HPP
+
+#include <QPoint>
+#include <QVector>
+
+// Skyline bottom-left rectangle packer for one atlas page. Each Insert places
+// the rectangle where its top edge ends lowest (ties: leftmost), tracking the
+// page as a list of horizontal skyline segments - fast, and tight enough for
+// UI sprites and glyphs sorted by height.
+class AtlasPacker
+{
+public:
+
+    AtlasPacker(int width, int height);
+
+    // Places a w x h rectangle; returns false when it no longer fits.
+    bool Insert(int w, int h, QPoint* pos);
+
+    int Width() const { return width; }
+    int Height() const { return height; }
+
+    // Bounding extent of everything placed so far.
+    int UsedWidth() const { return usedWidth; }
+    int UsedHeight() const { return usedHeight; }
+
+private:
+
+    struct Segment
+    {
+        int x;
+        int y;
+        int w;
+    };
+
+    // Lowest y at which a w-wide rectangle can sit starting at segment i, or
+    // -1 if it would run off the page.
+    int FitAt(int i, int w, int h) const;
+
+    int width;
+    int height;
+    int usedWidth = 0;
+    int usedHeight = 0;
+    QVector<Segment> skyline;
+};
+
+#endif
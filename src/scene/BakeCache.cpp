@@ -0,0 +1,265 @@
+#include "scene/BakeCache.hpp"
+#include "scene/UiBinCommon.hpp"
+
+#include <QFile>
+#include <QFileInfo>
+
+using namespace uibin;
+
+namespace
+{
+    // On-disk cache file: "UIBC", u32 version, u32 record count, then per
+    // record: u64 key, strings, assets, schemas, patches, bytes. Little-endian, not
+    // masked; it is a build artefact, never shipped.
+    const char    kCacheMagic[4] = { 'U', 'I', 'B', 'C' };
+    const quint32 kCacheVersion = 3;
+
+    void Str(Writer& w, const QString& s)
+    {
+        const QByteArray u = s.toUtf8();
+        w.U32(quint32(u.size()));
+        w.Raw(u.constData(), u.size());
+    }
+
+    QString Str(Reader& r)
+    {
+        return QString::fromUtf8(r.Bytes(int(r.U32())));
+    }
+
+    // Every patch must point at a u32 inside the record that names an
+    // existing local string / asset / schema, or splicing would read out of
+    // bounds.
+    bool IsWellFormed(const BakeCache::Node& n)
+    {
+        const uchar* src = reinterpret_cast<const uchar*>(n.bytes.constData());
+
+        for (quint32 patch : n.patches)
+        {
+            const quint32 off = patch >> 2;
+            if (qint64(off) + 4 > n.bytes.size())
+                return false;
+
+            const quint32 local = quint32(src[off])
+                                | (quint32(src[off + 1]) << 8)
+                                | (quint32(src[off + 2]) << 16)
+                                | (quint32(src[off + 3]) << 24);
+
+            qsizetype limit = 0;
+            switch (patch & 3u)
+            {
+            case BakeCache::Node::PATCH_STRING: limit = n.strings.size(); break;
+            case BakeCache::Node::PATCH_ASSET:  limit = n.assets.size();  break;
+            case BakeCache::Node::PATCH_SCHEMA: limit = n.schemas.size(); break;
+            default:                                           break;
+            }
+
+            if (qsizetype(local) >= limit)
+                return false;
+        }
+
+        for (const BakeCache::Node::Schema& s : n.schemas)
+            if (s.names.size() != s.tags.size())
+                return false;
+
+        return true;
+    }
+}
+
+bool BakeCache::Load(const QString& filePath)
+{
+    QFile f(filePath);
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+
+    const QByteArray bytes = f.readAll();
+    f.close();
+
+    Reader r(bytes.constData(), bytes.size());
+
+    const QByteArray magic = r.Bytes(4);
+    if (magic != QByteArray(kCacheMagic, 4) || r.U32() != kCacheVersion)
+        return false;
+
+    QHash<quint64, Node> loaded;
+    const quint32 count = r.U32();
+
+    for (quint32 i = 0; i < count && r.ok(); ++i)
+    {
+        const quint64 key = r.U64();
+        Node n;
+
+        const quint32 strCount = r.U32();
+        for (quint32 s = 0; s < strCount && r.ok(); ++s)
+            n.strings.push_back(Str(r));
+
+        const quint32 assetCount = r.U32();
+        for (quint32 a = 0; a < assetCount && r.ok(); ++a)
+        {
+            Node::AssetKey k;
+            k.path = Str(r);
+            k.domain = Str(r);
+            k.registry = Str(r);
+            k.atlasImage = r.U8() != 0;
+            n.assets.push_back(k);
+        }
+
+        const quint32 schemaCount = r.U32();
+        for (quint32 s = 0; s < schemaCount && r.ok(); ++s)
+        {
+            Node::Schema sc;
+            sc.type = Str(r);
+            const quint32 fields = r.U32();
+            for (quint32 f = 0; f < fields && r.ok(); ++f)
+            {
+                sc.names.push_back(Str(r));
+                sc.tags.push_back(r.U8());
+            }
+            n.schemas.push_back(sc);
+        }
+
+        const quint32 patchCount = r.U32();
+        for (quint32 p = 0; p < patchCount && r.ok(); ++p)
+            n.patches.push_back(r.U32());
+
+        n.bytes = r.Bytes(int(r.U32()));
+
+        if (r.ok() && IsWellFormed(n))
+            loaded.insert(key, n);
+    }
+
+    // A truncated or corrupt cache is simply ignored: the next bake encodes
+    // everything and rewrites it.
+    if (!r.ok())
+        return false;
+
+    nodes = loaded;
+    return true;
+}
+
+bool BakeCache::Save(const QString& filePath) const
+{
+    Writer w;
+    w.Raw(kCacheMagic, 4);
+    w.U32(kCacheVersion);
+    w.U32(quint32(nodes.size()));
+
+    for (auto it = nodes.begin(); it != nodes.end(); ++it)
+    {
+        const Node& n = it.value();
+        w.U64(it.key());
+
+        w.U32(quint32(n.strings.size()));
+        for (const QString& s : n.strings)
+            Str(w, s);
+
+        w.U32(quint32(n.assets.size()));
+        for (const Node::AssetKey& k : n.assets)
+        {
+            Str(w, k.path);
+            Str(w, k.domain);
+            Str(w, k.registry);
+            w.U8(k.atlasImage ? 1 : 0);
+        }
+
+        w.U32(quint32(n.schemas.size()));
+        for (const Node::Schema& s : n.schemas)
+        {
+            Str(w, s.type);
+            w.U32(quint32(s.names.size()));
+            for (int f = 0; f < s.names.size(); ++f)
+            {
+                Str(w, s.names[f]);
+                w.U8(s.tags[f]);
+            }
+        }
+
+        w.U32(quint32(n.patches.size()));
+        for (quint32 p : n.patches)
+            w.U32(p);
+
+        w.U32(quint32(n.bytes.size()));
+        w.Raw(n.bytes.constData(), n.bytes.size());
+    }
+
+    QFile f(filePath);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    const bool ok = f.write(w.buffer()) == w.buffer().size();
+    f.close();
+    return ok;
+}
+
+void BakeCache::BeginBake()
+{
+    touchedNodes.clear();
+    touchedComponents.clear();
+    touchedAssets.clear();
+    hits = 0;
+    misses = 0;
+}
+
+void BakeCache::EndBake()
+{
+    for (auto it = nodes.begin(); it != nodes.end();)
+        it = touchedNodes.contains(it.key()) ? std::next(it) : nodes.erase(it);
+
+    for (auto it = componentMemo.begin(); it != componentMemo.end();)
+        it = touchedComponents.contains(it.key()) ? std::next(it) : componentMemo.erase(it);
+
+    for (auto it = assetFiles.begin(); it != assetFiles.end();)
+        it = touchedAssets.contains(it.key()) ? std::next(it) : assetFiles.erase(it);
+}
+
+const BakeCache::Node* BakeCache::FindNode(quint64 key)
+{
+    auto it = nodes.constFind(key);
+    if (it == nodes.constEnd())
+    {
+        ++misses;
+        return nullptr;
+    }
+
+    ++hits;
+    touchedNodes.insert(key);
+    return &it.value();
+}
+
+void BakeCache::InsertNode(quint64 key, const Node& node)
+{
+    nodes.insert(key, node);
+    touchedNodes.insert(key);
+}
+
+QByteArray BakeCache::AssetBytes(const QString& absPath)
+{
+    touchedAssets.insert(absPath);
+
+    const QFileInfo fi(absPath);
+    const qint64 size = fi.exists() ? fi.size() : -1;
+    const QDateTime mtime = fi.lastModified();
+
+    AssetFile& a = assetFiles[absPath];
+    if (a.size == size && a.mtime == mtime && size >= 0)
+        return a.data;
+
+    a.size = size;
+    a.mtime = mtime;
+    a.data.clear();
+
+    QFile f(absPath);
+    if (f.open(QIODevice::ReadOnly))
+        a.data = f.readAll();
+
+    return a.data;
+}
+
+int BakeCache::NodeHits() const
+{
+    return hits;
+}
+
+int BakeCache::NodeMisses() const
+{
+    return misses;
+}
@@ -0,0 +1,130 @@
+#ifndef SCENE_BAKECACHE_HPP
+#define SCENE_BAKECACHE_HPP
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+class Component;
+
+// Incremental-bake cache for UiBinWriter.
+//
+// The writer encodes every element's own record (name, UUID, components -
+// everything except its children) in a relocatable form: string ids, asset
+// indexes and schema ids are local to the record, and the byte offsets
+// holding them are listed so they can be rewritten to global ids when the
+// record is spliced into the tree. Such a record depends only on the
+// element's own inputs, so it is stored here keyed by a content hash of those
+// inputs (element name, UUID, component types and property values). A rebake
+// re-encodes only elements whose hash is new and splices everything else
+// from the cache; the string, asset and schema tables are rebuilt from the
+// spliced records.
+//
+// Two further caches make the remaining per-bake work cheap in a long-lived
+// process (the editor): component content hashes are memoised against
+// Component::Revision(), and asset bytes are kept keyed by (path, size,
+// mtime) so unchanged files are not re-read.
+//
+// Only element records persist to disk (Save/Load); the memo and asset bytes
+// are in-memory only. A BakeCache serves one bake at a time.
+class BakeCache
+{
+public:
+
+    struct Node
+    {
+        struct AssetKey
+        {
+            QString path;
+            QString domain;
+            QString registry;
+            bool atlasImage = false;  // may be packed into an atlas page
+        };
+
+        // Field layout of a schema-form component record.
+        struct Schema
+        {
+            QString type;
+            QVector<QString> names;   // in value order
+            QVector<quint8> tags;
+        };
+
+        enum PatchKind : quint32
+        {
+            PATCH_STRING = 0,
+            PATCH_ASSET  = 1,
+            PATCH_SCHEMA = 2
+        };
+
+        QByteArray bytes;             // element record with local ids
+        QVector<QString> strings;     // local string id -> string
+        QVector<AssetKey> assets;     // local asset index -> identity
+        QVector<Schema> schemas;      // local schema id -> layout
+        QVector<quint32> patches;     // (byte offset << 2) | PatchKind
+    };
+
+    bool Load(const QString& filePath);
+    bool Save(const QString& filePath) const;
+
+    // Called by the writer around each bake. EndBake drops every record,
+    // memo entry and asset not used by the bake just finished, so the cache
+    // tracks the current scene instead of growing without bound.
+    void BeginBake();
+    void EndBake();
+
+    const Node* FindNode(quint64 key);
+    void InsertNode(quint64 key, const Node& node);
+
+    // Returns the memoised content hash of comp if its revision is unchanged;
+    // otherwise computes it with hashFn and remembers it.
+    template <typename HashFn> quint64 ComponentHash(const Component* comp, quint64 revision, HashFn hashFn)
+    {
+        touchedComponents.insert(comp);
+
+        auto it = componentMemo.find(comp);
+        if (it != componentMemo.end() && it->revision == revision)
+            return it->hash;
+
+        const quint64 h = hashFn();
+        componentMemo.insert(comp, Memo { revision, h });
+        return h;
+    }
+
+    // Bytes of absPath, re-read only when its size or mtime changed.
+    QByteArray AssetBytes(const QString& absPath);
+
+    int NodeHits() const;
+    int NodeMisses() const;
+
+private:
+
+    struct Memo
+    {
+        quint64 revision;
+        quint64 hash;
+    };
+
+    struct AssetFile
+    {
+        qint64 size = -1;
+        QDateTime mtime;
+        QByteArray data;
+    };
+
+    QHash<quint64, Node> nodes;
+    QSet<quint64> touchedNodes;
+
+    QHash<const Component*, Memo> componentMemo;
+    QSet<const Component*> touchedComponents;
+
+    QHash<QString, AssetFile> assetFiles;
+    QSet<QString> touchedAssets;
+
+    int hits = 0;
+    int misses = 0;
+};
+
+#endif
@@ -0,0 +1,38 @@
+#include "scene/BakeProgress.hpp"
+
+namespace
+{
+    // Start of each phase's slice of 0..1000, indexed by Phase.
+    const int kPhaseStart[] = { 0, 0, 100, 650, 800, 1000 };
+}
+
+void BakeProgress::Reset()
+{
+    cancelled.store(false, std::memory_order_relaxed);
+    Begin(PHASE_IDLE);
+}
+
+void BakeProgress::Begin(Phase p, qint64 steps)
+{
+    // Total before phase, so a poller never sees the new phase with the
+    // previous phase's count.
+    done.store(0, std::memory_order_relaxed);
+    total.store(steps, std::memory_order_relaxed);
+    phase.store(p, std::memory_order_release);
+}
+
+int BakeProgress::Permille() const
+{
+    const int p = phase.load(std::memory_order_acquire);
+    if (p >= PHASE_DONE)
+        return 1000;
+
+    const int start = kPhaseStart[p];
+    const int span = kPhaseStart[p + 1] - start;
+    const qint64 t = total.load(std::memory_order_relaxed);
+    if (t <= 0)
+        return start;
+
+    const qint64 d = qMin(done.load(std::memory_order_relaxed), t);
+    return start + int(qint64(span) * d / t);
+}
@@ -0,0 +1,51 @@
+#ifndef SCENE_BAKEPROGRESS_HPP
+#define SCENE_BAKEPROGRESS_HPP
+
+#include <QtGlobal>
+
+#include <atomic>
+
+// Progress and cancellation for a bake running off the GUI thread. The
+// worker reports into it (UiBinWriteOptions::progress, SceneExporter) and
+// checks IsCancelled at its checkpoints; the GUI polls Permille and calls
+// Cancel. Every member is atomic, so no locking is needed on either side.
+class BakeProgress
+{
+public:
+
+    // In bake order. Each phase owns a fixed slice of the overall range,
+    // sized after where time goes on a large scene.
+    enum Phase
+    {
+        PHASE_IDLE,
+        PHASE_LOAD,         // snapshot into a headless document
+        PHASE_ENCODE,       // element tree walk; counts elements
+        PHASE_FINISH,       // atlas, glyphs, codecs, assembly, file write
+        PHASE_VALIDATE,     // round-trip UiBinReader::Validate
+        PHASE_DONE
+    };
+
+    // Back to idle and not cancelled, for reuse by the next bake. Only
+    // while no worker holds it.
+    void Reset();
+
+    // Enters phase with total steps (0: no fine-grained progress).
+    void Begin(Phase phase, qint64 total = 0);
+    void Advance(qint64 steps = 1) { done.fetch_add(steps, std::memory_order_relaxed); }
+
+    Phase CurrentPhase() const { return Phase(phase.load(std::memory_order_relaxed)); }
+
+    // Overall progress, 0..1000.
+    int Permille() const;
+
+    void Cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    bool IsCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int> phase { PHASE_IDLE };
+    std::atomic<qint64> done { 0 };
+    std::atomic<qint64> total { 0 };
+    std::atomic<bool> cancelled { false };
+};
+
+#endif
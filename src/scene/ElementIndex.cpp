@@ -0,0 +1,127 @@
+#include "scene/ElementIndex.hpp"
+#include "scene/UiBinCommon.hpp"
+
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace uibin;
+
+namespace
+{
+    quint32 LoadU32(const char* p) { return qFromLittleEndian<quint32>(p); }
+
+    const char* EntryAt(const char* data, quint32 i)
+    {
+        return data + kElementIndexHeaderSize + quint64(i) * kElementIndexEntrySize;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// ElementIndexBuilder
+// ---------------------------------------------------------------------------
+
+void ElementIndexBuilder::Add(QByteArrayView uuid, quint32 parent, quint32 offset, quint32 subtreeSize)
+{
+    Entry e;
+    e.uuid = uuid.toByteArray();
+    e.uuid.resize(16);
+    e.element = quint32(entries.size());
+    e.parent = parent;
+    e.offset = offset;
+    e.subtreeSize = subtreeSize;
+    entries.push_back(e);
+}
+
+QByteArray ElementIndexBuilder::Section() const
+{
+    // Ties (duplicated UUIDs) keep tree order, so Find lands on the first.
+    QVector<Entry> sorted = entries;
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Entry& a, const Entry& b)
+    {
+        return std::memcmp(a.uuid.constData(), b.uuid.constData(), 16) < 0;
+    });
+
+    Writer w;
+    w.U32(quint32(sorted.size()));
+    w.U32(0);
+
+    for (const Entry& e : sorted)
+    {
+        w.Raw(e.uuid.constData(), 16);
+        w.U32(e.element);
+        w.U32(e.parent);
+        w.U32(e.offset);
+        w.U32(e.subtreeSize);
+    }
+
+    return w.buffer();
+}
+
+// ---------------------------------------------------------------------------
+// ElementIndexView
+// ---------------------------------------------------------------------------
+
+bool ElementIndexView::Open(QByteArrayView section)
+{
+    data = nullptr;
+    count = 0;
+
+    if (section.size() < qsizetype(kElementIndexHeaderSize))
+        return false;
+
+    const char* d = section.data();
+    const quint32 n = LoadU32(d);
+    if (kElementIndexHeaderSize + quint64(n) * kElementIndexEntrySize != quint64(section.size()))
+        return false;
+
+    // Find relies on the order.
+    for (quint32 i = 1; i < n; ++i)
+        if (std::memcmp(EntryAt(d, i - 1), EntryAt(d, i), 16) > 0)
+            return false;
+
+    data = d;
+    count = n;
+    return true;
+}
+
+ElementIndexView::Entry ElementIndexView::At(quint32 i) const
+{
+    Entry e;
+    if (i >= count)
+        return e;
+
+    const char* p = EntryAt(data, i);
+    e.uuid        = QByteArrayView(p, 16);
+    e.element     = LoadU32(p + 16);
+    e.parent      = LoadU32(p + 20);
+    e.offset      = LoadU32(p + 24);
+    e.subtreeSize = LoadU32(p + 28);
+    return e;
+}
+
+bool ElementIndexView::Find(QByteArrayView uuid, Entry* out) const
+{
+    if (uuid.size() != 16)
+        return false;
+
+    // Lower bound, so the first of any duplicates wins.
+    quint32 lo = 0;
+    quint32 hi = count;
+    while (lo < hi)
+    {
+        const quint32 mid = lo + (hi - lo) / 2;
+        if (std::memcmp(EntryAt(data, mid), uuid.data(), 16) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == count || std::memcmp(EntryAt(data, lo), uuid.data(), 16) != 0)
+        return false;
+
+    if (out)
+        *out = At(lo);
+    return true;
+}
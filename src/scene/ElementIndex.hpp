@@ -0,0 +1,73 @@
+#ifndef SCENE_ELEMENTINDEX_HPP
+#define SCENE_ELEMENTINDEX_HPP
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QVector>
+
+// Bake side of the EIDX extension section (spec section 11.6): every element
+// of the tree sorted by UUID, with where its record starts and how many bytes
+// its subtree spans, so a runtime can binary-search a UUID and decode just
+// that element or subtree - one menu screen out of a large shared bake -
+// without walking the tree from the root.
+//
+// Offsets are relative to the header's treeOffset, so the section can be
+// built before the container is assembled.
+class ElementIndexBuilder
+{
+public:
+
+    // Adds the next element in pre-order. parent is the pre-order index of
+    // its parent (uibin::kNoElement for the root).
+    void Add(QByteArrayView uuid, quint32 parent, quint32 offset, quint32 subtreeSize);
+
+    bool IsEmpty() const { return entries.isEmpty(); }
+
+    QByteArray Section() const;
+
+private:
+
+    struct Entry
+    {
+        QByteArray uuid;            // 16 bytes, RFC-4122 order
+        quint32 element;
+        quint32 parent;
+        quint32 offset;
+        quint32 subtreeSize;
+    };
+
+    QVector<Entry> entries;         // pre-order
+};
+
+// Read side: lookups over an EIDX section body. Holds only the view; the
+// bytes must outlive it.
+class ElementIndexView
+{
+public:
+
+    struct Entry
+    {
+        QByteArrayView uuid;
+        quint32 element = 0;        // pre-order index (root = 0)
+        quint32 parent = 0;         // uibin::kNoElement for the root
+        quint32 offset = 0;         // record start, relative to treeOffset
+        quint32 subtreeSize = 0;    // record, child count and every descendant
+    };
+
+    // Returns false if the body is not a well-formed EIDX section.
+    bool Open(QByteArrayView section);
+
+    quint32 Count() const { return count; }
+
+    // Entry i in UUID order.
+    Entry At(quint32 i) const;
+
+    // Binary search by the element's 16 raw UUID bytes.
+    bool Find(QByteArrayView uuid, Entry* out) const;
+
+private:
+    const char* data = nullptr;
+    quint32 count = 0;
+};
+
+#endif
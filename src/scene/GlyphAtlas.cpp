@@ -0,0 +1,504 @@
+#include "scene/GlyphAtlas.hpp"
+#include "scene/AtlasPacker.hpp"
+#include "scene/UiBinCommon.hpp"
+
+#include <QBuffer>
+#include <QFont>
+#include <QImage>
+#include <QPainter>
+#include <QPainterPath>
+#include <QRawFont>
+#include <QtEndian>
+#include <QtMath>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace uibin;
+
+namespace
+{
+    // Up to this many glyphs a face gets kerning for every ordered pair;
+    // beyond it only for pairs that actually occur in the scene's text.
+    const int kAllPairsMaxGlyphs = 128;
+
+    qint32 Fixed(qreal v) { return qint32(qRound(v * 64.0)); }
+
+    quint32 LoadU32(const char* p) { return qFromLittleEndian<quint32>(p); }
+    qint32  LoadI32(const char* p) { return qFromLittleEndian<qint32>(p); }
+}
+
+// ---------------------------------------------------------------------------
+// GlyphAtlasBuilder
+// ---------------------------------------------------------------------------
+
+GlyphAtlasBuilder::GlyphAtlasBuilder(int pageSize, int padding)
+    : pageSize(qBound(64, pageSize, 0xFFFF)), padding(qBound(0, padding, 64))
+{
+}
+
+void GlyphAtlasBuilder::Add(quint32 familyId, const QString& family, quint32 fontAsset, const QByteArray& fontData,
+                            int pixelSize, const QString& text, bool editable)
+{
+    if (pixelSize <= 0)
+        return;
+
+    const QString key = (fontData.isEmpty() ? QStringLiteral("F:") + family : QStringLiteral("A:") + QString::number(fontAsset))
+                      + QLatin1Char(':') + QString::number(pixelSize);
+
+    auto it = faceIndex.find(key);
+    if (it == faceIndex.end())
+    {
+        Face f;
+        f.familyId = familyId;
+        f.family = family;
+        f.fontAsset = fontData.isEmpty() ? kNoAsset : fontAsset;
+        f.fontData = fontData;
+        f.pixelSize = pixelSize;
+        it = faceIndex.insert(key, int(faces.size()));
+        faces.push_back(f);
+    }
+
+    Face& face = faces[it.value()];
+
+    // Control characters (line breaks included) draw nothing and break the
+    // run, so they never form a kerning pair.
+    uint prev = 0;
+    for (uint cp : text.toUcs4())
+    {
+        if (cp < 0x20)
+        {
+            prev = 0;
+            continue;
+        }
+
+        face.codepoints.insert(cp);
+        if (prev)
+            face.pairs.insert((quint64(prev) << 32) | cp);
+        prev = cp;
+    }
+
+    if (editable)
+        for (uint cp = 0x20; cp < 0x7F; ++cp)
+            face.codepoints.insert(cp);
+}
+
+void GlyphAtlasBuilder::BuildFace(Face& face) const
+{
+    QRawFont raw;
+    if (!face.fontData.isEmpty())
+        raw.loadFromData(face.fontData, face.pixelSize, QFont::PreferDefaultHinting);
+
+    if (!raw.isValid())
+    {
+        QFont font(face.family);
+        font.setPixelSize(face.pixelSize);
+        raw = QRawFont::fromFont(font);
+        face.fontAsset = kNoAsset;
+    }
+
+    if (!raw.isValid())
+        return;
+
+    face.ascent = Fixed(raw.ascent());
+    face.descent = Fixed(raw.descent());
+    face.lineHeight = Fixed(raw.ascent() + raw.descent() + raw.leading());
+
+    // --- Glyph set, by codepoint ------------------------------------------
+    QVector<uint> codepoints(face.codepoints.cbegin(), face.codepoints.cend());
+    std::sort(codepoints.begin(), codepoints.end());
+
+    for (uint cp : codepoints)
+    {
+        const char32_t c = char32_t(cp);
+        const QList<quint32> idx = raw.glyphIndexesForString(QString::fromUcs4(&c, 1));
+        if (idx.size() != 1 || idx[0] == 0)
+            continue;               // not in the face; the runtime falls back
+
+        Glyph g;
+        g.codepoint = cp;
+        g.glyphIndex = idx[0];
+        face.glyphs.push_back(g);
+    }
+
+    if (face.glyphs.isEmpty())
+        return;
+
+    QList<quint32> indexes;
+    indexes.reserve(face.glyphs.size());
+    for (const Glyph& g : face.glyphs)
+        indexes.push_back(g.glyphIndex);
+
+    const QList<QPointF> advances = raw.advancesForGlyphIndexes(indexes);
+
+    // --- Rasterize --------------------------------------------------------
+    // From the outline, so the bitmap's origin is exact: the path's bounds
+    // relative to the pen, snapped outwards to whole pixels.
+    QVector<QImage> bitmaps(face.glyphs.size());
+    QVector<int> order;
+
+    // A glyph larger than a page gets a larger page rather than no bitmap:
+    // only whitespace may have none. Past the u16 placement limit the face
+    // keeps no glyphs at all, so the runtime rasterizes it from the font.
+    int facePage = pageSize;
+
+    for (int i = 0; i < face.glyphs.size(); ++i)
+    {
+        Glyph& g = face.glyphs[i];
+        g.advance = i < advances.size() ? Fixed(advances[i].x()) : 0;
+
+        const QPainterPath path = raw.pathForGlyph(g.glyphIndex);
+        const QRectF bounds = path.boundingRect();
+        if (path.isEmpty() || bounds.isEmpty())
+            continue;               // whitespace: advance only
+
+        const int left = qFloor(bounds.left());
+        const int top = qFloor(bounds.top());
+        const int w = qCeil(bounds.right()) - left;
+        const int h = qCeil(bounds.bottom()) - top;
+        if (w <= 0 || h <= 0)
+            continue;               // whitespace: advance only
+
+        if (w + padding > 0xFFFF || h + padding > 0xFFFF)
+        {
+            face.glyphs.clear();
+            return;
+        }
+        facePage = qMax(facePage, qMax(w, h) + padding);
+
+        QImage img(w, h, QImage::Format_ARGB32_Premultiplied);
+        img.fill(Qt::transparent);
+
+        QPainter p(&img);
+        p.setRenderHint(QPainter::Antialiasing);
+        p.translate(-left, -top);
+        p.fillPath(path, Qt::white);
+        p.end();
+
+        g.bearingX = left * 64;
+        g.bearingY = top * 64;
+        bitmaps[i] = img;
+        order.push_back(i);
+    }
+
+    // --- Pack, tallest first ----------------------------------------------
+    std::stable_sort(order.begin(), order.end(), [&bitmaps](int a, int b)
+    {
+        return bitmaps[a].height() > bitmaps[b].height();
+    });
+
+    QVector<AtlasPacker> packers;
+    for (int i : order)
+    {
+        Glyph& g = face.glyphs[i];
+        const int w = bitmaps[i].width() + padding;
+        const int h = bitmaps[i].height() + padding;
+
+        QPoint pos;
+        int page = -1;
+        for (int p = 0; p < packers.size() && page < 0; ++p)
+            if (packers[p].Insert(w, h, &pos))
+                page = p;
+
+        if (page < 0)
+        {
+            packers.push_back(AtlasPacker(facePage, facePage));
+            packers.back().Insert(w, h, &pos);
+            page = int(packers.size()) - 1;
+        }
+
+        g.page = quint32(page);
+        g.x = quint16(pos.x());
+        g.y = quint16(pos.y());
+        g.w = quint16(bitmaps[i].width());
+        g.h = quint16(bitmaps[i].height());
+    }
+
+    for (int p = 0; p < packers.size(); ++p)
+    {
+        QImage page(packers[p].UsedWidth(), packers[p].UsedHeight(), QImage::Format_ARGB32_Premultiplied);
+        page.fill(Qt::transparent);
+
+        for (int i : order)
+        {
+            const Glyph& g = face.glyphs[i];
+            if (g.page != quint32(p))
+                continue;
+
+            for (int y = 0; y < g.h; ++y)
+                std::memcpy(page.scanLine(g.y + y) + qsizetype(g.x) * 4, bitmaps[i].constScanLine(y), size_t(g.w) * 4);
+        }
+
+        QByteArray png;
+        QBuffer buf(&png);
+        buf.open(QIODevice::WriteOnly);
+        page.save(&buf, "PNG");
+        face.pages.push_back(png);
+    }
+
+    // --- Kerning ----------------------------------------------------------
+    // QRawFont applies the face's kern table through KernedAdvances; the
+    // pair adjustment is the first advance's difference.
+    QHash<uint, int> byCodepoint;
+    for (int i = 0; i < face.glyphs.size(); ++i)
+        byCodepoint.insert(face.glyphs[i].codepoint, i);
+
+    QVector<QPair<int, int>> pairs;
+    if (face.glyphs.size() <= kAllPairsMaxGlyphs)
+    {
+        for (int a = 0; a < face.glyphs.size(); ++a)
+            for (int b = 0; b < face.glyphs.size(); ++b)
+                pairs.push_back(qMakePair(a, b));
+    }
+    else
+    {
+        for (quint64 pair : face.pairs)
+        {
+            const int a = byCodepoint.value(uint(pair >> 32), -1);
+            const int b = byCodepoint.value(uint(pair), -1);
+            if (a >= 0 && b >= 0)
+                pairs.push_back(qMakePair(a, b));
+        }
+    }
+
+    for (const QPair<int, int>& pr : pairs)
+    {
+        const Glyph& a = face.glyphs[pr.first];
+        const Glyph& b = face.glyphs[pr.second];
+
+        const QList<QPointF> kerned = raw.advancesForGlyphIndexes(QList<quint32> { a.glyphIndex, b.glyphIndex }, QRawFont::KernedAdvances);
+        if (kerned.isEmpty())
+            continue;
+
+        const qint32 adjust = Fixed(kerned[0].x()) - a.advance;
+        if (adjust != 0)
+            face.kerning.push_back(Kern { a.codepoint, b.codepoint, adjust });
+    }
+
+    std::sort(face.kerning.begin(), face.kerning.end(), [](const Kern& x, const Kern& y)
+    {
+        return x.left != y.left ? x.left < y.left : x.right < y.right;
+    });
+}
+
+QVector<QByteArray> GlyphAtlasBuilder::Build()
+{
+    Face* all = faces.data();
+    ParallelFor(int(faces.size()), [this, all](int i) { BuildFace(all[i]); });
+
+    QVector<QByteArray> pages;
+    for (Face& f : faces)
+    {
+        f.firstPage = int(pages.size());
+        pages += f.pages;
+    }
+    return pages;
+}
+
+QByteArray GlyphAtlasBuilder::Section(quint32 firstPageAsset) const
+{
+    quint32 glyphTotal = 0;
+    quint32 kernTotal = 0;
+    for (const Face& f : faces)
+    {
+        glyphTotal += quint32(f.glyphs.size());
+        kernTotal += quint32(f.kerning.size());
+    }
+
+    Writer w;
+    w.U32(quint32(faces.size()));
+    w.U32(glyphTotal);
+    w.U32(kernTotal);
+    w.U32(0);
+
+    quint32 firstGlyph = 0;
+    quint32 firstKern = 0;
+    for (const Face& f : faces)
+    {
+        w.U32(f.familyId);
+        w.U32(f.fontAsset);
+        w.U32(quint32(f.pixelSize));
+        w.I32(f.ascent);
+        w.I32(f.descent);
+        w.I32(f.lineHeight);
+        w.U32(firstGlyph);
+        w.U32(quint32(f.glyphs.size()));
+        w.U32(firstKern);
+        w.U32(quint32(f.kerning.size()));
+        firstGlyph += quint32(f.glyphs.size());
+        firstKern += quint32(f.kerning.size());
+    }
+
+    for (const Face& f : faces)
+    {
+        for (const Glyph& g : f.glyphs)
+        {
+            // Whitespace has no bitmap; its page is kNoAsset.
+            const bool drawn = g.w > 0;
+            w.U32(g.codepoint);
+            w.U32(drawn ? firstPageAsset + quint32(f.firstPage) + g.page : kNoAsset);
+            w.U16(g.x);
+            w.U16(g.y);
+            w.U16(g.w);
+            w.U16(g.h);
+            w.I32(g.bearingX);
+            w.I32(g.bearingY);
+            w.I32(g.advance);
+        }
+    }
+
+    for (const Face& f : faces)
+    {
+        for (const Kern& k : f.kerning)
+        {
+            w.U32(k.left);
+            w.U32(k.right);
+            w.I32(k.adjust);
+        }
+    }
+
+    return w.buffer();
+}
+
+// ---------------------------------------------------------------------------
+// GlyphAtlasView
+// ---------------------------------------------------------------------------
+
+bool GlyphAtlasView::Open(QByteArrayView section)
+{
+    data = nullptr;
+    faceCount = glyphCount = kernCount = 0;
+
+    if (section.size() < qsizetype(kGlyphHeaderSize))
+        return false;
+
+    const char* d = section.data();
+    const quint32 faces = LoadU32(d);
+    const quint32 glyphs = LoadU32(d + 4);
+    const quint32 kerns = LoadU32(d + 8);
+
+    const quint64 glyphsOff = kGlyphHeaderSize + quint64(faces) * kGlyphFaceSize;
+    const quint64 kernsOff = glyphsOff + quint64(glyphs) * kGlyphEntrySize;
+    if (kernsOff + quint64(kerns) * kKernEntrySize > quint64(section.size()))
+        return false;
+
+    // Every face's glyph and kerning ranges must lie inside the tables.
+    for (quint32 i = 0; i < faces; ++i)
+    {
+        const char* f = d + kGlyphHeaderSize + i * kGlyphFaceSize;
+        if (quint64(LoadU32(f + 24)) + LoadU32(f + 28) > glyphs
+            || quint64(LoadU32(f + 32)) + LoadU32(f + 36) > kerns)
+            return false;
+    }
+
+    data = d;
+    faceCount = faces;
+    glyphCount = glyphs;
+    kernCount = kerns;
+    glyphsAt = quint32(glyphsOff);
+    kernsAt = quint32(kernsOff);
+    return true;
+}
+
+GlyphAtlasView::Face GlyphAtlasView::FaceAt(quint32 index) const
+{
+    Face f;
+    if (index >= faceCount)
+        return f;
+
+    const char* e = data + kGlyphHeaderSize + index * kGlyphFaceSize;
+    f.familyId   = LoadU32(e);
+    f.fontAsset  = LoadU32(e + 4);
+    f.pixelSize  = LoadU32(e + 8);
+    f.ascent     = LoadI32(e + 12);
+    f.descent    = LoadI32(e + 16);
+    f.lineHeight = LoadI32(e + 20);
+    return f;
+}
+
+int GlyphAtlasView::FindFace(quint32 familyId, quint32 fontAsset, quint32 pixelSize) const
+{
+    int byFamily = -1;
+    for (quint32 i = 0; i < faceCount; ++i)
+    {
+        const Face f = FaceAt(i);
+        if (f.pixelSize != pixelSize)
+            continue;
+
+        if (fontAsset != kNoAsset && f.fontAsset == fontAsset)
+            return int(i);
+        if (byFamily < 0 && f.fontAsset == kNoAsset && f.familyId == familyId)
+            byFamily = int(i);
+    }
+    return byFamily;
+}
+
+bool GlyphAtlasView::FindGlyph(quint32 face, uint codepoint, Glyph* out) const
+{
+    if (face >= faceCount)
+        return false;
+
+    const char* f = data + kGlyphHeaderSize + face * kGlyphFaceSize;
+    quint32 lo = LoadU32(f + 24);
+    quint32 hi = lo + LoadU32(f + 28);
+
+    while (lo < hi)
+    {
+        const quint32 mid = lo + (hi - lo) / 2;
+        const char* e = data + glyphsAt + mid * kGlyphEntrySize;
+        const quint32 cp = LoadU32(e);
+
+        if (cp < codepoint)
+        {
+            lo = mid + 1;
+        }
+        else if (cp > codepoint)
+        {
+            hi = mid;
+        }
+        else
+        {
+            if (out)
+            {
+                out->page     = LoadU32(e + 4);
+                out->x        = qFromLittleEndian<quint16>(e + 8);
+                out->y        = qFromLittleEndian<quint16>(e + 10);
+                out->w        = qFromLittleEndian<quint16>(e + 12);
+                out->h        = qFromLittleEndian<quint16>(e + 14);
+                out->bearingX = LoadI32(e + 16);
+                out->bearingY = LoadI32(e + 20);
+                out->advance  = LoadI32(e + 24);
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+qint32 GlyphAtlasView::Kerning(quint32 face, uint left, uint right) const
+{
+    if (face >= faceCount)
+        return 0;
+
+    const char* f = data + kGlyphHeaderSize + face * kGlyphFaceSize;
+    quint32 lo = LoadU32(f + 32);
+    quint32 hi = lo + LoadU32(f + 36);
+    const quint64 key = (quint64(left) << 32) | right;
+
+    while (lo < hi)
+    {
+        const quint32 mid = lo + (hi - lo) / 2;
+        const char* e = data + kernsAt + mid * kKernEntrySize;
+        const quint64 k = (quint64(LoadU32(e)) << 32) | LoadU32(e + 4);
+
+        if (k < key)
+            lo = mid + 1;
+        else if (k > key)
+            hi = mid;
+        else
+            return LoadI32(e + 8);
+    }
+
+    return 0;
+}
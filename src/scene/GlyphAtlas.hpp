@@ -0,0 +1,140 @@
+#ifndef SCENE_GLYPHATLAS_HPP
+#define SCENE_GLYPHATLAS_HPP
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+// Bake side of the GLYF extension section (spec section 11.2). Collects the
+// text each (face, pixel size) pair draws, rasterizes exactly those glyphs
+// into per-face coverage pages and serializes metrics, glyph placements and
+// kerning, so a runtime can draw text without a font library.
+//
+// Metrics are 26.6 fixed point (1/64 px) and y grows downwards: a glyph's
+// bitmap top-left sits at pen + (bearingX, bearingY) on the baseline.
+class GlyphAtlasBuilder
+{
+public:
+
+    GlyphAtlasBuilder(int pageSize, int padding);
+
+    // Records text drawn with one face at one size. When fontData is not
+    // empty it is the embedded font file behind fontAsset; otherwise the
+    // face is family resolved through the font database, as the editor
+    // does. Editable text (TextInput) also gets printable ASCII, since its
+    // content changes at runtime.
+    void Add(quint32 familyId, const QString& family, quint32 fontAsset, const QByteArray& fontData,
+             int pixelSize, const QString& text, bool editable);
+
+    bool IsEmpty() const { return faces.isEmpty(); }
+
+    // Rasterizes every face (in parallel) and returns the coverage pages as
+    // PNG - white, alpha = coverage - in page order.
+    QVector<QByteArray> Build();
+
+    // The section body, given the asset index of the first page. Call after
+    // Build.
+    QByteArray Section(quint32 firstPageAsset) const;
+
+private:
+
+    struct Glyph
+    {
+        quint32 codepoint = 0;
+        quint32 glyphIndex = 0;
+        quint32 page = 0;           // local page number until Section
+        quint16 x = 0, y = 0, w = 0, h = 0;
+        qint32 bearingX = 0;        // 26.6
+        qint32 bearingY = 0;        // 26.6
+        qint32 advance = 0;         // 26.6
+    };
+
+    struct Kern
+    {
+        quint32 left;
+        quint32 right;
+        qint32 adjust;              // 26.6
+    };
+
+    struct Face
+    {
+        quint32 familyId = 0;
+        QString family;
+        quint32 fontAsset = 0;
+        QByteArray fontData;
+        int pixelSize = 0;
+
+        QSet<uint> codepoints;
+        QSet<quint64> pairs;        // (left << 32) | right, seen adjacent
+
+        qint32 ascent = 0;
+        qint32 descent = 0;
+        qint32 lineHeight = 0;
+        QVector<Glyph> glyphs;
+        QVector<Kern> kerning;
+        QVector<QByteArray> pages;
+        int firstPage = 0;          // of this face's pages in Build's output
+    };
+
+    void BuildFace(Face& face) const;
+
+    int pageSize;
+    int padding;
+    QHash<QString, int> faceIndex;
+    QVector<Face> faces;
+};
+
+// Read side: bounds-checked lookups over a GLYF section body (see
+// UiBinView::Extension / UiBinAssetResolver::Extension). Holds only the
+// view; the bytes must outlive it.
+class GlyphAtlasView
+{
+public:
+
+    struct Face
+    {
+        quint32 familyId = 0;       // string id
+        quint32 fontAsset = 0;      // asset index, or uibin::kNoAsset
+        quint32 pixelSize = 0;
+        qint32 ascent = 0;          // 26.6
+        qint32 descent = 0;
+        qint32 lineHeight = 0;
+    };
+
+    struct Glyph
+    {
+        quint32 page = 0;           // asset index of the coverage page
+        quint16 x = 0, y = 0, w = 0, h = 0;
+        qint32 bearingX = 0;        // 26.6
+        qint32 bearingY = 0;
+        qint32 advance = 0;
+    };
+
+    // Returns false if the body is not a well-formed GLYF section.
+    bool Open(QByteArrayView section);
+
+    quint32 FaceCount() const { return faceCount; }
+    Face FaceAt(quint32 index) const;
+
+    // Index of the face baked for a component's (fontFamily, fontPath,
+    // pixelSize) fields, or -1. A face baked from the font asset wins over
+    // one resolved by family.
+    int FindFace(quint32 familyId, quint32 fontAsset, quint32 pixelSize) const;
+
+    // Binary searches the face's glyphs / kerning pairs by codepoint.
+    bool FindGlyph(quint32 face, uint codepoint, Glyph* out) const;
+    qint32 Kerning(quint32 face, uint left, uint right) const;
+
+private:
+    const char* data = nullptr;
+    quint32 faceCount = 0;
+    quint32 glyphCount = 0;
+    quint32 kernCount = 0;
+    quint32 glyphsAt = 0;
+    quint32 kernsAt = 0;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include "scene/LiveLinkFrame.hpp"
+#include "scene/UiBinCommon.hpp"
+
+#include <cstring>
+
+using namespace uibin;
+
+QByteArray LiveLinkFrame::Encode() const
+{
+    Writer w;
+    w.buffer().reserve(int(kLiveLinkHeaderSize) + payload.size());
+
+    w.Raw(kLiveLinkMagic, 4);
+    w.U8(kind);
+    w.U8(0);
+    w.U16(0);
+    w.U32(sequence);
+    w.U64(bakeHash);
+    w.I64(editMs);
+    w.I64(sentMs);
+    w.U32(quint32(payload.size()));
+    w.Raw(payload.constData(), int(payload.size()));
+
+    return w.buffer();
+}
+
+int LiveLinkFrame::Take(QByteArray& buffer, LiveLinkFrame* out, QString* error)
+{
+    if (buffer.size() < qsizetype(kLiveLinkHeaderSize))
+        return 0;
+
+    if (std::memcmp(buffer.constData(), kLiveLinkMagic, 4) != 0)
+    {
+        if (error) *error = QStringLiteral("not a live-link stream");
+        return -1;
+    }
+
+    Reader r(buffer.constData(), int(kLiveLinkHeaderSize));
+    r.Skip(4);
+
+    LiveLinkFrame f;
+    f.kind = r.U8();
+    r.Skip(3);
+    f.sequence = r.U32();
+    f.bakeHash = r.U64();
+    f.editMs = r.I64();
+    f.sentMs = r.I64();
+    const quint32 length = r.U32();
+
+    if (f.kind < LINK_FULL || f.kind > LINK_ACK || length > kLiveLinkMaxPayload)
+    {
+        if (error) *error = QStringLiteral("malformed live-link frame");
+        return -1;
+    }
+
+    if (quint64(buffer.size()) < quint64(kLiveLinkHeaderSize) + length)
+        return 0;
+
+    f.payload = buffer.mid(kLiveLinkHeaderSize, length);
+    buffer.remove(0, qsizetype(kLiveLinkHeaderSize) + length);
+
+    if (out)
+        *out = f;
+    return 1;
+}
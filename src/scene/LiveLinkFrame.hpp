@@ -0,0 +1,36 @@
+#ifndef SCENE_LIVELINKFRAME_HPP
+#define SCENE_LIVELINKFRAME_HPP
+
+#include <QByteArray>
+#include <QString>
+
+// One message on the live-link channel between the editor and a running
+// instance (uibin_patch_spec.txt section 6). Pure framing over bytes, so
+// both ends share it without depending on the socket type.
+struct LiveLinkFrame
+{
+    quint8 kind = 0;          // uibin::LiveLinkKind
+    quint32 sequence = 0;     // the editor's push counter; an ACK echoes it
+
+    // FULL/PATCH: uibin::Hash64 of the bake the receiver holds once this
+    // frame is applied. ACK: hash of the bake the runtime actually holds
+    // (0 for none), so the editor can fall back to a full push.
+    quint64 bakeHash = 0;
+
+    // Wall clocks in ms since the epoch: the first edit the bake covers and
+    // the moment the frame left the editor. An ACK echoes both, so either
+    // end can report edit-to-screen and round-trip latency.
+    qint64 editMs = 0;
+    qint64 sentMs = 0;
+
+    QByteArray payload;
+
+    QByteArray Encode() const;
+
+    // Removes one complete frame from the front of buffer (bytes read so far
+    // from the socket). Returns 1 with *out filled, 0 if the frame is not
+    // complete yet, or -1 (with an error) if the stream is not a live link.
+    static int Take(QByteArray& buffer, LiveLinkFrame* out, QString* error = nullptr);
+};
+
+#endif
@@ -0,0 +1,223 @@
+#include "scene/ResolvedLayout.hpp"
+#include "scene/SceneDocument.hpp"
+#include "scene/SceneElementItem.hpp"
+#include "scene/UiBinCommon.hpp"
+#include "core/UiElement.hpp"
+#include "core/Component.hpp"
+
+#include <QJsonObject>
+#include <QTransform>
+#include <QtEndian>
+
+#include <cstring>
+
+using namespace uibin;
+
+namespace
+{
+    bool HasLayout(const UiElement* e)
+    {
+        for (auto* comp : e->GetComponents())
+            if (comp->IsLayout())
+                return true;
+        return false;
+    }
+
+    // Mirrors SceneDocument::CreateItemFor: parent first, then the item's own
+    // refresh, then the parent's layout so the new child is placed. items is
+    // indexed by pre-order element; the root has no item, as in the editor.
+    void CreateItems(UiElement* e, SceneElementItem* parentItem, const QRectF& canvas, QVector<SceneElementItem*>& items)
+    {
+        for (QObject* o : e->children())
+        {
+            auto* ce = qobject_cast<UiElement*>(o);
+            if (!ce)
+                continue;
+
+            auto* item = new SceneElementItem(ce);
+            item->SetScreenRect(canvas);
+            if (parentItem)
+                item->setParentItem(parentItem);
+
+            items.push_back(item);
+            item->RefreshFromComponents();
+
+            if (parentItem && HasLayout(e))
+                parentItem->RefreshFromComponents();
+
+            CreateItems(ce, item, canvas, items);
+        }
+    }
+
+    float LoadF32(const char* p)
+    {
+        const quint32 q = qFromLittleEndian<quint32>(p);
+        float v;
+        std::memcpy(&v, &q, 4);
+        return v;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// ResolvedLayoutBuilder
+// ---------------------------------------------------------------------------
+
+void ResolvedLayoutBuilder::AddTarget(const UiElement* root, int width, int height)
+{
+    if (!root || width <= 0 || height <= 0)
+        return;
+
+    // Items write back into the elements they show (a Transform added to
+    // any element without one, connections to every component), so they
+    // are built over a headless copy, never the document being baked.
+    QJsonObject snapshot;
+    root->ToJson(snapshot);
+
+    SceneDocument mirror(nullptr, SceneDocument::Mode::Headless);
+    if (!mirror.LoadJson(snapshot))
+        return;
+
+    const QRectF canvas(0.0, 0.0, width, height);
+
+    QVector<SceneElementItem*> items;
+    items.push_back(nullptr);
+    CreateItems(mirror.GetRoot(), nullptr, canvas, items);
+
+    // As SceneDocument::OnStructureChanged after a load: one more pass over
+    // the layout elements now that every child exists.
+    for (SceneElementItem* item : items)
+        if (item && HasLayout(item->GetElement()))
+            item->RefreshFromComponents();
+
+    Target target;
+    target.size = QSize(width, height);
+    target.nodes.resize(items.size());
+
+    Node& rootNode = target.nodes[0];
+    rootNode.w = float(width);
+    rootNode.h = float(height);
+
+    for (int i = 1; i < items.size(); ++i)
+    {
+        const QRectF r = items[i]->boundingRect();
+        const QTransform t = items[i]->sceneTransform();
+
+        Node& n = target.nodes[i];
+        n.x = float(r.x());
+        n.y = float(r.y());
+        n.w = float(r.width());
+        n.h = float(r.height());
+        n.a = float(t.m11());
+        n.b = float(t.m12());
+        n.c = float(t.m21());
+        n.d = float(t.m22());
+        n.tx = float(t.dx());
+        n.ty = float(t.dy());
+    }
+
+    // Deleting the top-level items takes their children with them.
+    for (int i = 1; i < items.size(); ++i)
+        if (!items[i]->parentItem())
+            delete items[i];
+
+    targets.push_back(target);
+}
+
+QByteArray ResolvedLayoutBuilder::Section() const
+{
+    Writer w;
+    const quint32 elements = targets.isEmpty() ? 0 : quint32(targets.first().nodes.size());
+    w.U32(elements);
+    w.U32(quint32(targets.size()));
+
+    for (const Target& t : targets)
+    {
+        w.U32(quint32(t.size.width()));
+        w.U32(quint32(t.size.height()));
+    }
+
+    for (const Target& t : targets)
+    {
+        for (const Node& n : t.nodes)
+        {
+            w.F32(n.x);
+            w.F32(n.y);
+            w.F32(n.w);
+            w.F32(n.h);
+            w.F32(n.a);
+            w.F32(n.b);
+            w.F32(n.c);
+            w.F32(n.d);
+            w.F32(n.tx);
+            w.F32(n.ty);
+        }
+    }
+
+    return w.buffer();
+}
+
+// ---------------------------------------------------------------------------
+// ResolvedLayoutView
+// ---------------------------------------------------------------------------
+
+bool ResolvedLayoutView::Open(QByteArrayView section)
+{
+    data = nullptr;
+    elementCount = targetCount = 0;
+
+    if (section.size() < qsizetype(kLayoutHeaderSize))
+        return false;
+
+    const char* d = section.data();
+    const quint32 elements = qFromLittleEndian<quint32>(d);
+    const quint32 targets = qFromLittleEndian<quint32>(d + 4);
+
+    const quint64 size = kLayoutHeaderSize + quint64(targets) * kLayoutTargetSize
+                       + quint64(targets) * elements * kLayoutNodeSize;
+    if (size != quint64(section.size()))
+        return false;
+
+    data = d;
+    elementCount = elements;
+    targetCount = targets;
+    return true;
+}
+
+QSize ResolvedLayoutView::TargetSize(quint32 target) const
+{
+    if (target >= targetCount)
+        return QSize();
+
+    const char* t = data + kLayoutHeaderSize + target * kLayoutTargetSize;
+    return QSize(int(qFromLittleEndian<quint32>(t)), int(qFromLittleEndian<quint32>(t + 4)));
+}
+
+int ResolvedLayoutView::FindTarget(int width, int height) const
+{
+    for (quint32 i = 0; i < targetCount; ++i)
+        if (TargetSize(i) == QSize(width, height))
+            return int(i);
+    return -1;
+}
+
+ResolvedLayoutView::Node ResolvedLayoutView::NodeAt(quint32 target, quint32 element) const
+{
+    Node n;
+    if (target >= targetCount || element >= elementCount)
+        return n;
+
+    const quint64 at = kLayoutHeaderSize + quint64(targetCount) * kLayoutTargetSize
+                     + (quint64(target) * elementCount + element) * kLayoutNodeSize;
+    const char* p = data + at;
+    n.x  = LoadF32(p);
+    n.y  = LoadF32(p + 4);
+    n.w  = LoadF32(p + 8);
+    n.h  = LoadF32(p + 12);
+    n.a  = LoadF32(p + 16);
+    n.b  = LoadF32(p + 20);
+    n.c  = LoadF32(p + 24);
+    n.d  = LoadF32(p + 28);
+    n.tx = LoadF32(p + 32);
+    n.ty = LoadF32(p + 36);
+    return n;
+}
@@ -0,0 +1,82 @@
+#ifndef SCENE_RESOLVEDLAYOUT_HPP
+#define SCENE_RESOLVEDLAYOUT_HPP
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QSize>
+#include <QVector>
+
+class UiElement;
+
+// Bake side of the LAYT extension section (spec section 11.4): the layout
+// the editor would produce, resolved once per declared target resolution,
+// so a runtime shipping at one of those sizes can skip anchoring, stretch
+// and layout components and place elements straight from the table.
+//
+// Each target is resolved by building throwaway SceneElementItems for a
+// headless copy of the tree, exactly as SceneDocument::CreateItemFor does,
+// against a canvas of the target size - no QGraphicsScene is needed, and
+// the tree passed in is left untouched.
+class ResolvedLayoutBuilder
+{
+public:
+
+    // Resolves the tree under root against a width x height canvas. Every
+    // call must pass the same tree.
+    void AddTarget(const UiElement* root, int width, int height);
+
+    bool IsEmpty() const { return targets.isEmpty(); }
+
+    QByteArray Section() const;
+
+private:
+
+    // One element at one target: its local rect (item coordinates) and the
+    // world transform, x' = a*x + c*y + tx, y' = b*x + d*y + ty.
+    struct Node
+    {
+        float x = 0.0f, y = 0.0f, w = 0.0f, h = 0.0f;
+        float a = 1.0f, b = 0.0f, c = 0.0f, d = 1.0f, tx = 0.0f, ty = 0.0f;
+    };
+
+    struct Target
+    {
+        QSize size;
+        QVector<Node> nodes;        // by pre-order element index
+    };
+
+    QVector<Target> targets;
+};
+
+// Read side: lookups over a LAYT section body. Holds only the view; the
+// bytes must outlive it.
+class ResolvedLayoutView
+{
+public:
+
+    struct Node
+    {
+        float x = 0.0f, y = 0.0f, w = 0.0f, h = 0.0f;
+        float a = 1.0f, b = 0.0f, c = 0.0f, d = 1.0f, tx = 0.0f, ty = 0.0f;
+    };
+
+    // Returns false if the body is not a well-formed LAYT section.
+    bool Open(QByteArrayView section);
+
+    quint32 ElementCount() const { return elementCount; }
+    quint32 TargetCount() const { return targetCount; }
+    QSize TargetSize(quint32 target) const;
+
+    // Index of the target resolved at exactly width x height, or -1.
+    int FindTarget(int width, int height) const;
+
+    // Pre-order element `element` at target `target`.
+    Node NodeAt(quint32 target, quint32 element) const;
+
+private:
+    const char* data = nullptr;
+    quint32 elementCount = 0;
+    quint32 targetCount = 0;
+};
+
+#endif
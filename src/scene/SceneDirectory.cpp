@@ -0,0 +1,89 @@
+#include "scene/SceneDirectory.hpp"
+#include "scene/UiBinCommon.hpp"
+
+#include <QtEndian>
+
+using namespace uibin;
+
+namespace
+{
+    quint32 LoadU32(const char* p) { return qFromLittleEndian<quint32>(p); }
+
+    const char* EntryAt(const char* data, quint32 i)
+    {
+        return data + kSceneDirectoryHeaderSize + quint64(i) * kSceneEntrySize;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// SceneDirectoryBuilder
+// ---------------------------------------------------------------------------
+
+void SceneDirectoryBuilder::Add(quint32 nameId, quint32 offset, quint32 size, quint32 elements)
+{
+    entries.push_back(Entry { nameId, offset, size, elements });
+}
+
+QByteArray SceneDirectoryBuilder::Section() const
+{
+    Writer w;
+    w.U32(quint32(entries.size()));
+    w.U32(0);
+
+    for (const Entry& e : entries)
+    {
+        w.U32(e.nameId);
+        w.U32(e.offset);
+        w.U32(e.size);
+        w.U32(e.elements);
+    }
+
+    return w.buffer();
+}
+
+// ---------------------------------------------------------------------------
+// SceneDirectoryView
+// ---------------------------------------------------------------------------
+
+bool SceneDirectoryView::Open(QByteArrayView section)
+{
+    data = nullptr;
+    count = 0;
+
+    if (section.size() < qsizetype(kSceneDirectoryHeaderSize))
+        return false;
+
+    const char* d = section.data();
+    const quint32 n = LoadU32(d);
+    if (kSceneDirectoryHeaderSize + quint64(n) * kSceneEntrySize != quint64(section.size()))
+        return false;
+
+    // The trees tile the start of the tree section, so the first scene is
+    // also what a single-tree reader decodes.
+    quint64 next = 0;
+    for (quint32 i = 0; i < n; ++i)
+    {
+        const char* e = EntryAt(d, i);
+        if (LoadU32(e + 4) != next || LoadU32(e + 8) == 0)
+            return false;
+        next += LoadU32(e + 8);
+    }
+
+    data = d;
+    count = n;
+    return true;
+}
+
+SceneDirectoryView::Entry SceneDirectoryView::At(quint32 i) const
+{
+    Entry e;
+    if (i >= count)
+        return e;
+
+    const char* p = EntryAt(data, i);
+    e.nameId   = LoadU32(p);
+    e.offset   = LoadU32(p + 4);
+    e.size     = LoadU32(p + 8);
+    e.elements = LoadU32(p + 12);
+    return e;
+}
@@ -0,0 +1,69 @@
+#ifndef SCENE_SCENEDIRECTORY_HPP
+#define SCENE_SCENEDIRECTORY_HPP
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QVector>
+
+// Bake side of the SCNS extension section (spec section 11.7): the scene
+// directory of a bundle. A bundle holds several scene trees back to back in
+// its tree section, over one string table and one asset table; each entry
+// names a scene and says where its tree starts and how long it is, so a
+// runtime decodes only the screen it is about to show.
+//
+// Offsets are relative to the header's treeOffset, like EIDX, so the
+// section can be built before the container is assembled.
+class SceneDirectoryBuilder
+{
+public:
+
+    // Adds the next scene in bundle order. nameId is a string id.
+    void Add(quint32 nameId, quint32 offset, quint32 size, quint32 elements);
+
+    bool IsEmpty() const { return entries.isEmpty(); }
+
+    QByteArray Section() const;
+
+private:
+
+    struct Entry
+    {
+        quint32 nameId;
+        quint32 offset;
+        quint32 size;
+        quint32 elements;
+    };
+
+    QVector<Entry> entries;         // bundle order
+};
+
+// Read side: the entries of a SCNS section body. Holds only the view; the
+// bytes must outlive it.
+class SceneDirectoryView
+{
+public:
+
+    struct Entry
+    {
+        quint32 nameId = 0;         // string id of the scene name
+        quint32 offset = 0;         // root record, relative to treeOffset
+        quint32 size = 0;           // the whole scene tree, in bytes
+        quint32 elements = 0;       // elements in the tree, root included
+    };
+
+    // Returns false if the body is not a well-formed SCNS section: a size
+    // that does not match the count, or trees that are not back to back
+    // from offset 0.
+    bool Open(QByteArrayView section);
+
+    quint32 Count() const { return count; }
+
+    // Entry i in bundle order.
+    Entry At(quint32 i) const;
+
+private:
+    const char* data = nullptr;
+    quint32 count = 0;
+};
+
+#endif
@@ -47,23 +47,26 @@
 #include "components/ListRepeaterComponent.hpp"
 #include "components/SlotComponent.hpp"
 
-SceneDocument::SceneDocument(QObject* parent) : QObject(parent), root(new UiElement("Root")), scene(new QGraphicsScene(this)), rootRect(nullptr), m_canvasRect(0.0, 0.0, 1920.0, 1080.0)
+SceneDocument::SceneDocument(QObject* parent, Mode mode) : QObject(parent), root(new UiElement("Root")), scene(nullptr), rootRect(nullptr), m_canvasRect(0.0, 0.0, 1920.0, 1080.0)
 {
-    // The scene rect is a large pasteboard surrounding the design canvas, so
-    // drag-panning always has somewhere to go - even zoomed far out, where a
-    // scene rect equal to the canvas would collapse the scroll range to zero.
-    const qreal mx = m_canvasRect.width() * 10.0;
-    const qreal my = m_canvasRect.height() * 10.0;
-    scene->setSceneRect(m_canvasRect.adjusted(-mx, -my, mx, my));
+    if (mode == Mode::Editor)
+    {
+        scene = new QGraphicsScene(this);
 
-    QObject::connect(scene, &QGraphicsScene::selectionChanged, this, &SceneDocument::OnSceneSelectionChanged);
+        // The scene rect is a large pasteboard surrounding the design canvas, so
+        // drag-panning always has somewhere to go - even zoomed far out, where a
+        // scene rect equal to the canvas would collapse the scroll range to zero.
+        const qreal mx = m_canvasRect.width() * 10.0;
+        const qreal my = m_canvasRect.height() * 10.0;
+        scene->setSceneRect(m_canvasRect.adjusted(-mx, -my, mx, my));
 
-    // Solid canvas background. The dot grid is painted by ViewportWidget in
-    // drawBackground() as constant-size vector dots so it stays crisp at every
-    // zoom level; a tiled pixmap brush scales with the view transform and blurs.
-    scene->setBackgroundBrush(QColor(35, 35, 38));
+        QObject::connect(scene, &QGraphicsScene::selectionChanged, this, &SceneDocument::OnSceneSelectionChanged);
+
+        // Solid canvas background. The dot grid is painted by ViewportWidget in
+        // drawBackground() as constant-size vector dots so it stays crisp at every
+        // zoom level; a tiled pixmap brush scales with the view transform and blurs.
+        scene->setBackgroundBrush(QColor(35, 35, 38));
 
-    {
         QPen borderPen(QColor(220, 220, 220));
         borderPen.setCosmetic(true);
         borderPen.setWidth(1);
@@ -75,6 +78,11 @@ SceneDocument::SceneDocument(QObject* parent) : QObject(parent), root(new UiElem
     WireRootConnections();
 }
 
+bool SceneDocument::IsHeadless() const noexcept
+{
+    return scene == nullptr;
+}
+
 QRectF SceneDocument::GetCanvasRect() const noexcept
 {
     return m_canvasRect;
@@ -98,6 +106,17 @@ void SceneDocument::WireRootConnections()
 
 SceneElementItem* SceneDocument::CreateItemFor(UiElement* e)
 {
+    // Headless: no item, but keep the invariant the item would otherwise
+    // enforce in RefreshFromComponents (every element has a Transform), so a
+    // headless bake encodes the same components as an editor bake.
+    if (!scene)
+    {
+        if (!e->GetComponent<TransformComponent>())
+            e->AddComponent<TransformComponent>();
+
+        return nullptr;
+    }
+
     auto* item = new SceneElementItem(e);
     item->SetScreenRect(m_canvasRect);
 
@@ -430,6 +449,10 @@ UiElement* SceneDocument::CreateListRepeaterElement(const QString& name, UiEleme
 
 void SceneDocument::OnStructureChanged()
 {
+    // Nothing to re-parent, re-stack or re-layout without a scene.
+    if (!scene)
+        return;
+
     for (auto it = items.begin(); it != items.end(); ++it)
     {
         UiElement* element = it.key();
@@ -483,20 +506,28 @@ bool SceneDocument::LoadJson(const QByteArray& data)
     if (err.error != QJsonParseError::NoError || !doc.isObject())
         return false;
 
-    scene->clear();
+    return LoadJson(doc.object());
+}
+
+bool SceneDocument::LoadJson(const QJsonObject& rootObj)
+{
     items.clear();
 
-    QPen borderPen(QColor(220, 220, 220));
+    if (scene)
+    {
+        scene->clear();
 
-    borderPen.setCosmetic(true);
-    borderPen.setWidth(1);
-    rootRect = scene->addRect(m_canvasRect, borderPen, Qt::NoBrush);
-    rootRect->setZValue(-1);
+        QPen borderPen(QColor(220, 220, 220));
+
+        borderPen.setCosmetic(true);
+        borderPen.setWidth(1);
+        rootRect = scene->addRect(m_canvasRect, borderPen, Qt::NoBrush);
+        rootRect->setZValue(-1);
+    }
 
     delete root;
     root = new UiElement("Root");
 
-    QJsonObject rootObj = doc.object();
     root->SetName(rootObj["name"].toString("Root"));
     root->SetId(QUuid::fromString(rootObj["id"].toString()));
 
@@ -568,7 +599,7 @@ void SceneDocument::SetSelected(UiElement* e)
 
 void SceneDocument::SetSelectedElements(const QList<UiElement*>& elements)
 {
-    if (m_syncingSelection)
+    if (m_syncingSelection || !scene)
         return;
 
     m_syncingSelection = true;
@@ -597,6 +628,9 @@ QList<UiElement*> SceneDocument::GetSelectedElements() const
 {
     QList<UiElement*> result;
 
+    if (!scene)
+        return result;
+
     for (auto* qitem : scene->selectedItems())
     {
         if (auto* sei = dynamic_cast<SceneElementItem*>(qitem))
@@ -21,9 +21,21 @@ class SceneDocument : public QObject
 
 public:
 
-    explicit SceneDocument(QObject* parent = nullptr);
+    // Headless documents own only the UiElement tree: no QGraphicsScene and no
+    // SceneElementItems are created, so they can be loaded and baked without a
+    // QApplication (see the UIMaker2Bake target). GetScene() returns nullptr
+    // and selection is always empty.
+    enum class Mode
+    {
+        Editor,
+        Headless
+    };
+
+    explicit SceneDocument(QObject* parent = nullptr, Mode mode = Mode::Editor);
     ~SceneDocument() override;
 
+    bool IsHeadless() const noexcept;
+
     UiElement* GetRoot() const noexcept;
 
     QGraphicsScene* GetScene() const noexcept;
@@ -71,6 +83,10 @@ public:
     QByteArray ExportJson() const;
     bool LoadJson(const QByteArray& data);
 
+    // Same, from an already parsed root element object (UiElement::ToJson),
+    // e.g. a snapshot of an editor document taken for a background bake.
+    bool LoadJson(const QJsonObject& rootObj);
+
     QList<UiElement*> GetSelectedElements() const;
     UiElement* GetPrimarySelection() const;
 
@@ -1,10 +1,12 @@
 #include "scene/SceneExporter.hpp"
+#include "scene/BakeProgress.hpp"
 #include "scene/SceneDocument.hpp"
 #include "scene/UiBinWriter.hpp"
 #include "scene/UiBinReader.hpp"
 
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QFileInfo>
 #include <QJsonDocument>
@@ -18,22 +20,23 @@
 void SceneExporter::CollectAssetPaths(const QJsonObject& elementObj, QSet<QString>& out)
 {
     for (const QJsonValue& compVal : elementObj["components"].toArray())
-    {
-        QJsonObject comp = compVal.toObject();
+        CollectComponentAssetPaths(compVal.toObject(), out);
 
-        for (auto it = comp.begin(); it != comp.end(); ++it)
+    for (const QJsonValue& childVal : elementObj["children"].toArray())
+        CollectAssetPaths(childVal.toObject(), out);
+}
+
+void SceneExporter::CollectComponentAssetPaths(const QJsonObject& componentObj, QSet<QString>& out)
+{
+    for (auto it = componentObj.begin(); it != componentObj.end(); ++it)
+    {
+        if (it.key().endsWith("Path") && it.value().isString())
         {
-            if (it.key().endsWith("Path") && it.value().isString())
-            {
-                QString path = it.value().toString();
-                if (!path.isEmpty())
-                    out.insert(path);
-            }
+            QString path = it.value().toString();
+            if (!path.isEmpty())
+                out.insert(path);
         }
     }
-
-    for (const QJsonValue& childVal : elementObj["children"].toArray())
-        CollectAssetPaths(childVal.toObject(), out);
 }
 
 // ---------------------------------------------------------------------------
@@ -188,32 +191,121 @@ bool SceneExporter::ExportToFolder(const SceneDocument* doc, const QString& fold
 // round-trip validation reports failure.
 // ---------------------------------------------------------------------------
 
-bool SceneExporter::BakeToUiBin(const SceneDocument* doc, const QString& filePath)
+bool SceneExporter::BakeToUiBin(const SceneDocument* doc, const QString& filePath, BakeStats* stats, bool validate,
+                                const UiBinWriteOptions& options)
 {
+    BakeStats local;
+    BakeStats& st = stats ? *stats : local;
+    st = BakeStats();
+
     // Write to a sibling temp file and swap it in only after validation, so a
     // failed bake can never clobber an existing good .uibin at the target path.
     const QString tempPath = filePath + QStringLiteral(".tmp");
 
-    if (!UiBinWriter::Write(doc, tempPath))
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool written = UiBinWriter::Write(doc, tempPath, options);
+    st.writeNs = timer.nsecsElapsed();
+
+    if (!written)
+    {
+        st.cancelled = options.progress && options.progress->IsCancelled();
+        st.error = st.cancelled ? QStringLiteral("cancelled") : QStringLiteral("write failed");
+        QFile::remove(tempPath);
+        return false;
+    }
+
+    return CommitBake(tempPath, filePath, st, validate, options.progress);
+}
+
+bool SceneExporter::BakeBundleToUiBin(const QVector<UiBinScene>& scenes, const QString& filePath, BakeStats* stats,
+                                      bool validate, const UiBinWriteOptions& options)
+{
+    BakeStats local;
+    BakeStats& st = stats ? *stats : local;
+    st = BakeStats();
+
+    const QString tempPath = filePath + QStringLiteral(".tmp");
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool written = UiBinWriter::WriteBundle(scenes, tempPath, options);
+    st.writeNs = timer.nsecsElapsed();
+
+    if (!written)
     {
+        st.cancelled = options.progress && options.progress->IsCancelled();
+        st.error = st.cancelled ? QStringLiteral("cancelled") : QStringLiteral("write failed");
         QFile::remove(tempPath);
         return false;
     }
 
-    QString error;
-    if (!UiBinReader::Validate(tempPath, &error))
+    return CommitBake(tempPath, filePath, st, validate, options.progress);
+}
+
+bool SceneExporter::CommitBake(const QString& tempPath, const QString& filePath, BakeStats& st, bool validate,
+                               BakeProgress* progress)
+{
+    st.bytes = QFileInfo(tempPath).size();
+
+    // Validation runs to completion once started; a cancel during it is
+    // honoured before the rename, so the old output is never replaced.
+    const auto cancelled = [&]()
     {
-        qWarning("SceneExporter::BakeToUiBin: round-trip validation failed for '%s': %s",
-                 qPrintable(filePath), qPrintable(error));
+        if (!progress || !progress->IsCancelled())
+            return false;
+        st.cancelled = true;
+        st.error = QStringLiteral("cancelled");
         QFile::remove(tempPath);
+        return true;
+    };
+
+    if (cancelled())
         return false;
+
+    if (validate)
+    {
+        if (progress)
+            progress->Begin(BakeProgress::PHASE_VALIDATE);
+
+        QElapsedTimer timer;
+        timer.start();
+
+        QString error;
+        const bool valid = UiBinReader::Validate(tempPath, &error);
+        st.validateNs = timer.nsecsElapsed();
+
+        if (!valid)
+        {
+            qWarning("SceneExporter: round-trip validation failed for '%s': %s",
+                     qPrintable(filePath), qPrintable(error));
+            st.validationFailed = true;
+            st.error = QStringLiteral("validation failed: ") + error;
+            QFile::remove(tempPath);
+            return false;
+        }
     }
 
+    if (cancelled())
+        return false;
+
     if (QFile::exists(filePath) && !QFile::remove(filePath))
     {
+        st.error = QStringLiteral("cannot replace existing output");
         QFile::remove(tempPath);
         return false;
     }
 
-    return QFile::rename(tempPath, filePath);
+    if (!QFile::rename(tempPath, filePath))
+    {
+        st.error = QStringLiteral("cannot rename temp file into place");
+        return false;
+    }
+
+    if (progress)
+        progress->Begin(BakeProgress::PHASE_DONE);
+
+    return true;
 }
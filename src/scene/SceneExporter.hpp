@@ -7,23 +7,60 @@
 #include <QSet>
 #include <QString>
 
+#include "scene/UiBinWriter.hpp"
+
+class BakeProgress;
 class SceneDocument;
 
 class SceneExporter
 {
 public:
 
+    // Per-phase cost of one BakeToUiBin call, for tooling that reports bake
+    // timings (the headless baker prints these as JSON). Times are wall-clock
+    // nanoseconds; bytes is the size of the final .uibin. cancelled is set
+    // when options.progress was cancelled; nothing is left on disk then.
+    struct BakeStats
+    {
+        qint64 writeNs = 0;
+        qint64 validateNs = 0;
+        qint64 bytes = 0;
+        bool validationFailed = false;
+        bool cancelled = false;
+        QString error;
+    };
+
     // Writes scene.json (paths kept relative to the project root) and copies
     // every referenced asset into folderPath, mirroring its relative location.
     static bool ExportToFolder(const SceneDocument* doc, const QString& folderPath);
 
     // Bakes the scene into the custom binary .uibin v4 container and
-    // round-trip validates the written file with UiBinReader.
-    static bool BakeToUiBin(const SceneDocument* doc, const QString& filePath);
+    // round-trip validates the written file with UiBinReader (skipped when
+    // validate is false). stats, if given, receives timings and the failure
+    // reason; options is forwarded to UiBinWriter::Write.
+    static bool BakeToUiBin(const SceneDocument* doc, const QString& filePath, BakeStats* stats = nullptr, bool validate = true,
+                            const UiBinWriteOptions& options = UiBinWriteOptions());
 
-private:
+    // BakeToUiBin for a multi-scene bundle (UiBinWriter::WriteBundle); the
+    // validation walks every scene.
+    static bool BakeBundleToUiBin(const QVector<UiBinScene>& scenes, const QString& filePath, BakeStats* stats = nullptr,
+                                  bool validate = true, const UiBinWriteOptions& options = UiBinWriteOptions());
 
+    // Every non-empty imagePath/fontPath/iconPath (any component key ending
+    // in "Path") in an element JSON subtree, as written: project-root
+    // relative or absolute.
     static void CollectAssetPaths(const QJsonObject& elementObj, QSet<QString>& out);
+
+    // Same, for one component object (Component::ToJson).
+    static void CollectComponentAssetPaths(const QJsonObject& componentObj, QSet<QString>& out);
+
+private:
+
+    // Shared tail of the bakes: validates tempPath and moves it over
+    // filePath, or removes it. progress may be null.
+    static bool CommitBake(const QString& tempPath, const QString& filePath, BakeStats& st, bool validate,
+                           BakeProgress* progress);
+
     static QMap<QString, QString> BuildAssetMapping(const QSet<QString>& absolutePaths);
     static QJsonObject RewritePaths(const QJsonObject& elementObj, const QMap<QString, QString>& mapping);
 };
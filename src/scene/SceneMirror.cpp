@@ -0,0 +1,204 @@
+#include "scene/SceneMirror.hpp"
+#include "scene/SceneDocument.hpp"
+#include "core/Component.hpp"
+#include "core/UiElement.hpp"
+#include "components/TransformComponent.hpp"
+
+#include <QSet>
+#include <QThread>
+
+#include <utility>
+
+// ---------------------------------------------------------------------------
+// SceneSnapshotter
+// ---------------------------------------------------------------------------
+
+SceneSnapshot SceneSnapshotter::Take(const SceneDocument* doc)
+{
+    SceneSnapshot out;
+    out.baseDir = doc->GetBaseDir();
+
+    // Revisions are unique across the process, so one seen last time is the
+    // same component in the same state.
+    QHash<quint64, QJsonObject> kept;
+    Walk(doc->GetRoot(), -1, out, kept);
+    json.swap(kept);
+
+    return out;
+}
+
+void SceneSnapshotter::Walk(const UiElement* el, int parent, SceneSnapshot& out, QHash<quint64, QJsonObject>& kept)
+{
+    SceneSnapshot::Element e;
+    e.id = el->GetId();
+    e.name = el->GetName();
+    e.parent = parent;
+
+    for (const Component* comp : el->GetComponents())
+    {
+        SceneSnapshot::Comp c;
+        c.revision = comp->Revision();
+
+        auto it = json.constFind(c.revision);
+        if (it != json.constEnd())
+            c.json = it.value();
+        else
+            comp->ToJson(c.json);
+
+        kept.insert(c.revision, c.json);
+        e.comps.push_back(c);
+    }
+
+    const int self = int(out.elements.size());
+    out.elements.push_back(e);
+
+    for (QObject* o : el->children())
+        if (auto* child = qobject_cast<UiElement*>(o))
+            Walk(child, self, out, kept);
+}
+
+// ---------------------------------------------------------------------------
+// SceneMirror
+// ---------------------------------------------------------------------------
+
+SceneMirror::SceneMirror() = default;
+SceneMirror::~SceneMirror() = default;
+
+void SceneMirror::Clear()
+{
+    index.clear();
+    doc.reset();
+}
+
+bool SceneMirror::Update(const SceneSnapshot& snapshot, QString* error)
+{
+    const QVector<SceneSnapshot::Element>& elems = snapshot.elements;
+    reloaded = 0;
+
+    // --- Check the snapshot before touching the mirror -------------------
+    if (elems.isEmpty() || elems.first().parent != -1)
+    {
+        Clear();
+        if (error) *error = QStringLiteral("empty snapshot");
+        return false;
+    }
+
+    QSet<QUuid> ids;
+    bool unique = true;
+    for (int i = 0; i < elems.size(); ++i)
+    {
+        if (i > 0 && (elems[i].parent < 0 || elems[i].parent >= i))
+        {
+            Clear();
+            if (error) *error = QStringLiteral("snapshot is not in pre-order");
+            return false;
+        }
+        if (ids.contains(elems[i].id))
+            unique = false;
+        ids.insert(elems[i].id);
+    }
+
+    // Another document, or a thread the mirror's objects do not live on.
+    // A scene with repeated UUIDs cannot be matched up and is rebuilt on
+    // every update, as a LoadJson would.
+    if (doc && (!unique || doc->GetRoot()->GetId() != elems.first().id || doc->thread() != QThread::currentThread()))
+        Clear();
+
+    if (!doc)
+        doc.reset(new SceneDocument(nullptr, SceneDocument::Mode::Headless));
+
+    if (doc->GetBaseDir() != snapshot.baseDir)
+        doc->SetBaseDir(snapshot.baseDir);
+
+    // --- Elements and their components -----------------------------------
+    QVector<UiElement*> live(elems.size(), nullptr);
+    for (int i = 0; i < elems.size(); ++i)
+    {
+        const SceneSnapshot::Element& e = elems[i];
+
+        auto it = unique ? index.find(e.id) : index.end();
+        if (it == index.end())
+        {
+            UiElement* el = i == 0 ? doc->GetRoot() : new UiElement(e.name.isEmpty() ? QStringLiteral("Element") : e.name);
+            el->SetId(e.id);
+            it = index.insert(e.id, Mirrored { el });
+        }
+
+        UiElement* el = it->element;
+        el->SetName(e.name);
+        live[i] = el;
+
+        QVector<quint64> revisions;
+        for (const SceneSnapshot::Comp& c : e.comps)
+            revisions.push_back(c.revision);
+
+        // Rebuilt whole rather than updated in place: a fresh component gets
+        // a fresh Revision() even if FromJson would not bump it.
+        if (it->built && it->revisions == revisions)
+            continue;
+
+        for (Component* comp : el->GetComponents())
+            delete comp;
+
+        for (const SceneSnapshot::Comp& c : e.comps)
+            if (Component* comp = Component::Create(c.json["kind"].toString(), el))
+                comp->FromJson(c.json);
+
+        // As SceneDocument::CreateItemFor keeps it for a headless load.
+        if (i > 0 && !el->GetComponent<TransformComponent>())
+            el->AddComponent<TransformComponent>();
+
+        it->revisions = revisions;
+        it->built = true;
+        ++reloaded;
+    }
+
+    // --- Structure --------------------------------------------------------
+    // Detach every element leaving its parent, so the removed subtrees hold
+    // only removed elements, then delete those from the top.
+    for (int i = 1; i < elems.size(); ++i)
+        if (live[i]->parent() != live[elems[i].parent])
+            live[i]->setParent(nullptr);
+
+    QSet<UiElement*> dead;
+    for (auto it = index.begin(); it != index.end();)
+    {
+        if (ids.contains(it.key()))
+        {
+            ++it;
+            continue;
+        }
+        dead.insert(it->element);
+        it = index.erase(it);
+    }
+
+    for (UiElement* d : std::as_const(dead))
+        if (!dead.contains(qobject_cast<UiElement*>(d->parent())))
+            delete d;
+
+    // Parents in pre-order, so every ancestor is already in place and
+    // re-adding a child can never make a cycle. Re-adding in order is how
+    // UiElement::ReparentTo orders siblings too.
+    QVector<QVector<UiElement*>> kids(elems.size());
+    for (int i = 1; i < elems.size(); ++i)
+        kids[elems[i].parent].push_back(live[i]);
+
+    for (int i = 0; i < elems.size(); ++i)
+    {
+        QVector<UiElement*> current;
+        for (QObject* o : live[i]->children())
+            if (auto* c = qobject_cast<UiElement*>(o))
+                current.push_back(c);
+
+        if (current == kids[i])
+            continue;
+
+        for (UiElement* c : kids[i])
+        {
+            c->setParent(nullptr);
+            c->setParent(live[i]);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,95 @@
+#ifndef SCENE_SCENEMIRROR_HPP
+#define SCENE_SCENEMIRROR_HPP
+
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+#include <QUuid>
+#include <QVector>
+
+#include <memory>
+
+class SceneDocument;
+class UiElement;
+
+// Plain (non-QObject) copy of an editor document, taken on the GUI thread
+// for a bake on a worker. Elements are in pre-order, the root first; each
+// component carries the editor component's Revision() with its JSON.
+struct SceneSnapshot
+{
+    struct Comp
+    {
+        quint64 revision = 0;
+        QJsonObject json;           // Component::ToJson, "kind" included
+    };
+
+    struct Element
+    {
+        QUuid id;
+        QString name;
+        int parent = -1;            // index of an earlier element; -1: root
+        QVector<Comp> comps;
+    };
+
+    QString baseDir;
+    QVector<Element> elements;
+};
+
+// GUI side: takes snapshots, serialising only components whose revision
+// changed since the previous one. The JSON of the others is shared, not
+// copied, so an unchanged component is not re-read.
+class SceneSnapshotter
+{
+public:
+
+    SceneSnapshot Take(const SceneDocument* doc);
+
+private:
+    void Walk(const UiElement* el, int parent, SceneSnapshot& out, QHash<quint64, QJsonObject>& kept);
+
+    QHash<quint64, QJsonObject> json;   // by revision, last snapshot only
+};
+
+// Worker side: a headless SceneDocument kept in step with snapshots across
+// bakes. Update rebuilds the components of an element only when their
+// revisions changed and moves, adds and removes elements by UUID, so
+// components the edit did not touch keep their identity and Revision() and
+// BakeCache's component memo hits as it does for an editor bake.
+//
+// Every call must come from the same thread, the one the document lives
+// on; a mirror found on another thread is rebuilt from scratch.
+class SceneMirror
+{
+public:
+
+    SceneMirror();
+    ~SceneMirror();
+
+    // False (with an error) for a malformed snapshot; the mirror is then
+    // empty and the next Update rebuilds it.
+    bool Update(const SceneSnapshot& snapshot, QString* error = nullptr);
+
+    // Drops the document, on the thread it lives on.
+    void Clear();
+
+    // nullptr until the first successful Update.
+    const SceneDocument* Document() const { return doc.get(); }
+
+    // Elements whose components the last Update (re)built.
+    int Reloaded() const { return reloaded; }
+
+private:
+
+    struct Mirrored
+    {
+        UiElement* element = nullptr;
+        QVector<quint64> revisions;     // of the editor components it holds
+        bool built = false;             // components loaded at least once
+    };
+
+    std::unique_ptr<SceneDocument> doc;
+    QHash<QUuid, Mirrored> index;
+    int reloaded = 0;
+};
+
+#endif
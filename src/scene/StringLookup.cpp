@@ -0,0 +1,144 @@
+#include "scene/StringLookup.hpp"
+#include "scene/UiBinCommon.hpp"
+
+#include <QtEndian>
+
+using namespace uibin;
+
+namespace
+{
+    quint32 LoadU32(const char* p) { return qFromLittleEndian<quint32>(p); }
+    quint64 LoadU64(const char* p) { return qFromLittleEndian<quint64>(p); }
+
+    // Smallest power of two holding count at a load factor of one half.
+    quint32 SlotCountFor(quint32 count)
+    {
+        quint32 n = 1;
+        while (n < count * 2u)
+            n <<= 1;
+        return n;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// StringLookupBuilder
+// ---------------------------------------------------------------------------
+
+void StringLookupBuilder::Add(QByteArrayView utf8)
+{
+    hashes.push_back(Hash64(utf8.data(), utf8.size()));
+}
+
+QByteArray StringLookupBuilder::Section() const
+{
+    const quint32 count = quint32(hashes.size());
+    const quint32 slots = SlotCountFor(count);
+    const quint32 mask = slots - 1;
+
+    QVector<quint32> table(int(slots), kNoString);
+    for (quint32 id = 0; id < count; ++id)
+    {
+        quint32 s = quint32(hashes[int(id)]) & mask;
+        while (table[int(s)] != kNoString)
+            s = (s + 1) & mask;
+        table[int(s)] = id;
+    }
+
+    Writer w;
+    w.U32(count);
+    w.U32(slots);
+    for (quint64 h : hashes)
+        w.U64(h);
+    for (quint32 id : table)
+        w.U32(id);
+
+    return w.buffer();
+}
+
+// ---------------------------------------------------------------------------
+// StringLookupView
+// ---------------------------------------------------------------------------
+
+bool StringLookupView::Open(QByteArrayView section, quint32 strings)
+{
+    data = nullptr;
+    stringCount = slotCount = slotsAt = 0;
+
+    if (section.size() < qsizetype(kStringLookupHeaderSize))
+        return false;
+
+    const char* d = section.data();
+    const quint32 count = LoadU32(d);
+    const quint32 slots = LoadU32(d + 4);
+
+    // A power-of-two slot count above the string count, and (below) each
+    // id in at most one slot, so at least one slot is free.
+    if (count != strings || slots == 0 || (slots & (slots - 1)) != 0 || slots <= count)
+        return false;
+
+    const quint64 at = kStringLookupHeaderSize + quint64(count) * 8;
+    if (at + quint64(slots) * kStringLookupSlotSize != quint64(section.size()))
+        return false;
+
+    QVector<bool> seen(int(count), false);
+    for (quint32 i = 0; i < slots; ++i)
+    {
+        const quint32 id = LoadU32(d + at + i * kStringLookupSlotSize);
+        if (id == kNoString)
+            continue;
+        if (id >= count || seen[int(id)])
+            return false;
+        seen[int(id)] = true;
+    }
+
+    data = d;
+    stringCount = count;
+    slotCount = slots;
+    slotsAt = quint32(at);
+    return true;
+}
+
+quint64 StringLookupView::HashAt(quint32 id) const
+{
+    return id < stringCount ? LoadU64(data + kStringLookupHeaderSize + id * 8) : 0;
+}
+
+quint32 StringLookupView::Find(QByteArrayView utf8, const std::function<QByteArrayView(quint32)>& stringAt) const
+{
+    if (!data)
+        return kNoString;
+
+    const quint64 h = Hash64(utf8.data(), utf8.size());
+    const quint32 mask = slotCount - 1;
+
+    // Open guarantees a free slot; the bound is a second line of defence.
+    quint32 s = quint32(h) & mask;
+    for (quint32 n = 0; n < slotCount; ++n, s = (s + 1) & mask)
+    {
+        const quint32 id = LoadU32(data + slotsAt + s * kStringLookupSlotSize);
+        if (id == kNoString)
+            return kNoString;
+
+        if (HashAt(id) == h && stringAt(id) == utf8)
+            return id;
+    }
+    return kNoString;
+}
+
+bool StringLookupView::Reachable(quint32 id) const
+{
+    if (!data || id >= stringCount)
+        return false;
+
+    const quint32 mask = slotCount - 1;
+    quint32 s = quint32(HashAt(id)) & mask;
+    for (quint32 n = 0; n < slotCount; ++n, s = (s + 1) & mask)
+    {
+        const quint32 at = LoadU32(data + slotsAt + s * kStringLookupSlotSize);
+        if (at == id)
+            return true;
+        if (at == kNoString)
+            return false;
+    }
+    return false;
+}
@@ -0,0 +1,62 @@
+#ifndef SCENE_STRINGLOOKUP_HPP
+#define SCENE_STRINGLOOKUP_HPP
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QVector>
+#include <functional>
+
+// Bake side of the STRH extension section (spec section 11.5): a hash table
+// from string bytes to string id over the whole string table, so a runtime
+// resolves "Transform" or an element name with one probe instead of a scan
+// or a hash map rebuilt on every load.
+//
+// Hashes are uibin::Hash64 (64-bit FNV-1a, unseeded) of the UTF-8 bytes.
+// The table is open addressing with linear probing, a power-of-two slot
+// count and a load factor of at most one half.
+class StringLookupBuilder
+{
+public:
+
+    // Adds the next string; ids follow call order, starting at 0.
+    void Add(QByteArrayView utf8);
+
+    bool IsEmpty() const { return hashes.isEmpty(); }
+
+    QByteArray Section() const;
+
+private:
+    QVector<quint64> hashes;        // by string id
+};
+
+// Read side: lookups over a STRH section body. Holds only the view; the
+// bytes must outlive it.
+class StringLookupView
+{
+public:
+
+    // Returns false if the body is not a well-formed STRH section over
+    // exactly stringCount strings.
+    bool Open(QByteArrayView section, quint32 stringCount);
+
+    bool IsOpen() const { return data != nullptr; }
+
+    quint64 HashAt(quint32 id) const;           // 0 if out of range
+
+    // Id of the string whose bytes equal utf8, or uibin::kNoString.
+    // stringAt returns the bytes of a string id; it is called only for
+    // candidates whose stored hash matches.
+    quint32 Find(QByteArrayView utf8, const std::function<QByteArrayView(quint32)>& stringAt) const;
+
+    // True if id sits on the probe sequence from its hash's home slot, as
+    // Find walks it. Validation only; Open does not check placement.
+    bool Reachable(quint32 id) const;
+
+private:
+    const char* data = nullptr;
+    quint32 stringCount = 0;
+    quint32 slotCount = 0;
+    quint32 slotsAt = 0;
+};
+
+#endif
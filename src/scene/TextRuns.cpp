@@ -0,0 +1,242 @@
+#include "scene/TextRuns.hpp"
+#include "scene/UiBinCommon.hpp"
+
+#include <QFont>
+#include <QFontDatabase>
+#include <QGlyphRun>
+#include <QRawFont>
+#include <QTextLayout>
+#include <QtEndian>
+
+using namespace uibin;
+
+namespace
+{
+    // Line width for unwrapped layout; only explicit breaks end a line.
+    const qreal kUnbounded = 1.0e7;
+
+    qint32 Fixed(qreal v) { return qint32(qRound(v * 64.0)); }
+
+    quint32 LoadU32(const char* p) { return qFromLittleEndian<quint32>(p); }
+    qint32  LoadI32(const char* p) { return qFromLittleEndian<qint32>(p); }
+}
+
+// ---------------------------------------------------------------------------
+// TextRunBuilder
+// ---------------------------------------------------------------------------
+
+TextRunBuilder::~TextRunBuilder()
+{
+    for (int id : fontIds)
+        QFontDatabase::removeApplicationFont(id);
+}
+
+QString TextRunBuilder::AssetFamily(quint32 fontAsset, const QByteArray& fontData)
+{
+    auto it = assetFamilies.constFind(fontAsset);
+    if (it != assetFamilies.constEnd())
+        return it.value();
+
+    QString family;
+    const int id = QFontDatabase::addApplicationFontFromData(fontData);
+    if (id >= 0)
+    {
+        fontIds.push_back(id);
+        const QStringList families = QFontDatabase::applicationFontFamilies(id);
+        if (!families.isEmpty())
+            family = families.first();
+    }
+
+    assetFamilies.insert(fontAsset, family);
+    return family;
+}
+
+void TextRunBuilder::Add(quint32 element, quint16 component, quint32 fontAsset, const QByteArray& fontData,
+                         const QString& family, int pixelSize, const QString& text)
+{
+    if (text.isEmpty())
+        return;
+
+    QString face;
+    if (!fontData.isEmpty())
+        face = AssetFamily(fontAsset, fontData);
+    if (face.isEmpty())
+    {
+        face = family;
+        fontAsset = kNoAsset;
+    }
+
+    QFont font(face);
+    font.setPixelSize(qMax(1, pixelSize));
+
+    // As QPainter::drawText does: newlines become line separators.
+    QString laidOut = text;
+    laidOut.replace(QLatin1Char('\n'), QChar::LineSeparator);
+
+    QTextLayout layout(laidOut, font);
+    layout.beginLayout();
+    qreal y = 0.0;
+    qreal width = 0.0;
+    for (;;)
+    {
+        QTextLine line = layout.createLine();
+        if (!line.isValid())
+            break;
+
+        line.setLineWidth(kUnbounded);
+        line.setPosition(QPointF(0.0, y));
+        y += line.height();
+        width = qMax(width, line.naturalTextWidth());
+    }
+    layout.endLayout();
+
+    const QList<QGlyphRun> shaped = layout.glyphRuns();
+    if (shaped.isEmpty())
+        return;
+
+    for (const QGlyphRun& r : shaped)
+        if (!(r.rawFont() == shaped.first().rawFont()))
+            return;                 // font fallback: leave it to the runtime
+
+    Run run;
+    run.element = element;
+    run.component = component;
+    run.fontAsset = fontAsset;
+    run.pixelSize = quint32(qMax(1, pixelSize));
+    run.firstGlyph = quint32(glyphs.size());
+    run.width = Fixed(width);
+    run.height = Fixed(y);
+
+    for (const QGlyphRun& r : shaped)
+    {
+        const QList<quint32> indexes = r.glyphIndexes();
+        const QList<QPointF> positions = r.positions();
+        const QList<QPointF> advances = r.rawFont().advancesForGlyphIndexes(indexes);
+
+        for (int i = 0; i < indexes.size() && i < positions.size(); ++i)
+        {
+            const qreal advance = i < advances.size() ? advances[i].x() : 0.0;
+            glyphs.push_back(Glyph { indexes[i], Fixed(positions[i].x()), Fixed(positions[i].y()), Fixed(advance) });
+        }
+    }
+
+    run.glyphCount = quint32(glyphs.size()) - run.firstGlyph;
+    runs.push_back(run);
+}
+
+QByteArray TextRunBuilder::Section() const
+{
+    Writer w;
+    w.U32(quint32(runs.size()));
+    w.U32(quint32(glyphs.size()));
+
+    for (const Run& r : runs)
+    {
+        w.U32(r.element);
+        w.U16(r.component);
+        w.U16(0);
+        w.U32(r.fontAsset);
+        w.U32(r.pixelSize);
+        w.U32(r.firstGlyph);
+        w.U32(r.glyphCount);
+        w.I32(r.width);
+        w.I32(r.height);
+    }
+
+    for (const Glyph& g : glyphs)
+    {
+        w.U32(g.glyphIndex);
+        w.I32(g.x);
+        w.I32(g.y);
+        w.I32(g.advance);
+    }
+
+    return w.buffer();
+}
+
+// ---------------------------------------------------------------------------
+// TextRunView
+// ---------------------------------------------------------------------------
+
+bool TextRunView::Open(QByteArrayView section)
+{
+    data = nullptr;
+    runCount = glyphCount = 0;
+
+    if (section.size() < qsizetype(kTextRunHeaderSize))
+        return false;
+
+    const char* d = section.data();
+    const quint32 runs = LoadU32(d);
+    const quint32 glyphs = LoadU32(d + 4);
+
+    const quint64 glyphsOff = kTextRunHeaderSize + quint64(runs) * kTextRunSize;
+    if (glyphsOff + quint64(glyphs) * kTextRunGlyphSize > quint64(section.size()))
+        return false;
+
+    for (quint32 i = 0; i < runs; ++i)
+    {
+        const char* r = d + kTextRunHeaderSize + i * kTextRunSize;
+        if (quint64(LoadU32(r + 16)) + LoadU32(r + 20) > glyphs)
+            return false;
+    }
+
+    data = d;
+    runCount = runs;
+    glyphCount = glyphs;
+    glyphsAt = quint32(glyphsOff);
+    return true;
+}
+
+bool TextRunView::FindRun(quint32 element, quint16 component, Run* out) const
+{
+    // Runs are stored in tree order: by element, then component.
+    const quint64 key = (quint64(element) << 16) | component;
+
+    quint32 lo = 0;
+    quint32 hi = runCount;
+    while (lo < hi)
+    {
+        const quint32 mid = lo + (hi - lo) / 2;
+        const char* r = data + kTextRunHeaderSize + mid * kTextRunSize;
+        const quint64 k = (quint64(LoadU32(r)) << 16) | qFromLittleEndian<quint16>(r + 4);
+
+        if (k < key)
+        {
+            lo = mid + 1;
+        }
+        else if (k > key)
+        {
+            hi = mid;
+        }
+        else
+        {
+            if (out)
+            {
+                out->fontAsset  = LoadU32(r + 8);
+                out->pixelSize  = LoadU32(r + 12);
+                out->firstGlyph = LoadU32(r + 16);
+                out->glyphCount = LoadU32(r + 20);
+                out->width      = LoadI32(r + 24);
+                out->height     = LoadI32(r + 28);
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+TextRunView::Glyph TextRunView::GlyphAt(quint32 index) const
+{
+    Glyph g;
+    if (index >= glyphCount)
+        return g;
+
+    const char* e = data + glyphsAt + index * kTextRunGlyphSize;
+    g.glyphIndex = LoadU32(e);
+    g.x          = LoadI32(e + 4);
+    g.y          = LoadI32(e + 8);
+    g.advance    = LoadI32(e + 12);
+    return g;
+}
@@ -0,0 +1,111 @@
+#ifndef SCENE_TEXTRUNS_HPP
+#define SCENE_TEXTRUNS_HPP
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// Bake side of the TRUN extension section (spec section 11.3): the shaped
+// glyph run of each static Text/Button label, so a runtime can skip shaping
+// and measuring (spec 8c steps 4-5).
+//
+// Text is laid out with QTextLayout, one line per explicit line break and no
+// wrapping. Glyph positions are pen positions on each line's baseline,
+// relative to the top-left of the run's logical box; all values are 26.6
+// fixed point (1/64 px), y down.
+class TextRunBuilder
+{
+public:
+
+    TextRunBuilder() = default;
+    ~TextRunBuilder();
+
+    TextRunBuilder(const TextRunBuilder&) = delete;
+    TextRunBuilder& operator=(const TextRunBuilder&) = delete;
+
+    // Shapes one component's text. The face follows spec 8c: the embedded
+    // font (fontData, behind fontAsset) if it loads, else fontFamily. Runs
+    // that needed a fallback font for some glyphs are not stored - their
+    // glyph ids would not belong to the resolved face.
+    void Add(quint32 element, quint16 component, quint32 fontAsset, const QByteArray& fontData,
+             const QString& family, int pixelSize, const QString& text);
+
+    bool IsEmpty() const { return runs.isEmpty(); }
+
+    QByteArray Section() const;
+
+private:
+
+    struct Glyph
+    {
+        quint32 glyphIndex;
+        qint32 x;
+        qint32 y;
+        qint32 advance;
+    };
+
+    struct Run
+    {
+        quint32 element;
+        quint16 component;
+        quint32 fontAsset;
+        quint32 pixelSize;
+        quint32 firstGlyph;
+        quint32 glyphCount;
+        qint32 width;
+        qint32 height;
+    };
+
+    // Family name an embedded font registers under, or empty.
+    QString AssetFamily(quint32 fontAsset, const QByteArray& fontData);
+
+    QHash<quint32, QString> assetFamilies;
+    QVector<int> fontIds;           // application fonts to unregister
+    QVector<Run> runs;
+    QVector<Glyph> glyphs;
+};
+
+// Read side: lookups over a TRUN section body. Holds only the view; the
+// bytes must outlive it.
+class TextRunView
+{
+public:
+
+    struct Run
+    {
+        quint32 fontAsset = 0;      // asset index, or uibin::kNoAsset (family)
+        quint32 pixelSize = 0;
+        quint32 firstGlyph = 0;
+        quint32 glyphCount = 0;
+        qint32 width = 0;           // 26.6 logical box
+        qint32 height = 0;
+    };
+
+    struct Glyph
+    {
+        quint32 glyphIndex = 0;     // in the run's face
+        qint32 x = 0;               // 26.6 pen position
+        qint32 y = 0;
+        qint32 advance = 0;
+    };
+
+    // Returns false if the body is not a well-formed TRUN section.
+    bool Open(QByteArrayView section);
+
+    quint32 RunCount() const { return runCount; }
+
+    // The run of component `component` on pre-order element `element`.
+    bool FindRun(quint32 element, quint16 component, Run* out) const;
+
+    Glyph GlyphAt(quint32 index) const;
+
+private:
+    const char* data = nullptr;
+    quint32 runCount = 0;
+    quint32 glyphCount = 0;
+    quint32 glyphsAt = 0;
+};
+
+#endif
@@ -0,0 +1,151 @@
+#include "scene/UiBinAssetResolver.hpp"
+#include "scene/UiBinCommon.hpp"
+
+#include <QIODevice>
+#include <QtEndian>
+
+QString UiBinAssetResolver::Domain(quint32 index) const
+{
+    return index < quint32(records.size()) ? records[int(index)].domain : QString();
+}
+
+QString UiBinAssetResolver::Registry(quint32 index) const
+{
+    return index < quint32(records.size()) ? records[int(index)].registry : QString();
+}
+
+quint32 UiBinAssetResolver::Length(quint32 index) const
+{
+    return index < quint32(records.size()) ? records[int(index)].rawLength : 0;
+}
+
+quint8 UiBinAssetResolver::Codec(quint32 index) const
+{
+    return index < quint32(records.size()) ? records[int(index)].codec : quint8(uibin::CODEC_STORED);
+}
+
+QByteArray UiBinAssetResolver::Data(quint32 index)
+{
+    if (index >= quint32(records.size()))
+        return QByteArray();
+
+    auto it = cache.constFind(index);
+    if (it != cache.constEnd())
+        return it.value();
+
+    const Record& r = records[int(index)];
+    QByteArray data;
+
+    if (r.codec == uibin::CODEC_SHARED)
+    {
+        // The owner decodes (and caches) the blob; this entry shares it.
+        const quint32 owner = Owner(index);
+        if (owner != uibin::kNoAsset)
+            data = Data(owner);
+        if (data.size() != qsizetype(r.rawLength))
+            data.clear();
+    }
+    else if (r.length > 0)
+    {
+        data = Stored(r);
+
+        if (r.codec == uibin::CODEC_ZLIB && !data.isEmpty())
+            data = qUncompress(data);
+        else if (r.codec != uibin::CODEC_STORED && r.codec != uibin::CODEC_PIXELS)
+            data.clear();
+
+        if (data.size() != qsizetype(r.rawLength))
+            data.clear();
+    }
+
+    cache.insert(index, data);
+    return data;
+}
+
+QByteArray UiBinAssetResolver::Stored(const Record& r) const
+{
+    QByteArray data;
+    if (!r.bytes.isNull())
+    {
+        data = r.bytes;
+    }
+    else if (!file.isNull())
+    {
+        if (r.offset + r.length <= file.size())
+            data = QByteArray(file.constData() + r.offset, qsizetype(r.length));
+    }
+    else if (device && !device->isSequential() && device->seek(deviceBase + r.offset))
+    {
+        data = device->read(r.length);
+    }
+
+    if (data.size() != qsizetype(r.length))
+        data.clear();
+    else if (masked && r.bytes.isNull())
+        uibin::Obfuscate(data.data(), int(data.size()), quint64(r.offset - uibin::kHeaderSize));
+    return data;
+}
+
+quint32 UiBinAssetResolver::Owner(quint32 index) const
+{
+    const Record& r = records[int(index)];
+    if (r.codec != uibin::CODEC_SHARED || r.length != 4)
+        return uibin::kNoAsset;
+
+    const QByteArray stub = Stored(r);
+    if (stub.size() != 4)
+        return uibin::kNoAsset;
+
+    const quint32 owner = qFromLittleEndian<quint32>(stub.constData());
+    if (owner >= index || records[int(owner)].codec == uibin::CODEC_SHARED)
+        return uibin::kNoAsset;
+    return owner;
+}
+
+QImage UiBinAssetResolver::Image(quint32 index)
+{
+    if (index < quint32(records.size()) && records[int(index)].codec == uibin::CODEC_SHARED)
+    {
+        const quint32 owner = Owner(index);
+        if (owner == uibin::kNoAsset)
+            return QImage();
+        index = owner;
+    }
+
+    if (Codec(index) != uibin::CODEC_PIXELS)
+        return QImage();
+
+    const QByteArray data = Data(index);
+
+    uibin::PixelHeader h;
+    if (!uibin::ReadPixelHeader(data, &h) || h.width > 0x7FFFFFFF || h.height > 0x7FFFFFFF)
+        return QImage();
+
+    QByteArray* hold = new QByteArray(data);
+    return QImage(reinterpret_cast<const uchar*>(hold->constData()) + uibin::kPixelHeaderSize,
+                  int(h.width), int(h.height), qsizetype(h.stride), QImage::Format_RGBA8888_Premultiplied,
+                  [](void* p) { delete static_cast<QByteArray*>(p); }, hold);
+}
+
+bool UiBinAssetResolver::Atlas(quint32 index, AtlasRect* rect) const
+{
+    auto it = atlas.constFind(index);
+    if (it == atlas.constEnd())
+        return false;
+
+    if (rect)
+        *rect = it.value();
+    return true;
+}
+
+void UiBinAssetResolver::Reset(bool isMasked)
+{
+    file.clear();
+    device = nullptr;
+    deviceBase = 0;
+    masked = isMasked;
+    records.clear();
+    atlas.clear();
+    extensions.clear();
+    cache.clear();
+}
@@ -0,0 +1,104 @@
+#ifndef SCENE_UIBINASSETRESOLVER_HPP
+#define SCENE_UIBINASSETRESOLVER_HPP
+
+#include <QByteArray>
+#include <QHash>
+#include <QImage>
+#include <QString>
+#include <QVector>
+
+class QIODevice;
+
+// On-demand access to the asset blobs of a container decoded by UiBinReader
+// (spec section 5). The reader records only each asset's identity and
+// (offset, length); bytes are fetched - and demasked - on the first Data()
+// call and cached by asset index, so a hierarchy-only load never touches the
+// blobs at all.
+//
+// The source is either the caller's file bytes (shared, never copied whole)
+// or a random-access QIODevice the caller keeps open; assets a patch added
+// (UiBinPatch::Apply) carry their own bytes. Compressed blobs
+// (uibin::AssetCodec) are inflated on that same first access. A
+// CODEC_SHARED record (spec section 5c) serves its owner's decoded bytes,
+// so a blob several records share is fetched and inflated once. Not
+// thread-safe.
+class UiBinAssetResolver
+{
+public:
+
+    int Count() const { return records.size(); }
+
+    QString Domain(quint32 index) const;
+    QString Registry(quint32 index) const;
+    quint32 Length(quint32 index) const;        // decoded size
+    quint8 Codec(quint32 index) const;          // uibin::AssetCodec, as stored
+
+    // The asset's bytes; empty for an empty/missing asset or an unreadable
+    // source. Fetched once, then served from the cache.
+    QByteArray Data(quint32 index);
+
+    // A CODEC_PIXELS asset (spec section 5b) as a premultiplied RGBA8 image
+    // that shares the fetched bytes: no copy and no decode. It holds its own
+    // reference, so it outlives ClearCache. Null for any other asset; a
+    // shared record is judged by its owner's codec.
+    QImage Image(quint32 index);
+
+    bool IsCached(quint32 index) const { return cache.contains(index); }
+    void ClearCache() { cache.clear(); }
+
+    // Where a packed image lives (spec section 11.1): the page's asset index
+    // and the image's pixel rect on it. A packed asset's own Data() is empty.
+    struct AtlasRect
+    {
+        quint32 page = 0;
+        quint16 x = 0;
+        quint16 y = 0;
+        quint16 w = 0;
+        quint16 h = 0;
+    };
+
+    // Returns false if the asset is not packed into an atlas page.
+    bool Atlas(quint32 index, AtlasRect* rect) const;
+
+    // Body of an extension section the reader keeps (ATLS, GLYF, TRUN,
+    // LAYT - spec section 11), or empty. Read GLYF through GlyphAtlasView,
+    // TRUN through TextRunView and LAYT through ResolvedLayoutView. STRH
+    // and EIDX index the string table and the tree bytes, so only UiBinView
+    // uses them.
+    QByteArray Extension(const char* tag) const { return extensions.value(QByteArray(tag, 4)); }
+
+private:
+    friend class UiBinReader;
+    friend class UiBinPatch;
+
+    struct Record
+    {
+        QString domain;
+        QString registry;
+        qint64 offset = 0;      // file offset of the blob
+        quint32 length = 0;     // stored bytes
+        quint32 rawLength = 0;  // decoded bytes
+        quint8 codec = 0;       // uibin::AssetCodec
+        QByteArray bytes;       // as stored, for assets a patch added
+    };
+
+    void Reset(bool masked);
+
+    // The record's bytes as stored, demasked; empty if unreadable.
+    QByteArray Stored(const Record& r) const;
+
+    // Owner of a CODEC_SHARED record, or uibin::kNoAsset.
+    quint32 Owner(quint32 index) const;
+
+    QByteArray file;
+    QIODevice* device = nullptr;
+    qint64 deviceBase = 0;      // device position of the container start
+    bool masked = false;
+
+    QVector<Record> records;
+    QHash<quint32, AtlasRect> atlas;
+    QHash<QByteArray, QByteArray> extensions;
+    QHash<quint32, QByteArray> cache;
+};
+
+#endif
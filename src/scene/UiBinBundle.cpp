@@ -0,0 +1,57 @@
+#include "scene/UiBinBundle.hpp"
+#include "scene/UiBinReader.hpp"
+
+#include <QBuffer>
+#include <QFile>
+
+bool UiBinBundle::Open(const QByteArray& bytes, QString* error)
+{
+    file.clear();
+    names.clear();
+    assets = UiBinAssetResolver();
+    assetsReady = false;
+
+    QBuffer device;
+    device.setData(bytes);
+    if (!device.open(QIODevice::ReadOnly))
+    {
+        if (error) *error = QStringLiteral("cannot read bundle bytes");
+        return false;
+    }
+
+    const QStringList found = UiBinReader::SceneNames(&device);
+    if (found.isEmpty())
+    {
+        if (error) *error = QStringLiteral("not a bundle (no scene directory)");
+        return false;
+    }
+
+    file = bytes;
+    names = found;
+    return true;
+}
+
+bool UiBinBundle::Open(const QString& filePath, QString* error)
+{
+    QFile f(filePath);
+    if (!f.open(QIODevice::ReadOnly))
+    {
+        if (error) *error = QStringLiteral("cannot open file");
+        return false;
+    }
+
+    return Open(f.readAll(), error);
+}
+
+UiElement* UiBinBundle::LoadScene(int index)
+{
+    if (index < 0 || index >= names.size())
+        return nullptr;
+
+    // The asset table is the bundle's, not the scene's: fill the resolver
+    // once and keep its cache across loads.
+    UiElement* root = UiBinReader::ReadScene(file, index, assetsReady ? nullptr : &assets);
+    if (root)
+        assetsReady = true;
+    return root;
+}
@@ -0,0 +1,44 @@
+#ifndef SCENE_UIBINBUNDLE_HPP
+#define SCENE_UIBINBUNDLE_HPP
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include "scene/UiBinAssetResolver.hpp"
+
+class UiElement;
+
+// A multi-scene bundle (UiBinWriter::WriteBundle, spec section 11.7) opened
+// for loading scenes on demand. The file bytes are shared, never copied
+// whole; each LoadScene reads the string table and asset records and just
+// that scene's tree. Every scene resolves its assets through the one
+// Assets() resolver, whose cache outlives the loads, so a font or icon the
+// screens share is fetched and decoded once however many of them use it.
+class UiBinBundle
+{
+public:
+
+    // Returns false (with an error) if bytes are not a bundle.
+    bool Open(const QByteArray& bytes, QString* error = nullptr);
+    bool Open(const QString& filePath, QString* error = nullptr);
+
+    int Count() const { return int(names.size()); }
+    QStringList SceneNames() const { return names; }
+    int IndexOf(const QString& name) const { return int(names.indexOf(name)); }
+
+    // A newly allocated scene root (caller owns), or nullptr for an unknown
+    // scene or a corrupt tree. Asset references index Assets().
+    UiElement* LoadScene(int index);
+    UiElement* LoadScene(const QString& name) { return LoadScene(IndexOf(name)); }
+
+    UiBinAssetResolver& Assets() { return assets; }
+
+private:
+    QByteArray file;
+    QStringList names;
+    UiBinAssetResolver assets;
+    bool assetsReady = false;   // filled by the first successful load
+};
+
+#endif
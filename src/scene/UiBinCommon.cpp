@@ -1,20 +1,198 @@
 #include "scene/UiBinCommon.hpp"
 
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <QtEndian>
+
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 
+namespace
+{
+    const quint32 kMaskSeed = 0x5BC8A93Du;
+    const quint32 kMaskMul  = 1103515245u;
+    const quint32 kMaskInc  = 12345u;
+
+    // Buffers are cut into blocks of this size; below kMaskParallelMin the
+    // thread hand-off costs more than it saves.
+    const int kMaskBlock       = 256 * 1024;
+    const int kMaskParallelMin = 4 * kMaskBlock;
+
+    // Independent generator lanes in the inner loop. Wide enough for the
+    // compiler to vectorise the multiply/XOR on SSE/AVX/NEON.
+    const int kMaskLanes = 16;
+
+    // s -> mul * s + inc (mod 2^32).
+    struct Affine
+    {
+        quint32 mul;
+        quint32 inc;
+    };
+
+    // Applies f, then g.
+    Affine Then(Affine f, Affine g)
+    {
+        return Affine { g.mul * f.mul, g.mul * f.inc + g.inc };
+    }
+
+    // The LCG step applied k times, by square-and-multiply: O(log k).
+    Affine Jump(quint64 k)
+    {
+        Affine result { 1u, 0u };
+        Affine step { kMaskMul, kMaskInc };
+        while (k)
+        {
+            if (k & 1u)
+                result = Then(result, step);
+            step = Then(step, step);
+            k >>= 1;
+        }
+        return result;
+    }
+
+    // Masks data[0..n) given the generator state before data[0].
+    void MaskRange(uchar* data, int n, quint32 state)
+    {
+        // lanes[j] is the state that produces byte i + j.
+        quint32 lanes[kMaskLanes];
+        for (int j = 0; j < kMaskLanes; ++j)
+        {
+            state = state * kMaskMul + kMaskInc;
+            lanes[j] = state;
+        }
+
+        const Affine stride = Jump(kMaskLanes);
+
+        int i = 0;
+        for (; i + kMaskLanes <= n; i += kMaskLanes)
+        {
+            for (int j = 0; j < kMaskLanes; ++j)
+                data[i + j] ^= uchar(lanes[j] >> 16);
+            for (int j = 0; j < kMaskLanes; ++j)
+                lanes[j] = lanes[j] * stride.mul + stride.inc;
+        }
+
+        for (int j = 0; i + j < n; ++j)
+            data[i + j] ^= uchar(lanes[j] >> 16);
+    }
+
+    quint32 StateAt(quint64 pos)
+    {
+        const Affine a = Jump(pos);
+        return a.mul * kMaskSeed + a.inc;
+    }
+}
+
 namespace uibin
 {
-    void Obfuscate(char* data, int n)
+    void Obfuscate(char* data, int n, quint64 streamOffset)
     {
-        quint32 s = 0x5BC8A93Du;
-        for (int i = 0; i < n; ++i)
+        if (n <= 0)
+            return;
+
+        uchar* bytes = reinterpret_cast<uchar*>(data);
+
+        if (n < kMaskParallelMin)
         {
-            s = s * 1103515245u + 12345u;
-            data[i] = char(quint8(data[i]) ^ quint8(s >> 16));
+            MaskRange(bytes, n, StateAt(streamOffset));
+            return;
         }
+
+        const int blocks = (n + kMaskBlock - 1) / kMaskBlock;
+        ParallelFor(blocks, [&](int b)
+        {
+            const int off = b * kMaskBlock;
+            MaskRange(bytes + off, std::min(kMaskBlock, n - off), StateAt(streamOffset + quint64(off)));
+        });
+    }
+
+    void ParallelFor(int count, const std::function<void(int)>& fn)
+    {
+        const int threads = std::min(QThread::idealThreadCount(), count);
+        if (threads < 2)
+        {
+            for (int i = 0; i < count; ++i)
+                fn(i);
+            return;
+        }
+
+        // Items are claimed from a shared counter by the calling thread and
+        // by whatever pool threads are idle right now. tryStart never queues,
+        // so this cannot deadlock when called from a pool thread itself.
+        std::atomic<int> next { 0 };
+
+        auto work = [&]()
+        {
+            for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+                fn(i);
+        };
+
+        QSemaphore finished;
+        int helpers = 0;
+        for (int t = 1; t < threads; ++t)
+        {
+            if (!QThreadPool::globalInstance()->tryStart([&]() { work(); finished.release(); }))
+                break;
+            ++helpers;
+        }
+
+        work();
+        finished.acquire(helpers);
+    }
+
+    quint64 Hash64(const char* data, qsizetype n, quint64 seed)
+    {
+        quint64 h = seed;
+        for (qsizetype i = 0; i < n; ++i)
+        {
+            h ^= quint8(data[i]);
+            h *= 0x100000001B3ull;
+        }
+        return h;
+    }
+
+    int TagWidth(quint8 tag)
+    {
+        switch (tag)
+        {
+        case TAG_NONE:      return 0;
+        case TAG_BOOL:      return 1;
+        case TAG_INT32:
+        case TAG_STRING:
+        case TAG_COLOR:
+        case TAG_ASSET_REF: return 4;
+        case TAG_INT64:
+        case TAG_DOUBLE:    return 8;
+        case TAG_POINT:     return 16;
+        default:            return -1;
+        }
+    }
+
+    bool ReadPixelHeader(QByteArrayView blob, PixelHeader* out)
+    {
+        if (blob.size() < qsizetype(kPixelHeaderSize))
+            return false;
+
+        PixelHeader h;
+        h.width  = qFromLittleEndian<quint32>(blob.data());
+        h.height = qFromLittleEndian<quint32>(blob.data() + 4);
+        h.stride = qFromLittleEndian<quint32>(blob.data() + 8);
+        h.format = qFromLittleEndian<quint16>(blob.data() + 12);
+
+        if (h.format != PIXELS_RGBA8_PREMULTIPLIED || quint64(h.stride) < quint64(h.width) * 4)
+            return false;
+        if (kPixelHeaderSize + quint64(h.stride) * h.height > quint64(blob.size()))
+            return false;
+
+        if (out)
+            *out = h;
+        return true;
     }
 
     QByteArray& Writer::buffer() { return buf; }
+    const QByteArray& Writer::buffer() const { return buf; }
     int Writer::pos() const { return buf.size(); }
 
     void Writer::Raw(const char* p, int n) { buf.append(p, n); }
@@ -43,11 +221,22 @@ namespace uibin
 
     void Writer::I64(qint64 v) { U64(quint64(v)); }
 
+    void Writer::F32(float v)
+    {
+        quint32 q; std::memcpy(&q,&v,4); U32(q);
+    }
+
     void Writer::F64(double v)
     {
         quint64 q; std::memcpy(&q,&v,8); U64(q);
     }
 
+    void Writer::Align(int n)
+    {
+        const int pad = (n - int(buf.size() % n)) % n;
+        buf.append(pad, '\0');
+    }
+
     void Writer::PatchU32(int at, quint32 v)
     {
         buf[at+0]=char(v); buf[at+1]=char(v>>8);
@@ -96,14 +285,36 @@ namespace uibin
 
     qint64 Reader::I64() { return qint64(U64()); }
 
+    float Reader::F32()
+    {
+        quint32 q=U32(); float v; std::memcpy(&v,&q,4); return v;
+    }
+
     double Reader::F64()
     {
         quint64 q=U64(); double v; std::memcpy(&v,&q,8); return v;
     }
 
+    void Reader::Skip(int n)
+    {
+        if (n<0 || cur+n>size){bad=true;return;}
+        cur+=n;
+    }
+
+    void Reader::Align(int n)
+    {
+        Skip((n - cur % n) % n);
+    }
+
     QByteArray Reader::Bytes(int n)
     {
         if (n<0 || cur+n>size){bad=true;return QByteArray();}
         QByteArray b(data+cur, n); cur+=n; return b;
     }
+
+    QByteArrayView Reader::View(int n)
+    {
+        if (n<0 || cur+n>size){bad=true;return QByteArrayView();}
+        QByteArrayView v(data+cur, n); cur+=n; return v;
+    }
 }
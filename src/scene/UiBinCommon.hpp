@@ -2,8 +2,10 @@
 #define SCENE_UIBINCOMMON_HPP
 
 #include <QByteArray>
+#include <QByteArrayView>
 #include <QString>
 #include <cstring>
+#include <functional>
 
 // ===========================================================================
 //  .uibin v4 shared primitives
@@ -22,7 +24,14 @@
 //    Header (32 bytes, fixed, NOT masked)
 //    String table   : interned UTF-8, referenced everywhere by u32 id
 //    Asset table    : (domainStrId, registryStrId, dataLen, raw bytes)
-//    Element tree   : pre-order; components carry type-tagged TLV fields
+//    Element tree   : pre-order; components carry type-tagged TLV fields,
+//                     or packed values laid out by a shared schema
+//
+//  v5 is an opt-in ALIGNED profile of the same model for memory-mapped,
+//  zero-copy loading: 8-byte aligned sections and records, naturally aligned
+//  scalars, an O(1) string index, asset records that point at blobs aligned
+//  to kAssetAlignment (or the page size), and masking that may be disabled
+//  per bake (flag kFlagMasked). Both versions share the tags below.
 // ===========================================================================
 
 namespace uibin
@@ -32,6 +41,103 @@ namespace uibin
     static const quint16 kVersion = 4;
     static const quint32 kHeaderSize = 32;
 
+    // v5 aligned profile. Same 32-byte header shape as v4; flags bit 0 says
+    // whether the body is masked.
+    static const char    kMagicV5[4] = { 'U', 'I', 'B', '5' };
+    static const quint16 kVersionV5 = 5;
+    static const quint16 kFlagMasked = 0x0001;      // v5 only; v4 is always masked
+    static const quint16 kFlagAssetCodecs = 0x0002; // asset records carry a codec (v4 and v5)
+    static const quint16 kFlagExtensions = 0x0004;  // extension directory follows the header
+    static const quint16 kFlagSchemas = 0x0008;     // component schema table precedes the strings
+    static const quint16 kFlagSubtreeSizes = 0x0010; // child counts carry the children's byte size
+    static const quint32 kSectionAlignment = 8;     // sections and tree records
+    static const quint32 kAssetAlignment = 64;      // default blob alignment
+    static const quint32 kStringIndexEntrySize = 8; // u32 offset, u32 length
+    static const quint32 kAssetRecordSizeV5 = 16;   // domain, registry, offset, length
+    static const quint32 kAssetRecordSizeV5Codecs = 24; // + codec, reserved, raw length
+
+    // Extension sections. Optional data a loader may ignore (atlas placements,
+    // pre-baked tables, indexes) lives in tagged sections. With
+    // kFlagExtensions the header is followed by a directory: u32 count, then
+    // count x (char[4] tag, u32 offset, u32 length), zero-padded to 8 bytes;
+    // the string table starts after it. Unknown tags are skipped.
+    static const quint32 kExtensionEntrySize = 12;
+    static const char kExtAtlas[4] = { 'A', 'T', 'L', 'S' };     // atlas placements
+    static const quint32 kAtlasEntrySize = 16;
+    static const char kExtGlyphs[4] = { 'G', 'L', 'Y', 'F' };    // baked glyph atlases
+    static const quint32 kGlyphHeaderSize = 16;
+    static const quint32 kGlyphFaceSize = 40;
+    static const quint32 kGlyphEntrySize = 28;
+    static const quint32 kKernEntrySize = 12;
+    static const char kExtTextRuns[4] = { 'T', 'R', 'U', 'N' };  // pre-shaped text runs
+    static const quint32 kTextRunHeaderSize = 8;
+    static const quint32 kTextRunSize = 32;
+    static const quint32 kTextRunGlyphSize = 16;
+    static const char kExtLayout[4] = { 'L', 'A', 'Y', 'T' };    // pre-resolved layout
+    static const quint32 kLayoutHeaderSize = 8;
+    static const quint32 kLayoutTargetSize = 8;
+    static const quint32 kLayoutNodeSize = 40;
+    static const char kExtStringLookup[4] = { 'S', 'T', 'R', 'H' }; // string hash index
+    static const quint32 kStringLookupHeaderSize = 8;
+    static const quint32 kStringLookupSlotSize = 4;
+    static const char kExtElementIndex[4] = { 'E', 'I', 'D', 'X' }; // UUID-sorted element index
+    static const quint32 kElementIndexHeaderSize = 8;
+    static const quint32 kElementIndexEntrySize = 32;
+    static const char kExtScenes[4] = { 'S', 'C', 'N', 'S' };    // bundle scene directory
+    static const quint32 kSceneDirectoryHeaderSize = 8;
+    static const quint32 kSceneEntrySize = 16;
+
+    // Component schemas. With kFlagSchemas a table follows the header (and
+    // the extension directory, if any): u32 count, then per schema u32 type
+    // string id, u16 field count, u16 values size and count x (u32 name id,
+    // u8 tag, u8 reserved, u16 value offset), zero-padded to 8 bytes. A
+    // component record whose field count reads kSchemaRecord is followed by
+    // a u32 schema id (v5: after a reserved u16) and then only the values,
+    // each at its schema offset. Other records keep the TLV field form.
+    static const quint16 kSchemaRecord = 0xFFFF;
+    static const quint32 kSchemaHeaderSize = 8;
+    static const quint32 kSchemaFieldSize = 8;
+
+    // Delta patches between two bakes (.uibinpatch, uibin_patch_spec.txt).
+    // A 32-byte clear header - magic, u16 version, u16 flags, u64 base and
+    // target file hashes, u32 op count, u32 file size - then a body masked
+    // like a v4 body: patch strings, patch assets and the ops in apply order.
+    static const char    kPatchMagic[4] = { 'U', 'I', 'B', 'P' };
+    static const quint16 kPatchVersion = 1;
+    static const quint32 kPatchHeaderSize = 32;
+
+    enum PatchOp : quint8
+    {
+        OP_ADD        = 1,   // parent UUID, new subtree
+        OP_MOVE       = 2,   // UUID, new parent UUID (appended)
+        OP_REMOVE     = 3,   // UUID (with its subtree)
+        OP_ORDER      = 4,   // parent UUID, every child UUID in order
+        OP_NAME       = 5,   // UUID, name
+        OP_COMPONENTS = 6,   // UUID, full component list
+        OP_FIELDS     = 7    // UUID, component index, changed fields
+    };
+
+    // Live-link frames (uibin_patch_spec.txt section 6): the editor pushes
+    // whole bakes or patches to connected runtimes over a local socket and
+    // each runtime acknowledges what it now holds. A 40-byte header - magic,
+    // u8 kind, 3 reserved bytes, u32 sequence, u64 bake hash, i64 edit and
+    // send wall clocks (ms since the epoch), u32 payload length - then the
+    // payload, unmasked (a bake or patch masks itself).
+    static const char    kLiveLinkMagic[4] = { 'U', 'I', 'L', 'L' };
+    static const quint32 kLiveLinkHeaderSize = 40;
+    static const quint32 kLiveLinkMaxPayload = 0x40000000;  // 1 GiB
+    static const char    kLiveLinkServerName[] = "UIMaker2LiveLink";
+
+    enum LiveLinkKind : quint8
+    {
+        LINK_FULL  = 1,   // payload: a .uibin
+        LINK_PATCH = 2,   // payload: a .uibinpatch
+        LINK_ACK   = 3    // payload: compact JSON status from the runtime
+    };
+
+    // Rounds v up to a multiple of a (a power of two).
+    inline quint32 AlignUp(quint32 v, quint32 a) { return (v + a - 1) & ~(a - 1); }
+
     // Cosmetic obfuscation. Every byte AFTER the 32-byte header is XORed with
     // a position-coupled LCG stream so a hex dump of a baked file looks like
     // noise (no readable component names, no PNG signatures, etc.). The header
@@ -41,11 +147,36 @@ namespace uibin
     // sole purpose is to keep the bytes from being eyeball-readable. Writer
     // and reader call this same function over the same byte range; XOR is
     // self-inverse so one direction encodes and the other decodes.
-    void Obfuscate(char* data, int n);
+    //
+    // streamOffset is the position of data[0] within the masked stream (0 =
+    // first byte after the header), so a body can be (de)masked in pieces.
+    // The LCG is advanced in closed form to any position (affine jump-ahead),
+    // which lets large buffers be split into blocks that are masked on
+    // several threads with a lane-parallel inner loop; the output is
+    // byte-identical to the serial generator.
+    void Obfuscate(char* data, int n, quint64 streamOffset = 0);
+
+    // Calls fn(0) .. fn(count - 1), spread over the calling thread and any
+    // idle QThreadPool::globalInstance() threads, and returns when all calls
+    // are done. Never queues work, so it is safe to call from a pool thread.
+    void ParallelFor(int count, const std::function<void(int)>& fn);
+
+    // Stable 64-bit content hash (FNV-1a). Unlike qHash it is not randomly
+    // seeded, so values are identical across processes and runs and may be
+    // persisted. Pass a previous result as seed to hash several pieces as one
+    // stream.
+    static const quint64 kHashSeed = 0xCBF29CE484222325ull;
+    quint64 Hash64(const char* data, qsizetype n, quint64 seed = kHashSeed);
 
     // No-asset sentinel for an ASSET_REF field.
     static const quint32 kNoAsset = 0xFFFFFFFFu;
 
+    // No-string sentinel: a lookup miss, or an empty STRH slot.
+    static const quint32 kNoString = 0xFFFFFFFFu;
+
+    // No-element sentinel: the parent index of the root in EIDX.
+    static const quint32 kNoElement = 0xFFFFFFFFu;
+
     // Field type tags (1 byte) used inside component records.
     enum FieldTag : quint8
     {
@@ -60,11 +191,48 @@ namespace uibin
         TAG_POINT     = 8    // f64 x, f64 y
     };
 
+    // Asset blob encodings (u8), present when the header has kFlagAssetCodecs.
+    enum AssetCodec : quint8
+    {
+        CODEC_STORED = 0,    // raw file bytes
+        CODEC_ZLIB   = 1,    // qCompress framing: u32 BE raw length + zlib stream
+        CODEC_PIXELS = 2,    // PixelHeader + decoded pixel rows, stored as-is
+        CODEC_SHARED = 3     // u32 index of an earlier, unshared record whose
+                             // blob this record uses (raw length is the owner's)
+    };
+
+    // CODEC_PIXELS blobs start with a 16-byte header: u32 width, u32 height,
+    // u32 stride (bytes per row), u16 PixelFormat, u16 reserved. The rows
+    // follow at offset 16, so they keep the blob's alignment.
+    static const quint32 kPixelHeaderSize = 16;
+
+    enum PixelFormat : quint16
+    {
+        PIXELS_RGBA8_PREMULTIPLIED = 1   // bytes R,G,B,A; colour premultiplied by alpha
+    };
+
+    struct PixelHeader
+    {
+        quint32 width = 0;
+        quint32 height = 0;
+        quint32 stride = 0;
+        quint16 format = 0;
+    };
+
+    // Parses a CODEC_PIXELS blob header. Returns false for an unknown format,
+    // a stride shorter than a row, or rows that run past the blob.
+    bool ReadPixelHeader(QByteArrayView blob, PixelHeader* out);
+
+    // Value width in bytes for a tag (before any v5 padding), or -1 for an
+    // unknown tag whose width cannot be known.
+    int TagWidth(quint8 tag);
+
     // ----- Writer: append-only, little-endian -----------------------------
     class Writer
     {
     public:
         QByteArray& buffer();
+        const QByteArray& buffer() const;
         int pos() const;
 
         void Raw(const char* p, int n);
@@ -74,8 +242,12 @@ namespace uibin
         void I32(qint32 v);
         void U64(quint64 v);
         void I64(qint64 v);
+        void F32(float v);
         void F64(double v);
 
+        // Zero-pad to a multiple of n bytes from the start of the buffer.
+        void Align(int n);
+
         // Patch a previously reserved u32 (for back-filled offsets/sizes).
         void PatchU32(int at, quint32 v);
 
@@ -100,10 +272,18 @@ namespace uibin
         qint32 I32();
         quint64 U64();
         qint64 I64();
+        float F32();
         double F64();
 
+        // Skip n bytes / advance to a multiple of n from the start of data.
+        void Skip(int n);
+        void Align(int n);
+
         QByteArray Bytes(int n);
 
+        // Like Bytes, but returns a view into the underlying data (no copy).
+        QByteArrayView View(int n);
+
     private:
         const char* data;
         int size;
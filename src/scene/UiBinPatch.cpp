@@ -0,0 +1,1034 @@
+#include "scene/UiBinPatch.hpp"
+#include "scene/UiBinCommon.hpp"
+#include "scene/UiBinView.hpp"
+#include "scene/UiBinAssetResolver.hpp"
+#include "core/UiElement.hpp"
+#include "core/Component.hpp"
+
+#include <QColor>
+#include <QHash>
+#include <QPointF>
+#include <QSet>
+#include <QtEndian>
+#include <QUuid>
+#include <QVariant>
+#include <QVector>
+
+#include <cstring>
+
+using namespace uibin;
+
+namespace
+{
+    bool Fail(QString* error, const char* msg)
+    {
+        if (error) *error = QString::fromLatin1(msg);
+        return false;
+    }
+
+    // =======================================================================
+    //  Diff side: both bakes flattened into plain per-element records
+    // =======================================================================
+
+    struct Field
+    {
+        QByteArray name;
+        quint8 tag = TAG_NONE;
+        QByteArray key;             // value as content: text, asset identity + bytes
+        const char* value = nullptr;
+    };
+
+    struct Comp
+    {
+        QByteArray type;
+        QVector<Field> fields;
+    };
+
+    struct Elem
+    {
+        QByteArray uuid;
+        QByteArray name;
+        int parent = -1;
+        QVector<int> children;
+        QVector<Comp> comps;
+    };
+
+    struct Tree
+    {
+        QByteArray bytes;           // demasked copy
+        UiBinView view;
+        QVector<Elem> elems;        // pre-order, root first
+        QHash<QByteArray, int> byUuid;
+
+        // Content key of an asset: identity, codec and a hash of the stored
+        // bytes, so equal keys in two bakes mean the same blob. A shared
+        // record keys on the blob it uses, not on its owner index.
+        QByteArray AssetKey(quint32 index) const
+        {
+            if (index >= view.AssetCount())
+                return QByteArray();
+
+            const UiBinView::Asset a = view.ResolvedAssetAt(index);
+            QByteArray key = view.String(a.domainId).toByteArray();
+            key += char(0x1F);
+            key += view.String(a.registryId).toByteArray();
+            key += char(0x1F);
+            key += char(a.codec);
+            const quint64 h = Hash64(a.data.data(), a.data.size());
+            key.append(reinterpret_cast<const char*>(&h), 8);
+            return key;
+        }
+
+        bool Load(const QByteArray& file, QString* error)
+        {
+            bytes = file;
+            bytes.detach();
+            if (UiBinView::IsMasked(bytes))
+                UiBinView::Demask(bytes.data(), bytes.size());
+
+            if (!view.Open(bytes, error))
+                return false;
+
+            // Ops address one tree; a bundle's other scenes would be lost.
+            if (!view.Extension(kExtScenes).isEmpty())
+            {
+                if (error) *error = QStringLiteral("multi-scene bundles cannot be patched");
+                return false;
+            }
+
+            QVector<int> path;          // open ancestors by depth
+            UiBinView::ElementCursor el = view.Elements();
+            while (el.Next())
+            {
+                Elem e;
+                e.uuid = el.Uuid().toByteArray();
+                e.name = view.String(el.NameId()).toByteArray();
+
+                path.resize(el.Depth() + 1);
+                e.parent = el.Depth() > 0 ? path[el.Depth() - 1] : -1;
+                path[el.Depth()] = int(elems.size());
+
+                UiBinView::ComponentCursor comp = el.Components();
+                while (comp.Next())
+                {
+                    Comp c;
+                    c.type = view.String(comp.TypeId()).toByteArray();
+
+                    UiBinView::FieldCursor field = comp.Fields();
+                    while (field.Next())
+                    {
+                        const UiBinView::Field& fv = field.Get();
+                        Field f;
+                        f.name = view.String(fv.nameId).toByteArray();
+                        f.tag = fv.tag;
+                        f.value = fv.value;
+                        f.key = QByteArray(1, char(fv.tag));
+                        if (fv.tag == TAG_STRING)
+                            f.key += view.String(fv.U32()).toByteArray();
+                        else if (fv.tag == TAG_ASSET_REF)
+                            f.key += AssetKey(fv.U32());
+                        else
+                            f.key += QByteArray(fv.value, qMax(0, TagWidth(fv.tag)));
+                        c.fields.push_back(f);
+                    }
+                    e.comps.push_back(c);
+                }
+
+                const int index = int(elems.size());
+                if (byUuid.contains(e.uuid))
+                    return Fail(error, "duplicate element UUID");
+                byUuid.insert(e.uuid, index);
+                if (e.parent >= 0)
+                    elems[e.parent].children.push_back(index);
+                elems.push_back(e);
+            }
+
+            if (!el.AtEnd() || elems.isEmpty())
+                return Fail(error, "structural decode failed");
+            return true;
+        }
+    };
+
+    // Field names in order; components whose names differ are replaced whole.
+    bool SameShape(const Comp& a, const Comp& b)
+    {
+        if (a.type != b.type || a.fields.size() != b.fields.size())
+            return false;
+        for (int i = 0; i < a.fields.size(); ++i)
+            if (a.fields[i].name != b.fields[i].name || a.fields[i].tag != b.fields[i].tag)
+                return false;
+        return true;
+    }
+
+    // Builds the patch body: its own string and asset tables plus the ops,
+    // every value in v4 TLV form against those tables.
+    class PatchEncoder
+    {
+    public:
+        PatchEncoder(const Tree& base, const Tree& target) : base(base), target(target)
+        {
+            for (quint32 i = 0; i < base.view.AssetCount(); ++i)
+                baseAssets.insert(base.AssetKey(i));
+        }
+
+        Writer ops;
+        int opCount = 0;
+
+        void Uuid(const QByteArray& uuid) { ops.Raw(uuid.constData(), 16); }
+
+        quint32 Str(const QByteArray& s)
+        {
+            auto it = stringIndex.constFind(s);
+            if (it != stringIndex.constEnd())
+                return it.value();
+
+            const quint32 id = quint32(strings.size());
+            strings.push_back(s);
+            stringIndex.insert(s, id);
+            return id;
+        }
+
+        // A target asset as a patch asset; bytes travel only when the base
+        // has no identical blob.
+        quint32 Asset(quint32 index)
+        {
+            if (index == kNoAsset || index >= target.view.AssetCount())
+                return kNoAsset;
+
+            const QByteArray key = target.AssetKey(index);
+            auto it = assetIndex.constFind(key);
+            if (it != assetIndex.constEnd())
+                return it.value();
+
+            // Patch assets are self-contained: a shared record travels with
+            // its owner's bytes and codec.
+            const UiBinView::Asset a = target.view.ResolvedAssetAt(index);
+            Writer w;
+            w.U32(Str(target.view.String(a.domainId).toByteArray()));
+            w.U32(Str(target.view.String(a.registryId).toByteArray()));
+            const bool withBytes = !baseAssets.contains(key);
+            w.U8(withBytes ? 1 : 0);
+            w.U8(a.codec);
+            w.U32(a.rawLength);
+            w.U32(withBytes ? quint32(a.data.size()) : 0);
+            if (withBytes)
+                w.Raw(a.data.data(), int(a.data.size()));
+
+            const quint32 id = quint32(assets.size());
+            assets.push_back(w.buffer());
+            assetIndex.insert(key, id);
+            return id;
+        }
+
+        void FieldRecord(const Field& f)
+        {
+            ops.U32(Str(f.name));
+            ops.U8(f.tag);
+            if (f.tag == TAG_STRING)
+                ops.U32(Str(target.view.String(qFromLittleEndian<quint32>(f.value)).toByteArray()));
+            else if (f.tag == TAG_ASSET_REF)
+                ops.U32(Asset(qFromLittleEndian<quint32>(f.value)));
+            else
+                ops.Raw(f.value, qMax(0, TagWidth(f.tag)));
+        }
+
+        void ComponentRecord(const Comp& c)
+        {
+            ops.U32(Str(c.type));
+            const int lenAt = ops.pos();
+            ops.U32(0);
+            ops.U16(quint16(c.fields.size()));
+            for (const Field& f : c.fields)
+                FieldRecord(f);
+            ops.PatchU32(lenAt, quint32(ops.pos() - lenAt - 4));
+        }
+
+        // A new element with its new descendants; kept descendants are
+        // brought in by MOVE ops.
+        void ElementRecord(int e)
+        {
+            const Elem& el = target.elems[e];
+            ops.U32(Str(el.name));
+            Uuid(el.uuid);
+            ops.U16(quint16(el.comps.size()));
+            for (const Comp& c : el.comps)
+                ComponentRecord(c);
+
+            QVector<int> fresh;
+            for (int c : el.children)
+                if (!base.byUuid.contains(target.elems[c].uuid))
+                    fresh.push_back(c);
+
+            ops.U32(quint32(fresh.size()));
+            for (int c : fresh)
+                ElementRecord(c);
+        }
+
+        QByteArray Body() const
+        {
+            Writer w;
+            w.U32(quint32(strings.size()));
+            for (const QByteArray& s : strings)
+            {
+                w.U32(quint32(s.size()));
+                w.Raw(s.constData(), int(s.size()));
+            }
+
+            w.U32(quint32(assets.size()));
+            for (const QByteArray& a : assets)
+                w.Raw(a.constData(), int(a.size()));
+
+            w.Raw(ops.buffer().constData(), ops.pos());
+            return w.buffer();
+        }
+
+    private:
+        const Tree& base;
+        const Tree& target;
+        QSet<QByteArray> baseAssets;
+
+        QVector<QByteArray> strings;
+        QHash<QByteArray, quint32> stringIndex;
+        QVector<QByteArray> assets;
+        QHash<QByteArray, quint32> assetIndex;
+    };
+
+    // =======================================================================
+    //  Apply side: the patch parsed into plain ops before anything changes
+    // =======================================================================
+
+    struct PatchAsset
+    {
+        QString domain;
+        QString registry;
+        bool hasBytes = false;
+        quint8 codec = CODEC_STORED;
+        quint32 rawLength = 0;
+        QByteArray bytes;
+    };
+
+    struct PatchField
+    {
+        QByteArray name;            // Latin-1 property name
+        quint8 tag = TAG_NONE;
+        QVariant value;
+        quint32 asset = kNoAsset;
+    };
+
+    struct PatchComp
+    {
+        QString type;
+        QVector<PatchField> fields;
+    };
+
+    struct PatchElem
+    {
+        QString name;
+        QUuid id;
+        QVector<PatchComp> comps;
+        QVector<PatchElem> children;
+    };
+
+    struct Op
+    {
+        quint8 kind = 0;
+        QUuid id;
+        QUuid parent;
+        QString name;
+        quint16 component = 0;
+        QString type;               // FIELDS: expected component type
+        QVector<QUuid> order;
+        QVector<PatchComp> comps;   // COMPONENTS; FIELDS: one entry
+        PatchElem subtree;          // ADD
+    };
+
+    struct Parsed
+    {
+        QVector<QString> strings;
+        QVector<PatchAsset> assets;
+        QVector<Op> ops;
+
+        QString Str(quint32 id) const { return id < quint32(strings.size()) ? strings[int(id)] : QString(); }
+    };
+
+    QUuid ReadUuid(Reader& r)
+    {
+        return QUuid::fromRfc4122(r.View(16));
+    }
+
+    bool ReadField(Reader& r, const Parsed& p, PatchField* f)
+    {
+        f->name = p.Str(r.U32()).toLatin1();
+        f->tag = r.U8();
+        switch (f->tag)
+        {
+        case TAG_NONE:                                        break;
+        case TAG_BOOL:   f->value = bool(r.U8());             break;
+        case TAG_INT32:  f->value = int(r.I32());             break;
+        case TAG_INT64:  f->value = qlonglong(r.I64());       break;
+        case TAG_DOUBLE: f->value = r.F64();                  break;
+        case TAG_STRING: f->value = p.Str(r.U32());           break;
+        case TAG_COLOR:  f->value = QColor::fromRgba(QRgb(r.U32())); break;
+        case TAG_POINT:  { const double x = r.F64(); const double y = r.F64(); f->value = QPointF(x, y); break; }
+        case TAG_ASSET_REF:
+            f->asset = r.U32();
+            if (f->asset != kNoAsset && f->asset >= quint32(p.assets.size()))
+                return false;
+            break;
+        default:         return false;
+        }
+        return r.ok();
+    }
+
+    bool ReadComponent(Reader& r, const Parsed& p, PatchComp* c)
+    {
+        c->type = p.Str(r.U32());
+        const quint32 payloadLen = r.U32();
+        const qint64 end = qint64(r.pos()) + payloadLen;
+        const quint16 count = r.U16();
+        for (quint16 i = 0; i < count && r.ok(); ++i)
+        {
+            PatchField f;
+            if (!ReadField(r, p, &f))
+                return false;
+            c->fields.push_back(f);
+        }
+        return r.ok() && r.pos() == end;
+    }
+
+    bool ReadElement(Reader& r, const Parsed& p, PatchElem* e, int depth)
+    {
+        // Patches come from untrusted pipes; bound the recursion.
+        if (depth > 4096)
+            return false;
+
+        e->name = p.Str(r.U32());
+        e->id = ReadUuid(r);
+        const quint16 comps = r.U16();
+        for (quint16 i = 0; i < comps && r.ok(); ++i)
+        {
+            PatchComp c;
+            if (!ReadComponent(r, p, &c))
+                return false;
+            e->comps.push_back(c);
+        }
+
+        const quint32 children = r.U32();
+        for (quint32 i = 0; i < children && r.ok(); ++i)
+        {
+            PatchElem c;
+            if (!ReadElement(r, p, &c, depth + 1))
+                return false;
+            e->children.push_back(c);
+        }
+        return r.ok();
+    }
+
+    bool Parse(const QByteArray& patch, Parsed* out, QString* error)
+    {
+        if (patch.size() < qsizetype(kPatchHeaderSize) || std::memcmp(patch.constData(), kPatchMagic, 4) != 0)
+            return Fail(error, "not a .uibinpatch");
+
+        Reader hr(patch.constData(), int(kPatchHeaderSize));
+        hr.seek(4);
+        if (hr.U16() != kPatchVersion)
+            return Fail(error, "unsupported patch version");
+        hr.U16();
+        hr.U64();
+        hr.U64();
+        const quint32 opCount = hr.U32();
+        if (hr.U32() != quint32(patch.size()))
+            return Fail(error, "patch size mismatch (truncated or corrupt)");
+
+        QByteArray body = patch.mid(kPatchHeaderSize);
+        Obfuscate(body.data(), int(body.size()));
+
+        Reader r(body.constData(), int(body.size()));
+
+        const quint32 strCount = r.U32();
+        for (quint32 i = 0; i < strCount && r.ok(); ++i)
+            out->strings.push_back(QString::fromUtf8(r.View(int(r.U32()))));
+
+        const quint32 assetCount = r.U32();
+        for (quint32 i = 0; i < assetCount && r.ok(); ++i)
+        {
+            PatchAsset a;
+            a.domain = out->Str(r.U32());
+            a.registry = out->Str(r.U32());
+            a.hasBytes = r.U8() != 0;
+            a.codec = r.U8();
+            a.rawLength = r.U32();
+            a.bytes = r.Bytes(int(r.U32()));
+            out->assets.push_back(a);
+        }
+
+        for (quint32 i = 0; i < opCount && r.ok(); ++i)
+        {
+            Op op;
+            op.kind = r.U8();
+            switch (op.kind)
+            {
+            case OP_ADD:
+                op.parent = ReadUuid(r);
+                if (!ReadElement(r, *out, &op.subtree, 0))
+                    return Fail(error, "bad ADD record");
+                break;
+            case OP_MOVE:
+                op.id = ReadUuid(r);
+                op.parent = ReadUuid(r);
+                break;
+            case OP_REMOVE:
+                op.id = ReadUuid(r);
+                break;
+            case OP_ORDER:
+            {
+                op.parent = ReadUuid(r);
+                const quint32 n = r.U32();
+                for (quint32 c = 0; c < n && r.ok(); ++c)
+                    op.order.push_back(ReadUuid(r));
+                break;
+            }
+            case OP_NAME:
+                op.id = ReadUuid(r);
+                op.name = out->Str(r.U32());
+                break;
+            case OP_COMPONENTS:
+            {
+                op.id = ReadUuid(r);
+                const quint16 n = r.U16();
+                for (quint16 c = 0; c < n && r.ok(); ++c)
+                {
+                    PatchComp comp;
+                    if (!ReadComponent(r, *out, &comp))
+                        return Fail(error, "bad COMPONENTS record");
+                    op.comps.push_back(comp);
+                }
+                break;
+            }
+            case OP_FIELDS:
+            {
+                op.id = ReadUuid(r);
+                op.component = r.U16();
+                PatchComp comp;
+                if (!ReadComponent(r, *out, &comp))
+                    return Fail(error, "bad FIELDS record");
+                op.type = comp.type;
+                op.comps.push_back(comp);
+                break;
+            }
+            default:
+                return Fail(error, "unknown patch op");
+            }
+        }
+
+        if (!r.ok() || !r.atEnd())
+            return Fail(error, "structural decode failed");
+        return true;
+    }
+
+    // As UiBinReader applies a decoded field: an asset reference restores
+    // the engine identity, anything else is set by name.
+    void ApplyField(Component* comp, const Parsed& p, const PatchField& f)
+    {
+        if (f.tag == TAG_ASSET_REF)
+        {
+            if (f.asset != kNoAsset)
+            {
+                const PatchAsset& a = p.assets[int(f.asset)];
+                comp->setProperty("assetDomain", a.domain);
+                comp->setProperty("assetRegistryValue", a.registry);
+            }
+        }
+        else if (f.value.isValid())
+        {
+            comp->setProperty(f.name.constData(), f.value);
+        }
+    }
+
+    void CreateComponents(UiElement* el, const Parsed& p, const QVector<PatchComp>& comps)
+    {
+        for (const PatchComp& c : comps)
+        {
+            Component* comp = Component::Create(c.type, el);
+            if (!comp)
+                continue;
+            for (const PatchField& f : c.fields)
+                ApplyField(comp, p, f);
+        }
+    }
+
+    UiElement* CreateSubtree(const PatchElem& e, UiElement* parent, const Parsed& p, QHash<QUuid, UiElement*>& byId)
+    {
+        auto* el = new UiElement(e.name, parent);
+        el->SetId(e.id);
+        byId.insert(e.id, el);
+
+        CreateComponents(el, p, e.comps);
+        for (const PatchElem& c : e.children)
+            CreateSubtree(c, el, p, byId);
+        return el;
+    }
+
+    void IndexTree(UiElement* el, QHash<QUuid, UiElement*>& byId)
+    {
+        byId.insert(el->GetId(), el);
+        for (QObject* o : el->children())
+            if (auto* c = qobject_cast<UiElement*>(o))
+                IndexTree(c, byId);
+    }
+
+    void UnindexTree(UiElement* el, QHash<QUuid, UiElement*>& byId)
+    {
+        byId.remove(el->GetId());
+        for (QObject* o : el->children())
+            if (auto* c = qobject_cast<UiElement*>(o))
+                UnindexTree(c, byId);
+    }
+
+    // The component types CreateComponents leaves on an element.
+    QStringList CreatedTypes(const QVector<PatchComp>& comps)
+    {
+        QStringList types;
+        for (const PatchComp& c : comps)
+            if (Component::Registry().contains(c.type))
+                types.append(c.type);
+        return types;
+    }
+
+    // The tree's shape as the ops seen so far leave it, so Apply can check
+    // each op against the state it will actually run on: ids a REMOVE
+    // dropped (with their subtrees), component lists a COMPONENTS replaced,
+    // ids an ADD introduced.
+    class ShadowTree
+    {
+    public:
+        explicit ShadowTree(UiElement* root) : rootId(root->GetId()) { Index(root, QUuid()); }
+
+        bool Live(const QUuid& id) const { return parentOf.contains(id); }
+        bool IsRoot(const QUuid& id) const { return id == rootId; }
+
+        // True if el is anc or one of its descendants.
+        bool Within(const QUuid& el, const QUuid& anc) const
+        {
+            for (QUuid e = el; Live(e); e = parentOf.value(e))
+                if (e == anc)
+                    return true;
+            return false;
+        }
+
+        // False if any id in the subtree is already live.
+        bool Add(const PatchElem& e, const QUuid& parent)
+        {
+            if (Live(e.id))
+                return false;
+            Insert(e.id, parent);
+            types.insert(e.id, CreatedTypes(e.comps));
+            for (const PatchElem& c : e.children)
+                if (!Add(c, e.id))
+                    return false;
+            return true;
+        }
+
+        void Move(const QUuid& id, const QUuid& parent)
+        {
+            children[parentOf.value(id)].removeOne(id);
+            Insert(id, parent);
+        }
+
+        void Remove(const QUuid& id)
+        {
+            children[parentOf.value(id)].removeOne(id);
+            Drop(id);
+        }
+
+        QStringList& Types(const QUuid& id) { return types[id]; }
+
+    private:
+        void Index(UiElement* el, const QUuid& parent)
+        {
+            Insert(el->GetId(), parent);
+            QStringList& t = types[el->GetId()];
+            for (Component* c : el->GetComponents())
+                t.append(c->GetTypeName());
+            for (QObject* o : el->children())
+                if (auto* c = qobject_cast<UiElement*>(o))
+                    Index(c, el->GetId());
+        }
+
+        void Insert(const QUuid& id, const QUuid& parent)
+        {
+            parentOf.insert(id, parent);
+            children[parent].append(id);
+        }
+
+        void Drop(const QUuid& id)
+        {
+            for (const QUuid& c : children.take(id))
+                Drop(c);
+            parentOf.remove(id);
+            types.remove(id);
+        }
+
+        QUuid rootId;
+        QHash<QUuid, QUuid> parentOf;
+        QHash<QUuid, QVector<QUuid>> children;
+        QHash<QUuid, QStringList> types;
+    };
+}
+
+// ---------------------------------------------------------------------------
+// Diff
+// ---------------------------------------------------------------------------
+
+QByteArray UiBinPatch::Diff(const QByteArray& baseBytes, const QByteArray& targetBytes, QString* error)
+{
+    Tree base;
+    Tree target;
+    if (!base.Load(baseBytes, error) || !target.Load(targetBytes, error))
+        return QByteArray();
+
+    if (base.elems.first().uuid != target.elems.first().uuid)
+    {
+        Fail(error, "the bakes have different root elements");
+        return QByteArray();
+    }
+
+    PatchEncoder enc(base, target);
+    Writer& w = enc.ops;
+
+    auto inBase = [&base](const Elem& e) { return base.byUuid.contains(e.uuid); };
+    auto baseOf = [&base](const Elem& e) -> const Elem& { return base.elems[base.byUuid.value(e.uuid)]; };
+    auto parentUuid = [](const Tree& t, const Elem& e) { return e.parent >= 0 ? t.elems[e.parent].uuid : QByteArray(); };
+
+    // Child UUIDs each target element will have once ADD and MOVE ran, in
+    // the order the applier produces them, to find where ORDER is needed.
+    QHash<QByteArray, QVector<QByteArray>> simulated;
+
+    // Kept children that stay put come first, in base order.
+    for (const Elem& t : target.elems)
+    {
+        if (!inBase(t))
+            continue;
+        QVector<QByteArray>& kids = simulated[t.uuid];
+        for (int c : baseOf(t).children)
+        {
+            const Elem& bc = base.elems[c];
+            const int tc = target.byUuid.value(bc.uuid, -1);
+            if (tc >= 0 && target.elems[tc].parent >= 0 && target.elems[target.elems[tc].parent].uuid == t.uuid)
+                kids.push_back(bc.uuid);
+        }
+    }
+
+    // --- ADD: top-most new elements, with their new descendants ----------
+    for (int i = 0; i < target.elems.size(); ++i)
+    {
+        const Elem& t = target.elems[i];
+        if (inBase(t) || t.parent < 0 || !inBase(target.elems[t.parent]))
+            continue;
+
+        w.U8(OP_ADD);
+        enc.Uuid(parentUuid(target, t));
+        enc.ElementRecord(i);
+        ++enc.opCount;
+        simulated[parentUuid(target, t)].push_back(t.uuid);
+    }
+
+    // New elements hold their new children, in target order.
+    for (const Elem& t : target.elems)
+    {
+        if (inBase(t))
+            continue;
+        QVector<QByteArray>& kids = simulated[t.uuid];
+        for (int c : t.children)
+            if (!inBase(target.elems[c]))
+                kids.push_back(target.elems[c].uuid);
+    }
+
+    // --- MOVE: kept elements under a different parent (appended) ---------
+    for (const Elem& t : target.elems)
+    {
+        if (!inBase(t) || t.parent < 0)
+            continue;
+
+        const QByteArray to = parentUuid(target, t);
+        if (parentUuid(base, baseOf(t)) == to)
+            continue;
+
+        w.U8(OP_MOVE);
+        enc.Uuid(t.uuid);
+        enc.Uuid(to);
+        ++enc.opCount;
+        simulated[to].push_back(t.uuid);
+    }
+
+    // --- REMOVE: top-most base elements the target lacks -----------------
+    // After MOVE, so kept descendants have already been taken out.
+    for (const Elem& b : base.elems)
+    {
+        if (target.byUuid.contains(b.uuid) || (b.parent >= 0 && !target.byUuid.contains(base.elems[b.parent].uuid)))
+            continue;
+
+        w.U8(OP_REMOVE);
+        enc.Uuid(b.uuid);
+        ++enc.opCount;
+    }
+
+    // --- ORDER: parents whose children end up out of target order --------
+    for (const Elem& t : target.elems)
+    {
+        QVector<QByteArray> want;
+        for (int c : t.children)
+            want.push_back(target.elems[c].uuid);
+
+        if (simulated.value(t.uuid) == want)
+            continue;
+
+        w.U8(OP_ORDER);
+        enc.Uuid(t.uuid);
+        w.U32(quint32(want.size()));
+        for (const QByteArray& u : want)
+            enc.Uuid(u);
+        ++enc.opCount;
+    }
+
+    // --- NAME, COMPONENTS, FIELDS on kept elements -----------------------
+    for (const Elem& t : target.elems)
+    {
+        if (!inBase(t))
+            continue;
+        const Elem& b = baseOf(t);
+
+        if (t.name != b.name)
+        {
+            w.U8(OP_NAME);
+            enc.Uuid(t.uuid);
+            w.U32(enc.Str(t.name));
+            ++enc.opCount;
+        }
+
+        // Same component types and field names: send only changed values.
+        // Anything else - or a changed asset reference, whose identity the
+        // reader only ever adds - replaces the component list, so the
+        // result matches a fresh decode of the target.
+        bool replace = t.comps.size() != b.comps.size();
+        for (int c = 0; !replace && c < t.comps.size(); ++c)
+        {
+            replace = !SameShape(t.comps[c], b.comps[c]);
+            for (int f = 0; !replace && f < t.comps[c].fields.size(); ++f)
+                replace = t.comps[c].fields[f].tag == TAG_ASSET_REF
+                       && t.comps[c].fields[f].key != b.comps[c].fields[f].key;
+        }
+
+        if (replace)
+        {
+            w.U8(OP_COMPONENTS);
+            enc.Uuid(t.uuid);
+            w.U16(quint16(t.comps.size()));
+            for (const Comp& c : t.comps)
+                enc.ComponentRecord(c);
+            ++enc.opCount;
+            continue;
+        }
+
+        for (int c = 0; c < t.comps.size(); ++c)
+        {
+            Comp changed;
+            changed.type = t.comps[c].type;
+            for (int f = 0; f < t.comps[c].fields.size(); ++f)
+                if (t.comps[c].fields[f].key != b.comps[c].fields[f].key)
+                    changed.fields.push_back(t.comps[c].fields[f]);
+
+            if (changed.fields.isEmpty())
+                continue;
+
+            w.U8(OP_FIELDS);
+            enc.Uuid(t.uuid);
+            w.U16(quint16(c));
+            enc.ComponentRecord(changed);
+            ++enc.opCount;
+        }
+    }
+
+    QByteArray body = enc.Body();
+    Obfuscate(body.data(), int(body.size()));
+
+    Writer hdr;
+    hdr.Raw(kPatchMagic, 4);
+    hdr.U16(kPatchVersion);
+    hdr.U16(0);
+    hdr.U64(Hash64(baseBytes.constData(), baseBytes.size()));
+    hdr.U64(Hash64(targetBytes.constData(), targetBytes.size()));
+    hdr.U32(quint32(enc.opCount));
+    hdr.U32(kPatchHeaderSize + quint32(body.size()));
+
+    return hdr.buffer() + body;
+}
+
+bool UiBinPatch::ReadHeader(const QByteArray& patch, quint64* baseHash, quint64* targetHash)
+{
+    if (patch.size() < qsizetype(kPatchHeaderSize) || std::memcmp(patch.constData(), kPatchMagic, 4) != 0)
+        return false;
+
+    Reader r(patch.constData(), int(kPatchHeaderSize));
+    r.seek(8);
+    const quint64 b = r.U64();
+    const quint64 t = r.U64();
+    if (baseHash) *baseHash = b;
+    if (targetHash) *targetHash = t;
+    return r.ok();
+}
+
+// ---------------------------------------------------------------------------
+// Apply
+// ---------------------------------------------------------------------------
+
+bool UiBinPatch::Apply(const QByteArray& patch, UiElement* root, UiBinAssetResolver* assets, QString* error)
+{
+    if (!root)
+        return Fail(error, "no tree");
+
+    Parsed p;
+    if (!Parse(patch, &p, error))
+        return false;
+
+    // --- Check every op before touching the tree -------------------------
+    // Patches come from untrusted pipes: each op is checked against the
+    // tree as the ops before it leave it, so Apply either runs them all or
+    // changes nothing.
+    ShadowTree shadow(root);
+    for (const Op& op : p.ops)
+    {
+        const bool live = shadow.Live(op.id);
+        switch (op.kind)
+        {
+        case OP_ADD:
+            if (!shadow.Live(op.parent))
+                return Fail(error, "ADD under an unknown parent");
+            if (!shadow.Add(op.subtree, op.parent))
+                return Fail(error, "ADD of an element UUID the tree already has");
+            break;
+        case OP_MOVE:
+            if (!live || shadow.IsRoot(op.id) || !shadow.Live(op.parent))
+                return Fail(error, "MOVE of an unknown element");
+            if (shadow.Within(op.parent, op.id))
+                return Fail(error, "MOVE into the element's own subtree");
+            shadow.Move(op.id, op.parent);
+            break;
+        case OP_REMOVE:
+            if (!live || shadow.IsRoot(op.id))
+                return Fail(error, "REMOVE of an unknown element");
+            shadow.Remove(op.id);
+            break;
+        case OP_ORDER:
+            if (!shadow.Live(op.parent))
+                return Fail(error, "ORDER of an unknown parent");
+            for (const QUuid& c : op.order)
+            {
+                if (!shadow.Live(c) || shadow.IsRoot(c))
+                    return Fail(error, "ORDER of an unknown child");
+                if (shadow.Within(op.parent, c))
+                    return Fail(error, "ORDER into the child's own subtree");
+                shadow.Move(c, op.parent);
+            }
+            break;
+        case OP_NAME:
+            if (!live)
+                return Fail(error, "patch names an unknown element");
+            break;
+        case OP_COMPONENTS:
+            if (!live)
+                return Fail(error, "patch names an unknown element");
+            shadow.Types(op.id) = CreatedTypes(op.comps);
+            break;
+        case OP_FIELDS:
+        {
+            if (!live)
+                return Fail(error, "patch names an unknown element");
+            const QStringList& types = shadow.Types(op.id);
+            if (op.component >= types.size() || types[op.component] != op.type)
+                return Fail(error, "FIELDS of a component the tree does not have");
+            break;
+        }
+        }
+    }
+
+    QHash<QUuid, UiElement*> byId;
+    IndexTree(root, byId);
+
+    // --- Apply, in patch order -------------------------------------------
+    for (const Op& op : p.ops)
+    {
+        switch (op.kind)
+        {
+        case OP_ADD:
+        {
+            UiElement* added = CreateSubtree(op.subtree, nullptr, p, byId);
+            if (!added->ReparentTo(byId.value(op.parent)))
+            {
+                UnindexTree(added, byId);
+                delete added;
+                return Fail(error, "ADD failed");
+            }
+            break;
+        }
+        case OP_MOVE:
+            if (!byId.value(op.id)->ReparentTo(byId.value(op.parent)))
+                return Fail(error, "MOVE failed");
+            break;
+        case OP_REMOVE:
+        {
+            UiElement* el = byId.value(op.id);
+            UnindexTree(el, byId);
+            delete el;
+            break;
+        }
+        case OP_ORDER:
+        {
+            UiElement* parent = byId.value(op.parent);
+            for (int i = 0; i < op.order.size(); ++i)
+                if (!byId.value(op.order[i])->ReparentTo(parent, i))
+                    return Fail(error, "ORDER failed");
+            break;
+        }
+        case OP_NAME:
+            byId.value(op.id)->SetName(op.name);
+            break;
+        case OP_COMPONENTS:
+        {
+            UiElement* el = byId.value(op.id);
+            for (Component* c : el->GetComponents())
+                delete c;
+            CreateComponents(el, p, op.comps);
+            emit el->ComponentListChanged(el);
+            break;
+        }
+        case OP_FIELDS:
+        {
+            Component* comp = byId.value(op.id)->GetComponents()[op.component];
+            for (const PatchField& f : op.comps.first().fields)
+                ApplyField(comp, p, f);
+            break;
+        }
+        }
+    }
+
+    if (assets)
+    {
+        for (const PatchAsset& a : p.assets)
+        {
+            if (!a.hasBytes)
+                continue;
+
+            UiBinAssetResolver::Record rec;
+            rec.domain = a.domain;
+            rec.registry = a.registry;
+            rec.length = quint32(a.bytes.size());
+            rec.rawLength = a.rawLength;
+            rec.codec = a.codec;
+            rec.bytes = a.bytes;
+            assets->records.push_back(rec);
+        }
+    }
+
+    return true;
+}
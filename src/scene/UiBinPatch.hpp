@@ -0,0 +1,42 @@
+#ifndef SCENE_UIBINPATCH_HPP
+#define SCENE_UIBINPATCH_HPP
+
+#include <QByteArray>
+#include <QString>
+
+class UiElement;
+class UiBinAssetResolver;
+
+// Binary delta between two bakes of the same scene (.uibinpatch, see
+// uibin_patch_spec.txt), keyed by element UUID, so a running instance can
+// follow an edit without reloading the whole container.
+//
+// A patch carries only what changed: removed and added subtrees, moves and
+// sibling reorders, renames, changed fields, and the strings and asset blobs
+// those need. Values are self-contained (strings by text, assets by identity
+// plus bytes when the base has no identical blob), so applying one needs
+// the tree decoded from the base bake, not the base bytes.
+class UiBinPatch
+{
+public:
+
+    // Compares two bakes (file bytes as on disk, v4 or v5, masked or not)
+    // and returns the patch that turns base's tree into target's. Returns
+    // an empty array (with an error) if either bake does not open.
+    static QByteArray Diff(const QByteArray& base, const QByteArray& target, QString* error = nullptr);
+
+    // Hashes the patch was made between (uibin::Hash64 of each bake's file
+    // bytes), so a runtime can check it holds the right base.
+    static bool ReadHeader(const QByteArray& patch, quint64* baseHash, quint64* targetHash);
+
+    // Applies a patch in place to a tree decoded from its base bake
+    // (UiBinReader::Read). The whole patch is parsed and every op checked
+    // against the tree as the ops before it leave it (removed subtrees,
+    // replaced component lists, added UUIDs, cycles) before anything
+    // changes, so on failure (false, with an error) the tree is untouched. Assets the base did not have are
+    // appended to assets when given.
+    static bool Apply(const QByteArray& patch, UiElement* root, UiBinAssetResolver* assets = nullptr,
+                      QString* error = nullptr);
+};
+
+#endif
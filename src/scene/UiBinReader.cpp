@@ -1,24 +1,70 @@
 #include "scene/UiBinReader.hpp"
 #include "scene/UiBinCommon.hpp"
+#include "scene/UiBinView.hpp"
+#include "scene/GlyphAtlas.hpp"
+#include "scene/TextRuns.hpp"
+#include "scene/ResolvedLayout.hpp"
+#include "scene/StringLookup.hpp"
+#include "scene/ElementIndex.hpp"
+#include "scene/SceneDirectory.hpp"
 #include "core/UiElement.hpp"
 #include "core/Component.hpp"
 
+#include <QBuffer>
 #include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QIODevice>
+#include <QtEndian>
 #include <QVector>
 #include <QUuid>
 #include <QColor>
 #include <QPointF>
+#include <QStringList>
+#include <QThread>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
 
 using namespace uibin;
 
 namespace
 {
-    struct AssetRec { quint32 domainId; quint32 registryId; QByteArray data; };
+    // Identity plus where the blob lives; the bytes are never copied here.
+    struct AssetRec
+    {
+        quint32 domainId = 0;
+        quint32 registryId = 0;
+        qint64 offset = 0;
+        quint32 length = 0;         // stored bytes
+        quint32 rawLength = 0;      // decoded bytes
+        quint8 codec = CODEC_STORED;
+    };
+
+    // One entry of the schema table: where each value of a schema-form
+    // component record sits.
+    struct Schema
+    {
+        struct Field
+        {
+            quint32 nameId;
+            quint8 tag;
+            quint16 offset;
+        };
+
+        QVector<Field> fields;
+        quint16 valuesSize = 0;
+    };
 
     struct Ctx
     {
         QVector<QString>  strings;
         QVector<AssetRec> assets;
+        QVector<Schema>   schemas;
+        bool hasSchemas = false;    // kFlagSchemas
+        bool subtreeSizes = false;  // kFlagSubtreeSizes
+        bool aligned = false;   // v5 record layout
 
         QString Str(quint32 id) const
         {
@@ -26,6 +72,272 @@ namespace
         }
     };
 
+    // Forward cursor over a QIODevice that demasks as it reads. Positions are
+    // file offsets relative to where the container starts on the device; data
+    // is pulled in chunk-sized pieces and each piece is demasked by its own
+    // stream offset (uibin::Obfuscate), so skipped bytes are never touched.
+    class DeviceSource
+    {
+    public:
+        DeviceSource(QIODevice* device, int chunkSize)
+            : dev(device), base(device->pos()), chunk(qMax(chunkSize, 4096))
+        {
+            buf.resize(chunk);
+        }
+
+        void SetMasked(bool m) { masked = m; }
+        bool IsMasked() const { return masked; }
+        void SetLimit(qint64 fileSize) { limit = fileSize; }
+        int ChunkSize() const { return chunk; }
+
+        bool ok() const { return !bad; }
+        qint64 pos() const { return filePos; }
+
+        void Read(char* dst, qint64 n)
+        {
+            if (n < 0 || filePos + n > limit)
+            {
+                bad = true;
+                return;
+            }
+
+            while (n > 0 && !bad)
+            {
+                if (bufAt < bufLen)
+                {
+                    const qint64 take = qMin<qint64>(n, bufLen - bufAt);
+                    std::memcpy(dst, buf.constData() + bufAt, size_t(take));
+                    bufAt += int(take);
+                    filePos += take;
+                    dst += take;
+                    n -= take;
+                    continue;
+                }
+
+                // Large reads bypass the chunk buffer.
+                if (n >= chunk)
+                {
+                    const qint64 got = Pull(dst, n);
+                    filePos += got;
+                    dst += got;
+                    n -= got;
+                    continue;
+                }
+
+                bufAt = 0;
+                bufLen = int(Pull(buf.data(), qMin<qint64>(chunk, limit - devPos)));
+            }
+        }
+
+        QByteArray Bytes(qint64 n)
+        {
+            if (n < 0 || filePos + n > limit)
+            {
+                bad = true;
+                return QByteArray();
+            }
+
+            QByteArray out(qsizetype(n), Qt::Uninitialized);
+            Read(out.data(), n);
+            return bad ? QByteArray() : out;
+        }
+
+        quint8  U8()  { char b[1] = {}; Read(b, 1); return quint8(b[0]); }
+        quint16 U16() { char b[2] = {}; Read(b, 2); return qFromLittleEndian<quint16>(b); }
+        quint32 U32() { char b[4] = {}; Read(b, 4); return qFromLittleEndian<quint32>(b); }
+
+        // Moves to a file offset. Forward moves inside the buffer are free;
+        // anything else seeks the device, or on a sequential device reads
+        // and discards (without demasking). Backward moves need random access.
+        void SkipTo(qint64 target)
+        {
+            if (bad)
+                return;
+
+            if (target < 0 || target > limit)
+            {
+                bad = true;
+                return;
+            }
+
+            if (target >= filePos && target - filePos <= bufLen - bufAt)
+            {
+                bufAt += int(target - filePos);
+                filePos = target;
+                return;
+            }
+
+            bufAt = bufLen = 0;
+
+            if (!dev->isSequential())
+            {
+                if (!dev->seek(base + target))
+                    bad = true;
+                devPos = filePos = target;
+                return;
+            }
+
+            if (target < devPos)
+            {
+                bad = true;
+                return;
+            }
+
+            while (devPos < target && !bad)
+            {
+                const qint64 got = Fetch(buf.data(), qMin<qint64>(chunk, target - devPos));
+                if (got <= 0)
+                    bad = true;
+                devPos += got;
+            }
+
+            filePos = target;
+        }
+
+    private:
+        // Raw device read, waiting once for data on sequential devices.
+        qint64 Fetch(char* dst, qint64 n)
+        {
+            qint64 got = dev->read(dst, n);
+            if (got == 0 && dev->waitForReadyRead(30000))
+                got = dev->read(dst, n);
+            return got;
+        }
+
+        // Reads up to n bytes at devPos and demasks them in place.
+        qint64 Pull(char* dst, qint64 n)
+        {
+            const qint64 got = Fetch(dst, n);
+            if (got <= 0)
+            {
+                bad = true;
+                return 0;
+            }
+
+            if (masked && devPos + got > qint64(kHeaderSize))
+            {
+                const qint64 skip = qMax<qint64>(0, qint64(kHeaderSize) - devPos);
+                Obfuscate(dst + skip, int(got - skip), quint64(devPos + skip - kHeaderSize));
+            }
+
+            devPos += got;
+            return got;
+        }
+
+        QIODevice* dev;
+        qint64 base;
+        int chunk;
+        bool masked = false;
+        qint64 limit = kHeaderSize;
+
+        QByteArray buf;
+        int bufAt = 0;
+        int bufLen = 0;
+
+        qint64 filePos = 0;     // logical read position
+        qint64 devPos = 0;      // device position (ahead by the buffered bytes)
+        bool bad = false;
+    };
+
+    // Hands one asset blob to the sink in chunk-sized pieces, or skips it.
+    // A shared record's blob is only its owner's index, which the sink is
+    // told instead.
+    void StreamAsset(DeviceSource& src, UiBinAssetSink* sink, const Ctx& ctx, quint32 index, const AssetRec& a)
+    {
+        const qint64 offset = a.offset;
+        const quint32 length = a.length;
+
+        if (a.codec == CODEC_SHARED)
+        {
+            src.SkipTo(offset);
+            const quint32 owner = length == 4 ? src.U32() : kNoAsset;
+            src.SkipTo(offset + length);
+            if (sink && src.ok() && owner < index && ctx.assets[int(owner)].codec != CODEC_SHARED)
+                sink->SharedAsset(index, owner);
+            return;
+        }
+
+        if (!sink || !sink->BeginAsset(index, ctx.Str(a.domainId), ctx.Str(a.registryId), length, a.codec))
+        {
+            src.SkipTo(offset + length);
+            return;
+        }
+
+        src.SkipTo(offset);
+
+        QByteArray piece(src.ChunkSize(), Qt::Uninitialized);
+        qint64 left = length;
+        while (left > 0 && src.ok())
+        {
+            const int n = int(qMin<qint64>(left, piece.size()));
+            src.Read(piece.data(), n);
+            if (!src.ok())
+                break;
+            sink->AssetData(index, piece.constData(), n);
+            left -= n;
+        }
+
+        sink->EndAsset(index);
+    }
+
+    // Parses an ATLS section (spec section 11.1), dropping entries whose
+    // asset or page index is out of range.
+    void ReadAtlas(const QByteArray& body, quint32 assetCount, QHash<quint32, UiBinAssetResolver::AtlasRect>* atlas)
+    {
+        Reader r(body.constData(), int(body.size()));
+        const quint32 count = r.U32();
+        for (quint32 i = 0; i < count && r.ok(); ++i)
+        {
+            const quint32 index = r.U32();
+            UiBinAssetResolver::AtlasRect rect;
+            rect.page = r.U32();
+            rect.x = r.U16();
+            rect.y = r.U16();
+            rect.w = r.U16();
+            rect.h = r.U16();
+            if (r.ok() && index < assetCount && rect.page < assetCount)
+                atlas->insert(index, rect);
+        }
+    }
+
+    // Reads one value laid out per tag. Returns false for an unknown tag,
+    // whose width cannot be known.
+    bool ReadValue(Reader& r, const Ctx& ctx, quint8 tag, QVariant* value, quint32* assetRef)
+    {
+        switch (tag)
+        {
+        case TAG_NONE:                                    break;
+        case TAG_BOOL:   *value = bool(r.U8());            break;
+        case TAG_INT32:  *value = int(r.I32());            break;
+        case TAG_INT64:  *value = qlonglong(r.I64());      break;
+        case TAG_DOUBLE: *value = r.F64();                 break;
+        case TAG_STRING: *value = ctx.Str(r.U32());        break;
+        case TAG_COLOR:  *value = QColor::fromRgba(QRgb(r.U32())); break;
+        case TAG_POINT:  { const double x = r.F64(); const double y = r.F64(); *value = QPointF(x, y); break; }
+        case TAG_ASSET_REF: *assetRef = r.U32();           break;
+        default:         return false;
+        }
+        return true;
+    }
+
+    void ApplyField(Component* comp, const Ctx& ctx, quint32 nameId, quint8 tag, const QVariant& value, quint32 assetRef)
+    {
+        if (tag == TAG_ASSET_REF)
+        {
+            if (assetRef != kNoAsset && assetRef < quint32(ctx.assets.size()))
+            {
+                const AssetRec& a = ctx.assets[int(assetRef)];
+                comp->setProperty("assetDomain", ctx.Str(a.domainId));
+                comp->setProperty("assetRegistryValue", ctx.Str(a.registryId));
+            }
+            // The path string itself is deliberately not restored.
+        }
+        else if (value.isValid())
+        {
+            comp->setProperty(ctx.Str(nameId).toLatin1().constData(), value);
+        }
+    }
+
     void ReadComponent(Reader& r, const Ctx& ctx, UiElement* el)
     {
         const QString typeName = ctx.Str(r.U32());
@@ -37,54 +349,65 @@ namespace
 
         const quint16 fieldCount = r.U16();
 
+        // Schema form: names and tags come from the schema table and every
+        // value sits at its schema offset, so a value with an unknown tag is
+        // simply skipped.
+        if (ctx.hasSchemas && fieldCount == kSchemaRecord)
+        {
+            if (ctx.aligned)
+                r.U16();
+            const quint32 schemaId = r.U32();
+            const int valuesAt = r.pos();
+
+            if (comp && schemaId < quint32(ctx.schemas.size())
+                && valuesAt + int(ctx.schemas[int(schemaId)].valuesSize) <= payloadEnd)
+            {
+                const Schema& schema = ctx.schemas[int(schemaId)];
+                for (const Schema::Field& f : schema.fields)
+                {
+                    if (f.offset + qMax(0, TagWidth(f.tag)) > int(schema.valuesSize))
+                        continue;
+
+                    r.seek(valuesAt + f.offset);
+
+                    QVariant value;
+                    quint32 assetRef = kNoAsset;
+                    if (ReadValue(r, ctx, f.tag, &value, &assetRef))
+                        ApplyField(comp, ctx, f.nameId, f.tag, value, assetRef);
+                }
+            }
+
+            r.seek(payloadEnd);
+            return;
+        }
+
+        if (ctx.aligned)
+            r.Align(8);
+
         for (quint16 f = 0; f < fieldCount && r.ok(); ++f)
         {
-            const QString name = ctx.Str(r.U32());
+            const quint32 nameId = r.U32();
             const quint8 tag = r.U8();
+            if (ctx.aligned)
+                r.Align(8);
 
             QVariant value;
             quint32 assetRef = kNoAsset;
-            bool unknownTag = false;
-
-            switch (tag)
-            {
-            case TAG_NONE:                                   break;
-            case TAG_BOOL:   value = bool(r.U8());            break;
-            case TAG_INT32:  value = int(r.I32());            break;
-            case TAG_INT64:  value = qlonglong(r.I64());      break;
-            case TAG_DOUBLE: value = r.F64();                 break;
-            case TAG_STRING: value = ctx.Str(r.U32());        break;
-            case TAG_COLOR:  value = QColor::fromRgba(QRgb(r.U32())); break;
-            case TAG_POINT:  { const double x = r.F64(); const double y = r.F64(); value = QPointF(x, y); break; }
-            case TAG_ASSET_REF: assetRef = r.U32();           break;
-            default: unknownTag = true;                       break;
-            }
 
             // Unknown tag: cannot know its width — abandon this component
             // and resync via the payload length (spec section 8).
-            if (unknownTag)
+            if (!ReadValue(r, ctx, tag, &value, &assetRef))
             {
                 r.seek(payloadEnd);
                 break;
             }
 
-            if (!comp)
-                continue;
+            // v5 pads every field to a multiple of 8 bytes.
+            if (ctx.aligned)
+                r.Align(8);
 
-            if (tag == TAG_ASSET_REF)
-            {
-                if (assetRef != kNoAsset && assetRef < quint32(ctx.assets.size()))
-                {
-                    const AssetRec& a = ctx.assets[int(assetRef)];
-                    comp->setProperty("assetDomain", ctx.Str(a.domainId));
-                    comp->setProperty("assetRegistryValue", ctx.Str(a.registryId));
-                }
-                // The path string itself is deliberately not restored.
-            }
-            else if (value.isValid())
-            {
-                comp->setProperty(name.toLatin1().constData(), value);
-            }
+            if (comp)
+                ApplyField(comp, ctx, nameId, tag, value, assetRef);
         }
 
         // Always resync to the declared end of the record so a single bad or
@@ -92,9 +415,21 @@ namespace
         r.seek(payloadEnd);
     }
 
-    UiElement* ReadElement(Reader& r, const Ctx& ctx, UiElement* parent)
+    // Reads one element record (name, UUID, components) and its child
+    // count block, leaving r at the first child.
+    UiElement* ReadRecord(Reader& r, const Ctx& ctx, UiElement* parent, quint32* childCount, quint32* childrenSize)
     {
         const QString name = ctx.Str(r.U32());
+
+        // v4: name, uuid, compCount. v5: name, compCount, reserved, uuid, so
+        // the UUID and everything after it stays 8-byte aligned.
+        quint16 compCount = 0;
+        if (ctx.aligned)
+        {
+            compCount = r.U16();
+            r.U16();
+        }
+
         const QByteArray uuid = r.Bytes(16);
 
         if (!r.ok())
@@ -103,76 +438,439 @@ namespace
         auto* el = new UiElement(name, parent);
         el->SetId(QUuid::fromRfc4122(uuid));
 
-        const quint16 compCount = r.U16();
+        if (!ctx.aligned)
+            compCount = r.U16();
         for (quint16 c = 0; c < compCount && r.ok(); ++c)
             ReadComponent(r, ctx, el);
 
-        const quint32 childCount = r.U32();
+        *childCount = r.U32();
+        *childrenSize = ctx.subtreeSizes ? r.U32() : 0;
+        if (ctx.aligned)
+            r.Align(8);
+
+        return el;
+    }
+
+    // Children that do not end where their size says are corrupt.
+    void CheckChildrenEnd(Reader& r, const Ctx& ctx, int childrenAt, quint32 childrenSize)
+    {
+        if (ctx.subtreeSizes && r.ok() && qint64(r.pos()) != qint64(childrenAt) + childrenSize)
+            r.seek(-1);
+    }
+
+    UiElement* ReadElement(Reader& r, const Ctx& ctx, UiElement* parent)
+    {
+        quint32 childCount = 0;
+        quint32 childrenSize = 0;
+        UiElement* el = ReadRecord(r, ctx, parent, &childCount, &childrenSize);
+        if (!el)
+            return nullptr;
+
+        const int childrenAt = r.pos();
         for (quint32 i = 0; i < childCount && r.ok(); ++i)
             ReadElement(r, ctx, el);
 
+        CheckChildrenEnd(r, ctx, childrenAt, childrenSize);
         return el;
     }
+
+    // Steps over one element and its subtree by the record's payload
+    // lengths and its children's size (kFlagSubtreeSizes only).
+    void SkipElement(Reader& r, const Ctx& ctx)
+    {
+        r.U32();
+        quint16 compCount = 0;
+        if (ctx.aligned)
+        {
+            compCount = r.U16();
+            r.U16();
+        }
+        r.Skip(16);
+        if (!ctx.aligned)
+            compCount = r.U16();
+
+        for (quint16 c = 0; c < compCount && r.ok(); ++c)
+        {
+            r.U32();
+            const quint32 payloadLen = r.U32();
+            r.Skip(payloadLen > quint32(std::numeric_limits<int>::max()) ? -1 : int(payloadLen));
+        }
+
+        r.U32();
+        const quint32 childrenSize = r.U32();
+        if (ctx.aligned)
+            r.Align(8);
+        r.Skip(childrenSize > quint32(std::numeric_limits<int>::max()) ? -1 : int(childrenSize));
+    }
+
+    // Trees smaller than this decode faster on one thread than the hand-off
+    // to the pool costs.
+    const int kParallelTreeSize = 256 * 1024;
+
+    // Decodes the whole tree into a new root. With subtree sizes and a large
+    // enough tree, the root's children are located by their sizes and
+    // decoded on the global thread pool, each into a detached subtree that
+    // is then moved to the calling thread and attached in file order. The
+    // result is the same tree a sequential decode builds; r ends where a
+    // sequential decode would leave it, or not ok().
+    UiElement* ReadTree(Reader& r, const QByteArray& tree, const Ctx& ctx)
+    {
+        if (!ctx.subtreeSizes || tree.size() < kParallelTreeSize)
+            return ReadElement(r, ctx, nullptr);
+
+        quint32 childCount = 0;
+        quint32 childrenSize = 0;
+        UiElement* root = ReadRecord(r, ctx, nullptr, &childCount, &childrenSize);
+        if (!root)
+            return nullptr;
+
+        const int childrenAt = r.pos();
+        if (childCount < 2)
+        {
+            for (quint32 i = 0; i < childCount && r.ok(); ++i)
+                ReadElement(r, ctx, root);
+            CheckChildrenEnd(r, ctx, childrenAt, childrenSize);
+            return root;
+        }
+
+        QVector<int> starts;
+        starts.reserve(int(qMin<quint32>(childCount, quint32(tree.size()))));
+        for (quint32 i = 0; i < childCount && r.ok(); ++i)
+        {
+            starts.push_back(r.pos());
+            SkipElement(r, ctx);
+        }
+        CheckChildrenEnd(r, ctx, childrenAt, childrenSize);
+        if (!r.ok())
+            return root;
+
+        const int end = r.pos();
+        starts.push_back(end);
+
+        QThread* home = QThread::currentThread();
+        QVector<UiElement*> kids(int(childCount), nullptr);
+        QVector<char> good(int(childCount), 0);
+        UiElement** out = kids.data();
+        char* ok = good.data();
+        const int* at = starts.constData();
+
+        ParallelFor(int(childCount), [&tree, &ctx, home, out, ok, at](int i)
+        {
+            Reader cr(tree.constData(), int(tree.size()));
+            cr.seek(at[i]);
+            UiElement* el = ReadElement(cr, ctx, nullptr);
+            ok[i] = el && cr.ok() && cr.pos() == at[i + 1];
+            if (el)
+                el->moveToThread(home);
+            out[i] = el;
+        });
+
+        // Attach even broken subtrees, so they are freed with the root.
+        bool allGood = true;
+        for (int i = 0; i < kids.size(); ++i)
+        {
+            if (kids[i])
+                kids[i]->setParent(root);
+            allGood = allGood && good[i];
+        }
+
+        if (!allGood)
+            r.seek(-1);
+        return root;
+    }
+}
+
+UiElement* UiBinReader::Read(const QByteArray& bytes, UiBinAssetResolver* assets)
+{
+    // Decode through the streaming path over a QBuffer that shares bytes: only
+    // the string table, asset records and tree are copied and demasked; the
+    // blobs stay untouched until the resolver is asked for them.
+    QBuffer device;
+    device.setData(bytes);
+    if (!device.open(QIODevice::ReadOnly))
+        return nullptr;
+
+    UiElement* root = Read(&device, nullptr, kDefaultChunkSize, assets);
+
+    if (root && assets)
+    {
+        assets->device = nullptr;
+        assets->file = bytes;
+    }
+
+    return root;
 }
 
-UiElement* UiBinReader::Read(const QByteArray& bytes)
+UiElement* UiBinReader::Read(QIODevice* device, UiBinAssetSink* sink, int chunkSize, UiBinAssetResolver* assets)
 {
-    if (bytes.size() < int(kHeaderSize) || std::memcmp(bytes.constData(), kMagic, 4) != 0)
+    return Decode(device, sink, chunkSize, assets, -1, nullptr);
+}
+
+UiElement* UiBinReader::ReadScene(const QByteArray& bytes, int scene, UiBinAssetResolver* assets)
+{
+    // As Read(bytes): the blobs stay in the shared bytes until asked for.
+    QBuffer device;
+    device.setData(bytes);
+    if (!device.open(QIODevice::ReadOnly))
         return nullptr;
 
-    // Take a writable copy and demask everything after the header. The header
-    // itself was left clear by the writer so we could locate sections and
-    // validate magic/version before doing any work. See uibin::Obfuscate.
-    QByteArray buf = bytes;
-    Obfuscate(buf.data() + kHeaderSize, buf.size() - int(kHeaderSize));
-
-    Reader r(buf.constData(), buf.size());
-
-    r.seek(4);
-    const quint16 version = r.U16();
-    r.U16();                                 // flags
-    const quint32 strOff   = r.U32();
-    const quint32 strCount = r.U32();
-    const quint32 assetOff  = r.U32();
-    const quint32 assetCount= r.U32();
-    const quint32 treeOff   = r.U32();
-    const quint32 fileSize  = r.U32();
-
-    if (version != kVersion || !r.ok())
+    UiElement* root = ReadScene(&device, scene, assets);
+
+    if (root && assets)
+    {
+        assets->device = nullptr;
+        assets->file = bytes;
+    }
+
+    return root;
+}
+
+UiElement* UiBinReader::ReadScene(QIODevice* device, int scene, UiBinAssetResolver* assets)
+{
+    if (scene < 0)
         return nullptr;
+    return Decode(device, nullptr, kDefaultChunkSize, assets, scene, nullptr);
+}
 
-    // The header's total-file-size field is a truncation sanity check (spec
-    // section 3): a mismatch means the file is truncated or corrupt.
-    if (qsizetype(fileSize) != bytes.size())
+QStringList UiBinReader::SceneNames(QIODevice* device)
+{
+    QStringList names;
+    Decode(device, nullptr, kDefaultChunkSize, nullptr, -1, &names);
+    return names;
+}
+
+UiElement* UiBinReader::Decode(QIODevice* device, UiBinAssetSink* sink, int chunkSize, UiBinAssetResolver* assets,
+                               int scene, QStringList* sceneNames)
+{
+    if (!device || !device->isReadable())
         return nullptr;
 
+    const qint64 start = device->pos();
+    DeviceSource src(device, chunkSize);
+
+    // The header is never masked.
+    const QByteArray hdr = src.Bytes(kHeaderSize);
+    if (!src.ok())
+        return nullptr;
+
+    const bool isV4 = std::memcmp(hdr.constData(), kMagic, 4) == 0;
+    const bool isV5 = std::memcmp(hdr.constData(), kMagicV5, 4) == 0;
+    if (!isV4 && !isV5)
+        return nullptr;
+
+    Reader hr(hdr.constData(), int(hdr.size()));
+
+    hr.seek(4);
+    const quint16 version = hr.U16();
+    const quint16 flags    = hr.U16();
+    const quint32 strOff   = hr.U32();
+    const quint32 strCount = hr.U32();
+    const quint32 assetOff  = hr.U32();
+    const quint32 assetCount= hr.U32();
+    const quint32 treeOff   = hr.U32();
+    const quint32 fileSize  = hr.U32();
+
+    if (version != (isV4 ? kVersion : kVersionV5) || !hr.ok() || treeOff >= fileSize)
+        return nullptr;
+
+    // A random-access device can be checked for truncation up front; on a
+    // stream a short file shows up as a failed read instead.
+    if (!device->isSequential() && device->size() - start != qint64(fileSize))
+        return nullptr;
+
+    src.SetMasked(isV4 || (flags & kFlagMasked));
+    const bool codecs = (flags & kFlagAssetCodecs) != 0;
+    src.SetLimit(fileSize);
+
     Ctx ctx;
+    ctx.aligned = isV5;
+    ctx.subtreeSizes = (flags & kFlagSubtreeSizes) != 0;
+
+    // --- Extension directory ----------------------------------------------
+    // Only sections this reader understands are kept; they are read after
+    // the tree, in file order, together with the v5 blobs. Every section
+    // after the tree bounds it, read or not, so a skipped one (STRH, EIDX,
+    // anything newer) is never streamed as tree bytes.
+    struct Section { char tag[4]; qint64 offset; quint32 length; };
+    QVector<Section> sections;
+    quint32 dirSize = 0;
+    qint64 treeEnd = fileSize;
+
+    if (flags & kFlagExtensions)
+    {
+        const quint32 count = src.U32();
+        dirSize = AlignUp(4 + count * kExtensionEntrySize, kSectionAlignment);
+        for (quint32 i = 0; i < count && src.ok(); ++i)
+        {
+            Section s;
+            std::memcpy(s.tag, src.Bytes(4).constData(), 4);
+            s.offset = src.U32();
+            s.length = src.U32();
+            if (s.offset >= qint64(treeOff))
+                treeEnd = qMin<qint64>(treeEnd, s.offset);
+            if (std::memcmp(s.tag, kExtAtlas, 4) == 0
+                || std::memcmp(s.tag, kExtGlyphs, 4) == 0
+                || std::memcmp(s.tag, kExtTextRuns, 4) == 0
+                || std::memcmp(s.tag, kExtLayout, 4) == 0
+                || std::memcmp(s.tag, kExtScenes, 4) == 0)
+                sections.push_back(s);
+        }
+    }
+
+    // --- Schema table -----------------------------------------------------
+    // Follows the directory, which is padded to 8 bytes.
+    if (flags & kFlagSchemas)
+    {
+        ctx.hasSchemas = true;
+        src.SkipTo(kHeaderSize + dirSize);
+
+        const quint32 count = src.U32();
+        for (quint32 i = 0; i < count && src.ok(); ++i)
+        {
+            src.U32();                      // type id: the record repeats it
+            const quint16 fieldCount = src.U16();
+
+            Schema s;
+            s.valuesSize = src.U16();
+            for (quint16 f = 0; f < fieldCount && src.ok(); ++f)
+            {
+                Schema::Field field;
+                field.nameId = src.U32();
+                field.tag = src.U8();
+                src.U8();
+                field.offset = src.U16();
+                s.fields.push_back(field);
+            }
+            ctx.schemas.push_back(s);
+        }
+    }
 
-    // String table.
-    r.seek(int(strOff));
-    for (quint32 i = 0; i < strCount && r.ok(); ++i)
+    // --- String table -----------------------------------------------------
+    src.SkipTo(strOff);
+    if (isV4)
+    {
+        for (quint32 i = 0; i < strCount && src.ok(); ++i)
+        {
+            const quint32 len = src.U32();
+            ctx.strings.push_back(QString::fromUtf8(src.Bytes(len)));
+        }
+    }
+    else
     {
-        const quint32 len = r.U32();
-        ctx.strings.push_back(QString::fromUtf8(r.Bytes(int(len))));
+        const QByteArray index = src.Bytes(qint64(strCount) * kStringIndexEntrySize);
+        for (quint32 i = 0; i < strCount && src.ok(); ++i)
+        {
+            const char* e = index.constData() + i * kStringIndexEntrySize;
+            src.SkipTo(qFromLittleEndian<quint32>(e));
+            ctx.strings.push_back(QString::fromUtf8(src.Bytes(qFromLittleEndian<quint32>(e + 4))));
+        }
     }
 
-    // Asset table.
-    r.seek(int(assetOff));
-    for (quint32 i = 0; i < assetCount && r.ok(); ++i)
+    // --- Asset table ------------------------------------------------------
+    // v4 blobs sit inline, so they stream now. v5 records only point at
+    // blobs that follow the tree; those stream after it, in file order.
+    // Extension sections (section < 0 for a blob) join the same queue.
+    struct Blob { quint32 index; qint64 offset; quint32 length; int section = -1; };
+    QVector<Blob> blobs;
+
+    for (int s = 0; s < sections.size(); ++s)
+        if (sections[s].offset >= qint64(treeOff))
+            blobs.push_back(Blob { 0, sections[s].offset, sections[s].length, s });
+
+    src.SkipTo(assetOff);
+    for (quint32 i = 0; i < assetCount && src.ok(); ++i)
     {
         AssetRec a;
-        a.domainId   = r.U32();
-        a.registryId = r.U32();
-        const quint32 dl = r.U32();
-        a.data = r.Bytes(int(dl));
+        a.domainId   = src.U32();
+        a.registryId = src.U32();
+
+        if (isV4)
+        {
+            if (codecs)
+            {
+                a.codec = src.U8();
+                a.rawLength = src.U32();
+            }
+            a.length = src.U32();
+            a.offset = src.pos();
+            if (!codecs)
+                a.rawLength = a.length;
+            StreamAsset(src, sink, ctx, i, a);
+        }
+        else
+        {
+            a.offset = src.U32();
+            a.length = src.U32();
+            a.rawLength = a.length;
+            if (codecs)
+            {
+                a.codec = src.U8();
+                src.U8();
+                src.U16();
+                a.rawLength = src.U32();
+            }
+            if (a.length > 0)
+            {
+                blobs.push_back(Blob { i, a.offset, a.length });
+                treeEnd = qMin<qint64>(treeEnd, a.offset);
+            }
+        }
+
         ctx.assets.push_back(a);
     }
 
-    if (!r.ok())
+    // --- Scene directory --------------------------------------------------
+    // A bundle's trees lie back to back (spec section 11.7). Picking one, or
+    // listing them, reads the SCNS body - after the trees - out of order,
+    // which needs random access. A plain Read decodes the first tree.
+    qint64 sceneStart = treeOff;
+    if (scene >= 0 || sceneNames)
+    {
+        int sec = -1;
+        for (int s = 0; s < sections.size(); ++s)
+            if (std::memcmp(sections[s].tag, kExtScenes, 4) == 0)
+                sec = s;
+
+        if (sec < 0 || device->isSequential())
+            return nullptr;
+
+        src.SkipTo(sections[sec].offset);
+        const QByteArray body = src.Bytes(sections[sec].length);
+        SceneDirectoryView dir;
+        if (!src.ok() || !dir.Open(body))
+            return nullptr;
+
+        if (sceneNames)
+        {
+            for (quint32 i = 0; i < dir.Count(); ++i)
+                sceneNames->push_back(ctx.Str(dir.At(i).nameId));
+            return nullptr;
+        }
+
+        if (quint32(scene) >= dir.Count())
+            return nullptr;
+
+        const SceneDirectoryView::Entry e = dir.At(quint32(scene));
+        sceneStart = qint64(treeOff) + e.offset;
+        if (sceneStart + qint64(e.size) > treeEnd)
+            return nullptr;
+        treeEnd = sceneStart + e.size;
+    }
+
+    // --- Element tree -----------------------------------------------------
+    // The only section held whole (for a bundle scene, just its tree). Its
+    // offset is 8-aligned, so v5 padding computed from the start of this
+    // buffer matches the file.
+    if (treeEnd <= sceneStart)
         return nullptr;
 
-    r.seek(int(treeOff));
-    UiElement* root = ReadElement(r, ctx, nullptr);
+    src.SkipTo(sceneStart);
+    const QByteArray tree = src.Bytes(treeEnd - sceneStart);
+    if (!src.ok())
+        return nullptr;
+
+    Reader r(tree.constData(), int(tree.size()));
+    UiElement* root = ReadTree(r, tree, ctx);
 
     if (!r.ok())
     {
@@ -180,6 +878,45 @@ UiElement* UiBinReader::Read(const QByteArray& bytes)
         return nullptr;
     }
 
+    // --- Extensions and v5 blobs -----------------------------------------
+    QHash<quint32, UiBinAssetResolver::AtlasRect> atlas;
+    QHash<QByteArray, QByteArray> extensions;
+
+    std::sort(blobs.begin(), blobs.end(), [](const Blob& a, const Blob& b) { return a.offset < b.offset; });
+    for (const Blob& b : blobs)
+    {
+        if (b.section < 0)
+        {
+            StreamAsset(src, sink, ctx, b.index, ctx.assets[int(b.index)]);
+            continue;
+        }
+
+        const Section& s = sections[b.section];
+        src.SkipTo(b.offset);
+        const QByteArray body = src.Bytes(b.length);
+        if (std::memcmp(s.tag, kExtAtlas, 4) == 0)
+            ReadAtlas(body, assetCount, &atlas);
+        extensions.insert(QByteArray(s.tag, 4), body);
+    }
+
+    if (!src.ok())
+    {
+        delete root;
+        return nullptr;
+    }
+
+    if (assets)
+    {
+        assets->Reset(src.IsMasked());
+        assets->device = device;
+        assets->deviceBase = start;
+        for (const AssetRec& a : ctx.assets)
+            assets->records.push_back(UiBinAssetResolver::Record {
+                ctx.Str(a.domainId), ctx.Str(a.registryId), a.offset, a.length, a.rawLength, a.codec });
+        assets->atlas = atlas;
+        assets->extensions = extensions;
+    }
+
     return root;
 }
 
@@ -192,16 +929,239 @@ bool UiBinReader::Validate(const QString& filePath, QString* error)
         return false;
     }
 
-    const QByteArray bytes = f.readAll();
+    QByteArray bytes = f.readAll();
     f.close();
 
-    UiElement* root = Read(bytes);
-    if (!root)
+    // Demask in place (readAll's buffer is unshared) and walk the file with
+    // UiBinView: no QObjects and no per-node allocation, one linear scan.
+    if (UiBinView::IsMasked(bytes))
+        UiBinView::Demask(bytes.data(), bytes.size());
+
+    UiBinView view;
+    if (!view.Open(bytes, error))
+        return false;
+
+    auto fail = [error](const char* msg)
     {
-        if (error) *error = QStringLiteral("structural decode failed");
+        if (error) *error = QString::fromLatin1(msg);
         return false;
+    };
+
+    const quint32 strCount = view.StringCount();
+    const quint32 assetCount = view.AssetCount();
+
+    for (quint32 i = 0; i < assetCount; ++i)
+    {
+        const UiBinView::Asset a = view.AssetAt(i);
+        if (a.domainId >= strCount || a.registryId >= strCount)
+            return fail("asset identity string id out of range");
+        if (a.codec == CODEC_PIXELS)
+        {
+            if (!ReadPixelHeader(a.data, nullptr) || a.rawLength != quint32(a.data.size()))
+                return fail("bad pixel asset header");
+        }
+        else if (a.codec == CODEC_SHARED)
+        {
+            const quint32 owner = view.SharedOwner(i);
+            if (owner == kNoAsset)
+                return fail("shared asset must point at an earlier, unshared asset");
+            if (a.rawLength != view.AssetAt(owner).rawLength)
+                return fail("shared asset length differs from its owner");
+        }
+        else if (a.codec != CODEC_STORED && a.codec != CODEC_ZLIB)
+        {
+            return fail("unknown asset codec");
+        }
+    }
+
+    for (quint32 i = 0; i < view.SchemaCount(); ++i)
+    {
+        if (view.SchemaTypeId(i) >= strCount)
+            return fail("schema type string id out of range");
+    }
+
+    // A bundle (spec section 11.7) holds one tree per scene, back to back;
+    // any other container exactly one, at the start of the tree section.
+    struct Root { quint32 offset; quint32 size; quint32 elements; };
+    QVector<Root> roots;
+
+    const QByteArrayView scenes = view.Extension(kExtScenes);
+    if (!scenes.isEmpty())
+    {
+        SceneDirectoryView dir;
+        if (!dir.Open(scenes) || dir.Count() == 0)
+            return fail("scene directory out of range");
+
+        QSet<quint32> names;
+        for (quint32 i = 0; i < dir.Count(); ++i)
+        {
+            const SceneDirectoryView::Entry e = dir.At(i);
+            if (e.nameId >= strCount)
+                return fail("scene name string id out of range");
+            if (names.contains(e.nameId))
+                return fail("duplicate scene name");
+            names.insert(e.nameId);
+            roots.push_back(Root { e.offset, e.size, e.elements });
+        }
+    }
+    else
+    {
+        roots.push_back(Root { 0, 0, 0 });
+    }
+
+    quint32 elementCount = 0;
+    for (const Root& root : roots)
+    {
+        const quint32 first = elementCount;
+
+        UiBinView::ElementCursor el = view.Subtree(root.offset);
+        while (el.Next())
+        {
+            ++elementCount;
+            if (el.NameId() >= strCount)
+                return fail("element name string id out of range");
+
+            UiBinView::ComponentCursor comp = el.Components();
+            while (comp.Next())
+            {
+                if (comp.TypeId() >= strCount)
+                    return fail("component type string id out of range");
+
+                // An unknown tag ends the field walk early; like the decoder,
+                // that is not an error (the component resyncs on its length).
+                UiBinView::FieldCursor field = comp.Fields();
+                while (field.Next())
+                {
+                    const UiBinView::Field& fv = field.Get();
+                    if (fv.nameId >= strCount)
+                        return fail("field name string id out of range");
+                    if (fv.tag == TAG_STRING && fv.U32() >= strCount)
+                        return fail("string field id out of range");
+                    if (fv.tag == TAG_ASSET_REF && fv.U32() != kNoAsset && fv.U32() >= assetCount)
+                        return fail("asset reference out of range");
+                }
+
+                if (!field.ok())
+                    return fail("structural decode failed");
+            }
+
+            if (!comp.ok())
+                return fail("structural decode failed");
+        }
+
+        if (!el.AtEnd())
+            return fail("structural decode failed");
+
+        if (!scenes.isEmpty()
+            && (quint64(el.End()) != quint64(view.TreeOffset()) + root.offset + root.size
+                || elementCount - first != root.elements))
+            return fail("scene directory does not match the tree");
+    }
+
+    const QByteArrayView atlas = view.Extension(kExtAtlas);
+    if (!atlas.isEmpty())
+    {
+        Reader r(atlas.data(), int(atlas.size()));
+        const quint32 count = r.U32();
+        if (quint64(count) * kAtlasEntrySize + 4 > quint64(atlas.size()))
+            return fail("atlas section out of range");
+
+        for (quint32 i = 0; i < count; ++i)
+        {
+            const quint32 index = r.U32();
+            const quint32 page = r.U32();
+            r.Skip(8);
+            if (index >= assetCount || page >= assetCount)
+                return fail("atlas entry out of range");
+        }
+    }
+
+    const QByteArrayView glyphs = view.Extension(kExtGlyphs);
+    if (!glyphs.isEmpty())
+    {
+        GlyphAtlasView gv;
+        if (!gv.Open(glyphs))
+            return fail("glyph section out of range");
+    }
+
+    const QByteArrayView runs = view.Extension(kExtTextRuns);
+    if (!runs.isEmpty())
+    {
+        TextRunView rv;
+        if (!rv.Open(runs))
+            return fail("text run section out of range");
+    }
+
+    const QByteArrayView layout = view.Extension(kExtLayout);
+    if (!layout.isEmpty())
+    {
+        ResolvedLayoutView lv;
+        if (!lv.Open(layout))
+            return fail("layout section out of range");
+    }
+
+    // Every element once; each entry must land on its own record, and each
+    // subtree must sit inside its parent's.
+    const QByteArrayView index = view.Extension(kExtElementIndex);
+    if (!index.isEmpty())
+    {
+        ElementIndexView iv;
+        if (!iv.Open(index) || iv.Count() != elementCount)
+            return fail("element index section out of range");
+
+        QVector<quint32> byElement(int(elementCount), kNoElement);
+        for (quint32 i = 0; i < iv.Count(); ++i)
+        {
+            const quint32 e = iv.At(i).element;
+            if (e >= elementCount || byElement[int(e)] != kNoElement)
+                return fail("element index entry out of range");
+            byElement[int(e)] = i;
+        }
+
+        const quint64 treeSize = quint64(bytes.size()) - view.TreeOffset();
+        for (quint32 i = 0; i < iv.Count(); ++i)
+        {
+            const ElementIndexView::Entry e = iv.At(i);
+            if (quint64(e.offset) + e.subtreeSize > treeSize)
+                return fail("element index entry out of range");
+
+            UiBinView::ElementCursor at = view.Subtree(e.offset);
+            if (!at.Next() || at.Uuid() != e.uuid)
+                return fail("element index entry does not match the tree");
+
+            if (e.element == 0)
+            {
+                if (e.parent != kNoElement || e.offset != 0)
+                    return fail("element index entry does not match the tree");
+                continue;
+            }
+
+            if (e.parent >= elementCount)
+                return fail("element index entry out of range");
+
+            const ElementIndexView::Entry p = iv.At(byElement[int(e.parent)]);
+            if (e.offset <= p.offset || quint64(e.offset) + e.subtreeSize > quint64(p.offset) + p.subtreeSize)
+                return fail("element index entry does not match the tree");
+        }
+    }
+
+    // UiBinView::Open has checked the table's shape; check every stored
+    // hash against its string and every id against its slot, or lookups
+    // would silently miss.
+    const QByteArrayView lookup = view.Extension(kExtStringLookup);
+    if (!lookup.isEmpty())
+    {
+        StringLookupView sv;
+        sv.Open(lookup, view.StringCount());
+        for (quint32 id = 0; id < view.StringCount(); ++id)
+        {
+            const QByteArrayView s = view.String(id);
+            if (sv.HashAt(id) != Hash64(s.data(), s.size()))
+                return fail("string lookup hash mismatch");
+            if (!sv.Reachable(id))
+                return fail("string lookup slot out of place");
+        }
     }
 
-    delete root;
     return true;
 }
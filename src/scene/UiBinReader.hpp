@@ -2,11 +2,40 @@
 #define SCENE_UIBINREADER_HPP
 
 #include <QString>
+#include <QStringList>
 #include <QByteArray>
 
+#include "scene/UiBinAssetResolver.hpp"
+
+class QIODevice;
 class UiElement;
 
-// Decodes a .uibin v4 container back into a UiElement tree. Used for
+// Receives asset blobs from the streaming UiBinReader::Read as they pass by,
+// demasked, in pieces of at most the reader's chunk size.
+class UiBinAssetSink
+{
+public:
+
+    virtual ~UiBinAssetSink() = default;
+
+    // Return false to skip this asset: its bytes are then stepped over by
+    // offset and never read or demasked. length counts the bytes as stored;
+    // codec (uibin::AssetCodec) says how to decode them - the pieces are
+    // passed through still encoded, so a sink can inflate as they arrive.
+    virtual bool BeginAsset(quint32 index, const QString& domain, const QString& registry, quint32 length, quint8 codec) = 0;
+
+    // Consecutive pieces of the blob announced by BeginAsset.
+    virtual void AssetData(quint32 index, const char* data, int n) = 0;
+
+    virtual void EndAsset(quint32 index) { Q_UNUSED(index); }
+
+    // A CODEC_SHARED record (spec section 5c): asset index has the same
+    // bytes as the earlier asset owner, which was already offered to this
+    // sink. Called instead of BeginAsset; nothing is streamed twice.
+    virtual void SharedAsset(quint32 index, quint32 owner) { Q_UNUSED(index); Q_UNUSED(owner); }
+};
+
+// Decodes a .uibin v4 (or aligned v5) container back into a UiElement tree. Used for
 // round-trip validation (the editor authors from JSON; this proves the binary
 // container is self-consistent and re-readable).
 //
@@ -17,12 +46,45 @@ class UiBinReader
 {
 public:
 
+    static const int kDefaultChunkSize = 64 * 1024;
+
     // Returns a newly allocated root (caller owns) or nullptr on any
-    // structural error / magic / version mismatch.
-    static UiElement* Read(const QByteArray& bytes);
+    // structural error / magic / version mismatch. Asset blobs are not read:
+    // pass assets to fetch them on demand later (it shares bytes).
+    static UiElement* Read(const QByteArray& bytes, UiBinAssetResolver* assets = nullptr);
+
+    // Streaming decode from any QIODevice positioned at the start of a
+    // container. Reads chunkSize pieces and demasks each at its stream
+    // position; the string table is decoded as it arrives, asset blobs go to
+    // sink (or are skipped by offset when sink is null or declines them), and
+    // only the element tree section is held whole. Peak memory is about the
+    // tree plus one chunk, not the file. Sequential devices (sockets, pipes)
+    // work as long as the file's sections are in writer order. When assets
+    // is given it is filled to fetch blobs from device later (random-access
+    // devices only; the device must stay open).
+    static UiElement* Read(QIODevice* device, UiBinAssetSink* sink = nullptr, int chunkSize = kDefaultChunkSize,
+                           UiBinAssetResolver* assets = nullptr);
+
+    // Bundles (UiBinWriter::WriteBundle, spec section 11.7). Read returns a
+    // bundle's first scene; ReadScene decodes the scene at index in the
+    // directory, reading the shared tables but only that scene's tree.
+    // Both need a random-access device positioned at the container start.
+    // SceneNames lists the scenes in directory order, empty for a plain
+    // container. UiBinBundle wraps these for repeated loads.
+    static UiElement* ReadScene(const QByteArray& bytes, int scene, UiBinAssetResolver* assets = nullptr);
+    static UiElement* ReadScene(QIODevice* device, int scene, UiBinAssetResolver* assets = nullptr);
+    static QStringList SceneNames(QIODevice* device);
 
     // Convenience: parse a file and report whether it is a valid container.
+    // Walks the bytes with UiBinView rather than building a UiElement tree.
     static bool Validate(const QString& filePath, QString* error = nullptr);
+
+private:
+
+    // The streaming decoder behind Read and ReadScene. scene < 0 decodes
+    // the first tree; with sceneNames set, only the directory is read.
+    static UiElement* Decode(QIODevice* device, UiBinAssetSink* sink, int chunkSize, UiBinAssetResolver* assets,
+                             int scene, QStringList* sceneNames);
 };
 
 #endif
@@ -0,0 +1,536 @@
+#include "scene/UiBinView.hpp"
+
+#include <QtEndian>
+
+#include <cstring>
+#include <limits>
+
+using namespace uibin;
+
+namespace
+{
+    double LoadF64(const char* p)
+    {
+        const quint64 q = qFromLittleEndian<quint64>(p);
+        double v;
+        std::memcpy(&v, &q, 8);
+        return v;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Field
+// ---------------------------------------------------------------------------
+
+bool    UiBinView::Field::Bool() const   { return value && value[0] != 0; }
+qint32  UiBinView::Field::Int32() const  { return value ? qFromLittleEndian<qint32>(value) : 0; }
+qint64  UiBinView::Field::Int64() const  { return value ? qFromLittleEndian<qint64>(value) : 0; }
+double  UiBinView::Field::Double() const { return value ? LoadF64(value) : 0.0; }
+quint32 UiBinView::Field::U32() const    { return value ? qFromLittleEndian<quint32>(value) : kNoAsset; }
+double  UiBinView::Field::X() const      { return value ? LoadF64(value) : 0.0; }
+double  UiBinView::Field::Y() const      { return value ? LoadF64(value + 8) : 0.0; }
+
+// ---------------------------------------------------------------------------
+// Cursors
+// ---------------------------------------------------------------------------
+
+UiBinView::FieldCursor::FieldCursor(const char* data, int begin, int end, quint16 count, bool aligned, const char* schema)
+    : r(data, end), begin(begin), remaining(count), aligned(aligned), schema(schema)
+{
+    r.seek(begin);
+}
+
+bool UiBinView::FieldCursor::Next()
+{
+    if (remaining == 0 || unknown || !r.ok())
+        return false;
+
+    if (schema)
+    {
+        while (remaining > 0)
+        {
+            --remaining;
+            const char* e = schema;
+            schema += kSchemaFieldSize;
+
+            field.nameId = qFromLittleEndian<quint32>(e);
+            field.tag = quint8(e[4]);
+            const int width = TagWidth(field.tag);
+            if (width < 0)
+                continue;
+
+            r.seek(begin + qFromLittleEndian<quint16>(e + 6));
+            field.value = r.View(width).data();
+            return r.ok();
+        }
+        return false;
+    }
+
+    --remaining;
+
+    field.nameId = r.U32();
+    field.tag = r.U8();
+    if (aligned)
+        r.Align(8);
+
+    const int width = TagWidth(field.tag);
+    if (width < 0)
+    {
+        unknown = true;
+        return false;
+    }
+
+    field.value = r.View(width).data();
+    if (aligned)
+        r.Align(8);
+
+    return r.ok();
+}
+
+UiBinView::ComponentCursor::ComponentCursor(const UiBinView* view, int begin, quint16 count)
+    : view(view), r(view->data, view->size), remaining(count)
+{
+    r.seek(begin);
+}
+
+bool UiBinView::ComponentCursor::Next()
+{
+    if (remaining == 0 || !r.ok())
+        return false;
+
+    --remaining;
+
+    typeId = r.U32();
+    const quint32 payloadLen = r.U32();
+    const int start = r.pos();
+
+    fieldCount = r.U16();
+    schema = nullptr;
+    quint32 valuesSize = 0;
+
+    if (view->schemas && fieldCount == kSchemaRecord)
+    {
+        if (view->IsAligned())
+            r.U16();                        // reserved
+        const quint32 schemaId = r.U32();
+
+        schema = view->SchemaAt(schemaId);
+        if (!schema)
+        {
+            r.seek(-1);
+            return false;
+        }
+
+        fieldCount = qFromLittleEndian<quint16>(schema + 4);
+        valuesSize = qFromLittleEndian<quint16>(schema + 6);
+        schema += kSchemaHeaderSize;
+    }
+    else if (view->IsAligned())
+    {
+        r.Align(8);
+    }
+    fieldsAt = r.pos();
+
+    // Resync to the declared end; seek fails (ok() = false) past EOF.
+    const qint64 end = qint64(start) + payloadLen;
+    if (end > std::numeric_limits<int>::max() || qint64(fieldsAt) + valuesSize > end)
+    {
+        r.seek(-1);
+        return false;
+    }
+
+    payloadEnd = int(end);
+    r.seek(payloadEnd);
+    return r.ok();
+}
+
+UiBinView::FieldCursor UiBinView::ComponentCursor::Fields() const
+{
+    return FieldCursor(view->data, fieldsAt, payloadEnd, fieldCount, view->IsAligned(), schema);
+}
+
+UiBinView::ElementCursor::ElementCursor(const UiBinView* view, int begin)
+    : view(view), r(view->data, view->size), aligned(view->IsAligned())
+{
+    r.seek(begin);
+    pending.push_back(1); // exactly one root
+    ends.push_back(-1);
+}
+
+bool UiBinView::ElementCursor::Next()
+{
+    while (!pending.isEmpty() && pending.back() == 0)
+    {
+        // A finished level must end exactly where its size said.
+        if (ends.back() >= 0 && r.pos() != ends.back())
+            r.seek(-1);
+        pending.pop_back();
+        ends.pop_back();
+    }
+
+    if (pending.isEmpty() || !r.ok())
+        return false;
+
+    --pending.back();
+    depth = int(pending.size()) - 1;
+    offset = r.pos();
+
+    nameId = r.U32();
+    if (aligned)
+    {
+        componentCount = r.U16();
+        r.U16();                            // reserved
+        uuid = r.View(16);
+    }
+    else
+    {
+        uuid = r.View(16);
+        componentCount = r.U16();
+    }
+
+    // Step over the component records by their payload lengths to reach the
+    // child count; Components() re-walks them on demand.
+    componentsAt = r.pos();
+    for (quint16 c = 0; c < componentCount && r.ok(); ++c)
+    {
+        r.U32();
+        const quint32 payloadLen = r.U32();
+        if (payloadLen > quint32(std::numeric_limits<int>::max()))
+            r.seek(-1);
+        else
+            r.Skip(int(payloadLen));
+    }
+
+    childCount = r.U32();
+    childrenSize = view->subtreeSizes ? r.U32() : 0;
+    if (aligned)
+        r.Align(8);
+
+    if (!r.ok())
+        return false;
+
+    pending.push_back(childCount);
+    ends.push_back(view->subtreeSizes ? qint64(r.pos()) + childrenSize : -1);
+    return true;
+}
+
+bool UiBinView::ElementCursor::SkipChildren()
+{
+    if (!view->subtreeSizes || pending.isEmpty() || !r.ok())
+        return false;
+
+    r.seek(ends.back() <= qint64(view->size) ? int(ends.back()) : -1);
+    pending.back() = 0;
+    return r.ok();
+}
+
+UiBinView::ComponentCursor UiBinView::ElementCursor::Components() const
+{
+    return ComponentCursor(view, componentsAt, componentCount);
+}
+
+// ---------------------------------------------------------------------------
+// View
+// ---------------------------------------------------------------------------
+
+bool UiBinView::IsMasked(QByteArrayView bytes)
+{
+    if (bytes.size() < qsizetype(kHeaderSize))
+        return false;
+
+    if (std::memcmp(bytes.data(), kMagic, 4) == 0)
+        return true;
+
+    return std::memcmp(bytes.data(), kMagicV5, 4) == 0
+        && (qFromLittleEndian<quint16>(bytes.data() + 6) & kFlagMasked) != 0;
+}
+
+void UiBinView::Demask(char* data, qsizetype size)
+{
+    if (size > qsizetype(kHeaderSize))
+        Obfuscate(data + kHeaderSize, int(size - kHeaderSize));
+}
+
+bool UiBinView::Open(QByteArrayView bytes, QString* error)
+{
+    auto fail = [error](const char* msg)
+    {
+        if (error) *error = QString::fromLatin1(msg);
+        return false;
+    };
+
+    data = nullptr;
+    size = 0;
+    stringAt.clear();
+    assetAt.clear();
+    schemaAt.clear();
+    extensions.clear();
+    lookup = StringLookupView();
+
+    if (bytes.size() < qsizetype(kHeaderSize) || bytes.size() > std::numeric_limits<int>::max())
+        return fail("bad size");
+
+    const bool isV4 = std::memcmp(bytes.data(), kMagic, 4) == 0;
+    const bool isV5 = std::memcmp(bytes.data(), kMagicV5, 4) == 0;
+    if (!isV4 && !isV5)
+        return fail("bad magic");
+
+    Reader r(bytes.data(), int(bytes.size()));
+
+    r.seek(4);
+    version = r.U16();
+    const quint16 flags = r.U16();
+    codecs = (flags & kFlagAssetCodecs) != 0;
+    schemas = (flags & kFlagSchemas) != 0;
+    subtreeSizes = (flags & kFlagSubtreeSizes) != 0;
+    strOff     = r.U32();
+    strCount   = r.U32();
+    assetOff   = r.U32();
+    assetCount = r.U32();
+    treeOff    = r.U32();
+    const quint32 fileSize = r.U32();
+
+    if (version != (isV4 ? kVersion : kVersionV5))
+        return fail("unsupported version");
+
+    if (qsizetype(fileSize) != bytes.size())
+        return fail("file size mismatch (truncated or corrupt)");
+
+    quint64 schemaOff = kHeaderSize;
+    if (flags & kFlagExtensions)
+    {
+        r.seek(int(kHeaderSize));
+        const quint32 count = r.U32();
+        if (quint64(kHeaderSize) + 4 + quint64(count) * kExtensionEntrySize > fileSize)
+            return fail("extension directory out of range");
+        schemaOff += AlignUp(4 + count * kExtensionEntrySize, kSectionAlignment);
+
+        for (quint32 i = 0; i < count; ++i)
+        {
+            ExtensionEntry e;
+            std::memcpy(e.tag, r.View(4).data(), 4);
+            e.offset = r.U32();
+            e.length = r.U32();
+            if (quint64(e.offset) + e.length > fileSize)
+                return fail("extension section out of range");
+            extensions.push_back(e);
+        }
+    }
+
+    if (schemas)
+    {
+        // Record where each entry starts and check that every value of a
+        // known tag fits its schema's values block.
+        r.seek(int(schemaOff));
+        const quint32 count = r.U32();
+        schemaAt.reserve(int(qMin<quint32>(count, fileSize / kSchemaHeaderSize)));
+        for (quint32 i = 0; i < count && r.ok(); ++i)
+        {
+            schemaAt.push_back(quint32(r.pos()));
+            r.U32();
+            const quint16 fieldCount = r.U16();
+            const quint16 valuesSize = r.U16();
+            for (quint16 f = 0; f < fieldCount && r.ok(); ++f)
+            {
+                r.U32();
+                const int width = TagWidth(r.U8());
+                r.U8();
+                const quint16 offset = r.U16();
+                if (width >= 0 && offset + width > valuesSize)
+                    return fail("schema field out of range");
+            }
+        }
+
+        if (!r.ok() || quint64(r.pos()) > strOff)
+            return fail("schema table out of range");
+    }
+
+    if (isV4)
+    {
+        // Record where each variable-length entry starts.
+        stringAt.reserve(int(qMin<quint32>(strCount, fileSize / 4)));
+        r.seek(int(strOff));
+        for (quint32 i = 0; i < strCount && r.ok(); ++i)
+        {
+            stringAt.push_back(quint32(r.pos()));
+            r.Skip(int(r.U32()));
+        }
+
+        assetAt.reserve(int(qMin<quint32>(assetCount, fileSize / 12)));
+        r.seek(int(assetOff));
+        for (quint32 i = 0; i < assetCount && r.ok(); ++i)
+        {
+            assetAt.push_back(quint32(r.pos()));
+            r.U32();
+            r.U32();
+            if (codecs)
+                r.Skip(5);                   // codec, raw length
+            r.Skip(int(r.U32()));
+        }
+
+        if (!r.ok())
+            return fail("string or asset table out of range");
+    }
+    else
+    {
+        // Fixed-size indexes: bound-check every (offset, length) once so
+        // lookups can trust them.
+        if (quint64(strOff) + quint64(strCount) * kStringIndexEntrySize > fileSize
+            || quint64(assetOff) + quint64(assetCount) * AssetRecordSizeV5() > fileSize)
+            return fail("string or asset table out of range");
+
+        for (quint32 i = 0; i < strCount; ++i)
+        {
+            const char* e = bytes.data() + strOff + i * kStringIndexEntrySize;
+            if (quint64(qFromLittleEndian<quint32>(e)) + qFromLittleEndian<quint32>(e + 4) > fileSize)
+                return fail("string out of range");
+        }
+
+        for (quint32 i = 0; i < assetCount; ++i)
+        {
+            const char* e = bytes.data() + assetOff + i * AssetRecordSizeV5();
+            if (quint64(qFromLittleEndian<quint32>(e + 8)) + qFromLittleEndian<quint32>(e + 12) > fileSize)
+                return fail("asset out of range");
+        }
+    }
+
+    if (treeOff >= fileSize)
+        return fail("element tree out of range");
+
+    for (const ExtensionEntry& e : extensions)
+    {
+        if (std::memcmp(e.tag, kExtStringLookup, 4) == 0
+            && !lookup.Open(QByteArrayView(bytes.data() + e.offset, qsizetype(e.length)), strCount))
+            return fail("string lookup section out of range");
+    }
+
+    data = bytes.data();
+    size = int(bytes.size());
+    return true;
+}
+
+QByteArrayView UiBinView::String(quint32 id) const
+{
+    if (id >= strCount)
+        return QByteArrayView();
+
+    if (IsAligned())
+    {
+        const char* e = data + strOff + id * kStringIndexEntrySize;
+        return QByteArrayView(data + qFromLittleEndian<quint32>(e), qsizetype(qFromLittleEndian<quint32>(e + 4)));
+    }
+
+    const quint32 at = stringAt[int(id)];
+    return QByteArrayView(data + at + 4, qsizetype(qFromLittleEndian<quint32>(data + at)));
+}
+
+quint32 UiBinView::FindString(QByteArrayView utf8) const
+{
+    if (lookup.IsOpen())
+        return lookup.Find(utf8, [this](quint32 id) { return String(id); });
+
+    for (quint32 id = 0; id < strCount; ++id)
+        if (String(id) == utf8)
+            return id;
+    return kNoString;
+}
+
+UiBinView::Asset UiBinView::AssetAt(quint32 index) const
+{
+    Asset a;
+    if (index >= assetCount)
+        return a;
+
+    if (IsAligned())
+    {
+        const char* e = data + assetOff + index * AssetRecordSizeV5();
+        a.domainId   = qFromLittleEndian<quint32>(e);
+        a.registryId = qFromLittleEndian<quint32>(e + 4);
+        a.data = QByteArrayView(data + qFromLittleEndian<quint32>(e + 8), qsizetype(qFromLittleEndian<quint32>(e + 12)));
+        a.rawLength = quint32(a.data.size());
+        if (codecs)
+        {
+            a.codec = quint8(e[16]);
+            a.rawLength = qFromLittleEndian<quint32>(e + 20);
+        }
+        return a;
+    }
+
+    const char* e = data + assetAt[int(index)];
+    a.domainId   = qFromLittleEndian<quint32>(e);
+    a.registryId = qFromLittleEndian<quint32>(e + 4);
+    if (codecs)
+    {
+        a.codec = quint8(e[8]);
+        a.rawLength = qFromLittleEndian<quint32>(e + 9);
+        e += 5;
+    }
+    a.data = QByteArrayView(e + 12, qsizetype(qFromLittleEndian<quint32>(e + 8)));
+    if (!codecs)
+        a.rawLength = quint32(a.data.size());
+    return a;
+}
+
+quint32 UiBinView::SharedOwner(quint32 index) const
+{
+    const Asset a = AssetAt(index);
+    if (a.codec != CODEC_SHARED || a.data.size() != 4)
+        return kNoAsset;
+
+    const quint32 owner = qFromLittleEndian<quint32>(a.data.data());
+    if (owner >= index || AssetAt(owner).codec == CODEC_SHARED)
+        return kNoAsset;
+    return owner;
+}
+
+UiBinView::Asset UiBinView::ResolvedAssetAt(quint32 index) const
+{
+    Asset a = AssetAt(index);
+    if (a.codec != CODEC_SHARED)
+        return a;
+
+    const quint32 owner = SharedOwner(index);
+    if (owner == kNoAsset)
+    {
+        a.data = QByteArrayView();
+        return a;
+    }
+
+    const Asset o = AssetAt(owner);
+    a.data = o.data;
+    a.codec = o.codec;
+    a.rawLength = o.rawLength;
+    return a;
+}
+
+const char* UiBinView::SchemaAt(quint32 id) const
+{
+    return id < quint32(schemaAt.size()) ? data + schemaAt[int(id)] : nullptr;
+}
+
+quint32 UiBinView::SchemaTypeId(quint32 id) const
+{
+    const char* s = SchemaAt(id);
+    return s ? qFromLittleEndian<quint32>(s) : 0;
+}
+
+QByteArrayView UiBinView::Extension(const char* tag) const
+{
+    for (const ExtensionEntry& e : extensions)
+    {
+        if (std::memcmp(e.tag, tag, 4) == 0)
+            return QByteArrayView(data + e.offset, qsizetype(e.length));
+    }
+    return QByteArrayView();
+}
+
+UiBinView::ElementCursor UiBinView::Elements() const
+{
+    return ElementCursor(this, int(treeOff));
+}
+
+UiBinView::ElementCursor UiBinView::Subtree(quint32 offset) const
+{
+    const quint64 at = quint64(treeOff) + offset;
+    return ElementCursor(this, at < quint64(size) ? int(at) : -1);
+}
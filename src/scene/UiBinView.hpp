@@ -0,0 +1,254 @@
+#ifndef SCENE_UIBINVIEW_HPP
+#define SCENE_UIBINVIEW_HPP
+
+#include "scene/UiBinCommon.hpp"
+#include "scene/StringLookup.hpp"
+
+#include <QByteArrayView>
+#include <QString>
+#include <QVarLengthArray>
+#include <QVector>
+
+// Read-only view over a baked .uibin (v4 or v5) that builds no QObjects.
+// Strings and asset bytes come back as views into the caller's buffer and the
+// element tree is walked with cursors that hold only offsets, so inspecting
+// or validating a file is a single linear scan with no per-node allocation.
+//
+// The buffer must already be demasked (see IsMasked / Demask) and must
+// outlive the view and every cursor taken from it. v4 has no string or asset
+// index, so Open records one offset per string and per asset - once per
+// file, never per node. v5 is indexed in place.
+class UiBinView
+{
+public:
+
+    struct Asset
+    {
+        quint32 domainId = 0;
+        quint32 registryId = 0;
+        QByteArrayView data;                    // as stored
+        quint8 codec = uibin::CODEC_STORED;
+        quint32 rawLength = 0;                  // size once decoded
+    };
+
+    // One field. value points at the raw little-endian value bytes laid out
+    // per tag (spec section 8); read them through the accessors.
+    struct Field
+    {
+        quint32 nameId = 0;
+        quint8 tag = uibin::TAG_NONE;
+        const char* value = nullptr;
+
+        bool    Bool() const;
+        qint32  Int32() const;
+        qint64  Int64() const;
+        double  Double() const;
+        quint32 U32() const;        // STRING id, COLOR, ASSET_REF index
+        double  X() const;          // POINT
+        double  Y() const;
+    };
+
+    // Walks a component's fields in either record form. For a schema-form
+    // record the names and tags come from the schema table and each value is
+    // read at its fixed offset.
+    class FieldCursor
+    {
+    public:
+        // Advances to the next field. Returns false at the end, on a
+        // structural error (ok() turns false) or, in a TLV record, on an
+        // unknown tag, whose width cannot be known - the rest of the
+        // component is then skipped. A schema-form record places every value
+        // by offset, so fields with unknown tags are stepped over instead.
+        bool Next();
+
+        const Field& Get() const { return field; }
+        bool ok() const { return r.ok(); }
+        bool UnknownTag() const { return unknown; }
+
+    private:
+        friend class UiBinView;
+        FieldCursor(const char* data, int begin, int end, quint16 count, bool aligned, const char* schema);
+
+        uibin::Reader r;
+        int begin;
+        quint16 remaining;
+        bool aligned;
+        const char* schema;         // first schema field entry, or null (TLV)
+        bool unknown = false;
+        Field field;
+    };
+
+    class ComponentCursor
+    {
+    public:
+        // Advances to the next component of the element.
+        bool Next();
+
+        quint32 TypeId() const { return typeId; }
+        quint16 FieldCount() const { return fieldCount; }
+        bool HasSchema() const { return schema != nullptr; }
+        FieldCursor Fields() const;
+        bool ok() const { return r.ok(); }
+
+    private:
+        friend class UiBinView;
+        ComponentCursor(const UiBinView* view, int begin, quint16 count);
+
+        const UiBinView* view;
+        uibin::Reader r;
+        quint16 remaining;
+        quint32 typeId = 0;
+        quint16 fieldCount = 0;
+        const char* schema = nullptr;
+        int fieldsAt = 0;
+        int payloadEnd = 0;
+    };
+
+    // Pre-order walk over the whole element tree. Each Next() lands on one
+    // element; Depth() is 0 for the root.
+    class ElementCursor
+    {
+    public:
+        bool Next();
+
+        int Depth() const { return depth; }
+        int Offset() const { return offset; }   // file offset of the record
+        quint32 NameId() const { return nameId; }
+        QByteArrayView Uuid() const { return uuid; }
+        quint16 ComponentCount() const { return componentCount; }
+        quint32 ChildCount() const { return childCount; }
+        ComponentCursor Components() const;
+
+        // Byte size of the current element's children (0 unless the file
+        // has kFlagSubtreeSizes). With sizes, every level is also checked
+        // to end exactly where its size says.
+        quint32 ChildrenSize() const { return childrenSize; }
+
+        // Steps over the current element's children without visiting them,
+        // so the next Next() lands on its next sibling (or an ancestor's).
+        // Needs kFlagSubtreeSizes; returns false without it.
+        bool SkipChildren();
+
+        bool ok() const { return r.ok(); }
+
+        // True once every element has been visited without error.
+        bool AtEnd() const { return r.ok() && pending.isEmpty(); }
+
+        // File offset just past the bytes walked so far; once AtEnd(), where
+        // the (sub)tree ends.
+        int End() const { return r.pos(); }
+
+    private:
+        friend class UiBinView;
+        ElementCursor(const UiBinView* view, int begin);
+
+        const UiBinView* view;
+        uibin::Reader r;
+        bool aligned;
+
+        // Siblings still to visit per open level, and where each level must
+        // end (-1 when unknown); inline up to 64 levels.
+        QVarLengthArray<quint32, 64> pending;
+        QVarLengthArray<qint64, 64> ends;
+
+        int depth = 0;
+        int offset = 0;
+        quint32 nameId = 0;
+        QByteArrayView uuid;
+        quint16 componentCount = 0;
+        quint32 childCount = 0;
+        quint32 childrenSize = 0;
+        int componentsAt = 0;
+    };
+
+    // Whether the body of these (raw, on-disk) bytes is XOR-masked: always
+    // for v4, per header flag for v5.
+    static bool IsMasked(QByteArrayView bytes);
+
+    // Demasks a whole file in place (the header is left untouched).
+    static void Demask(char* data, qsizetype size);
+
+    // Checks the header and the string/asset tables. Returns false (with an
+    // error) on a bad magic/version, size mismatch or out-of-range table.
+    bool Open(QByteArrayView bytes, QString* error = nullptr);
+
+    quint16 Version() const { return version; }
+    bool IsAligned() const { return version == uibin::kVersionV5; }
+
+    quint32 StringCount() const { return strCount; }
+    QByteArrayView String(quint32 id) const;    // UTF-8; empty if out of range
+
+    // Id of the string with these UTF-8 bytes, or uibin::kNoString. One
+    // probe through the STRH section (spec section 11.5) when the file has
+    // it, a linear scan of the table otherwise.
+    quint32 FindString(QByteArrayView utf8) const;
+
+    quint32 AssetCount() const { return assetCount; }
+    Asset AssetAt(quint32 index) const;         // zeroed if out of range
+
+    // AssetAt with a CODEC_SHARED record (spec section 5c) followed to the
+    // blob it uses: the record's own identity, the owner's data, codec and
+    // raw length. A dangling share yields empty data.
+    Asset ResolvedAssetAt(quint32 index) const;
+
+    // The owner index a CODEC_SHARED record points at, or uibin::kNoAsset
+    // if the record is not shared or its owner is not an earlier, unshared
+    // record.
+    quint32 SharedOwner(quint32 index) const;
+
+    // Component schemas (spec section 7a); 0 unless the file has the table.
+    quint32 SchemaCount() const { return quint32(schemaAt.size()); }
+    quint32 SchemaTypeId(quint32 id) const;     // 0 if out of range
+
+    quint32 TreeOffset() const { return treeOff; }
+    ElementCursor Elements() const;
+
+    // Pre-order walk of just the subtree whose record starts offset bytes
+    // into the tree section (an EIDX offset, spec section 11.6); Depth() is
+    // 0 for the subtree's root. The offset is bounds-checked by the cursor
+    // but not otherwise trusted, so take it from a validated index.
+    ElementCursor Subtree(quint32 offset) const;
+
+    // Body of the tagged extension section (spec section 11), or an empty
+    // view if the file has none with that four-character tag.
+    QByteArrayView Extension(const char* tag) const;
+
+private:
+    struct ExtensionEntry
+    {
+        char tag[4];
+        quint32 offset;
+        quint32 length;
+    };
+
+    quint32 AssetRecordSizeV5() const { return codecs ? uibin::kAssetRecordSizeV5Codecs : uibin::kAssetRecordSizeV5; }
+
+    // Schema entry: u32 type id, u16 field count, u16 values size, fields.
+    const char* SchemaAt(quint32 id) const;
+
+    const char* data = nullptr;
+    int size = 0;
+
+    quint16 version = 0;
+    bool codecs = false;                        // kFlagAssetCodecs
+    quint32 strOff = 0;
+    quint32 strCount = 0;
+    quint32 assetOff = 0;
+    quint32 assetCount = 0;
+    quint32 treeOff = 0;
+
+    QVarLengthArray<ExtensionEntry, 4> extensions;
+    StringLookupView lookup;
+
+    // v4 only: record offsets, so lookups by id are O(1).
+    QVector<quint32> stringAt;
+    QVector<quint32> assetAt;
+
+    // Offset of each schema entry (kFlagSchemas).
+    QVector<quint32> schemaAt;
+    bool schemas = false;
+
+    bool subtreeSizes = false;                  // kFlagSubtreeSizes
+};
+
+#endif
@@ -1,5 +1,15 @@
 #include "scene/UiBinWriter.hpp"
 #include "scene/UiBinCommon.hpp"
+#include "scene/AssetCache.hpp"
+#include "scene/BakeCache.hpp"
+#include "scene/BakeProgress.hpp"
+#include "scene/AtlasPacker.hpp"
+#include "scene/GlyphAtlas.hpp"
+#include "scene/TextRuns.hpp"
+#include "scene/ResolvedLayout.hpp"
+#include "scene/StringLookup.hpp"
+#include "scene/ElementIndex.hpp"
+#include "scene/SceneDirectory.hpp"
 #include "scene/SceneDocument.hpp"
 #include "core/UiElement.hpp"
 #include "core/Component.hpp"
@@ -7,6 +17,7 @@
 
 #include <QFile>
 #include <QHash>
+#include <QSet>
 #include <QVector>
 #include <QUuid>
 #include <QColor>
@@ -15,6 +26,14 @@
 #include <QMetaObject>
 #include <QMetaProperty>
 #include <QFileInfo>
+#include <QImage>
+#include <QReadWriteLock>
+#include <QBuffer>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
 
 using namespace uibin;
 
@@ -26,11 +45,59 @@ namespace
         QHash<QString, quint32> stringIndex;
         QVector<QString>        strings;
 
-        struct Asset { quint32 domainId; quint32 registryId; QByteArray data; };
+        struct Asset
+        {
+            quint32 domainId;
+            quint32 registryId;
+            QByteArray data;                    // as stored (see codec)
+            quint32 rawSize = 0;
+            quint8 codec = CODEC_STORED;
+            bool atlasImage = false;            // every reference is atlas-eligible
+            quint32 sharedWith = kNoAsset;      // earlier asset with the same bytes
+            quint64 hash = 0;                   // Hash64 of data, if hashed
+            bool hashed = false;                // from AssetCache, else computed on demand
+        };
         QHash<QString, quint32> assetIndex;
         QVector<Asset>          assets;
+        bool sharedBlobs = false;               // some asset has sharedWith set
+
+        // The asset holding index's bytes: itself unless it is shared.
+        const Asset& BlobOf(quint32 index) const
+        {
+            const Asset& a = assets[int(index)];
+            return a.sharedWith == kNoAsset ? a : assets[int(a.sharedWith)];
+        }
+
+        // Component schemas (uibin::kFlagSchemas), keyed by type and field
+        // signature so every distinct layout is stored once.
+        struct Schema
+        {
+            quint32 typeId;
+            QVector<quint32> nameIds;
+            QVector<quint8> tags;
+        };
+        QHash<QString, quint32> schemaIndex;
+        QVector<Schema>         schemas;
 
         QString baseDir;
+        AssetCache* cache = nullptr;
+        BakeCache* bakeCache = nullptr;
+        BakeProgress* progress = nullptr;
+        bool aligned = false;
+        bool useSchemas = false;
+        bool subtreeSizes = false;
+        bool hashAssets = false;                // dedupAssets: take hashes from the AssetCache
+
+        // Optional tagged sections (uibin::kFlagExtensions), in file order.
+        struct Extension { QByteArray tag; QByteArray data; };
+        QVector<Extension> extensions;
+
+        // Where each element's subtree landed in the tree section, in
+        // pre-order; offsets are relative to the start of the tree.
+        struct Span { QByteArray uuid; quint32 parent; quint32 offset; quint32 size; };
+        QVector<Span> spans;
+
+        bool Cancelled() const { return progress && progress->IsCancelled(); }
 
         quint32 Intern(const QString& s)
         {
@@ -44,32 +111,70 @@ namespace
             return id;
         }
 
+        // An asset path as read from disk: relative ones resolve against the
+        // current document's base directory.
+        QString AssetPath(const QString& rel) const
+        {
+            if (rel.isEmpty() || baseDir.isEmpty() || QFileInfo(rel).isAbsolute())
+                return rel;
+            return baseDir + QLatin1Char('/') + rel;
+        }
+
+        // assetIndex key. Keyed on the resolved path, so the same relative
+        // path in two bundled documents with different base directories
+        // stays two assets.
+        QString AssetKey(const QString& rel, const QString& domain, const QString& registry) const
+        {
+            return domain + QChar(0x1F) + registry + QChar(0x1F) + AssetPath(rel);
+        }
+
         // Resolve a relative asset path, embed its bytes once, and return the
         // asset index. Domain/registry come from sibling properties on the
         // same component and define the engine-facing identity.
-        quint32 RegisterAsset(const QString& rel, const QString& domain, const QString& registry)
+        // An asset is only packed into an atlas if every reference to it is
+        // atlas-eligible, so atlasImage is AND-ed across references.
+        quint32 RegisterAsset(const QString& rel, const QString& domain, const QString& registry, bool atlasImage)
         {
             if (rel.isEmpty() && domain.isEmpty() && registry.isEmpty())
                 return kNoAsset;
 
-            const QString key = domain + QChar(0x1F) + registry + QChar(0x1F) + rel;
+            const QString key = AssetKey(rel, domain, registry);
 
             auto it = assetIndex.find(key);
             if (it != assetIndex.end())
+            {
+                assets[int(it.value())].atlasImage &= atlasImage;
                 return it.value();
+            }
 
             QByteArray data;
+            quint64 hash = 0;
+            bool hashed = false;
             if (!rel.isEmpty())
             {
-                const QString abs = baseDir.isEmpty()
-                    ? rel
-                    : (QFileInfo(rel).isAbsolute() ? rel : baseDir + QLatin1Char('/') + rel);
+                const QString abs = AssetPath(rel);
 
-                QFile f(abs);
-                if (f.open(QIODevice::ReadOnly))
+                if (cache)
+                {
+                    // The cache hashes each file once per batch, not once
+                    // per scene.
+                    const AssetCache::Entry e = cache->Get(abs, hashAssets);
+                    data = e.data;
+                    hash = e.hash;
+                    hashed = e.hashed;
+                }
+                else if (bakeCache)
+                {
+                    data = bakeCache->AssetBytes(abs);
+                }
+                else
                 {
-                    data = f.readAll();
-                    f.close();
+                    QFile f(abs);
+                    if (f.open(QIODevice::ReadOnly))
+                    {
+                        data = f.readAll();
+                        f.close();
+                    }
                 }
             }
 
@@ -77,165 +182,624 @@ namespace
             a.domainId   = Intern(domain);
             a.registryId = Intern(registry);
             a.data       = data;
+            a.rawSize    = quint32(data.size());
+            a.atlasImage = atlasImage && !data.isEmpty();
+            a.hash       = hash;
+            a.hashed     = hashed;
 
             const quint32 idx = quint32(assets.size());
             assets.push_back(a);
             assetIndex.insert(key, idx);
             return idx;
         }
+
+        quint32 RegisterSchema(const BakeCache::Node::Schema& s)
+        {
+            QString key = s.type;
+            for (int i = 0; i < s.names.size(); ++i)
+                key += QChar(0x1F) + s.names[i] + QChar(0x1E) + QString::number(s.tags[i]);
+
+            auto it = schemaIndex.find(key);
+            if (it != schemaIndex.end())
+                return it.value();
+
+            Schema g;
+            g.typeId = Intern(s.type);
+            for (const QString& name : s.names)
+                g.nameIds.push_back(Intern(name));
+            g.tags = s.tags;
+
+            const quint32 id = quint32(schemas.size());
+            schemas.push_back(g);
+            schemaIndex.insert(key, id);
+            return id;
+        }
     };
 
-    void WriteComponent(Bake& bake, Writer& w, const Component* comp)
+    // The tag and payload one (non-asset) property value encodes to. Shared
+    // by encoding and content hashing, so a cache key covers exactly what
+    // lands in the file. Scalars are kept as raw little-endian bits in a/b.
+    struct FieldValue
     {
-        const QMetaObject* mo = comp->metaObject();
+        FieldTag tag = TAG_NONE;
+        quint64 a = 0;
+        quint64 b = 0;
+        QString str;
+    };
 
-        w.U32(bake.Intern(comp->GetTypeName()));
+    // Detect enum AND QFlags properties. p.isEnumType() only returns true
+    // when the flag is registered (Q_ENUM / Q_FLAG) in the SAME class as the
+    // Q_PROPERTY. AnchorFlags lives in EnumHolder, so TransformComponent's
+    // moc never marks its anchors/stretch properties as enum and they would
+    // otherwise fall through to canConvert<QString>(), which serialises
+    // QFlags(0) as "NONE" and composite bitmasks as "" - both useless to a
+    // runtime decoder.
+    //
+    // A defensive "...Flags" type-name check catches the externally-
+    // registered case; ClassifyValue also accepts the
+    // QMetaType::IsEnumeration flag on the value itself.
+    bool IsEnumOrFlags(const QMetaProperty& p)
+    {
+        return p.isEnumType() || QByteArray(p.typeName()).endsWith("Flags");
+    }
 
-        const int lenAt = w.pos();
-        w.U32(0); // payload length, patched below
+    // enumOrFlags is IsEnumOrFlags of the property the value was read from.
+    FieldValue ClassifyValue(bool enumOrFlags, const QVariant& v)
+    {
+        FieldValue f;
+
+        const bool isEnumOrFlags = enumOrFlags || (v.metaType().flags() & QMetaType::IsEnumeration);
+
+        if (isEnumOrFlags)
+        {
+            // Q_ENUM converts cleanly via toInt(); externally-registered
+            // QFlags often does not. QFlags<T> is layout-compatible with
+            // its underlying int, so fall back to a direct read of the
+            // stored value when the QVariant conversion fails.
+            bool ok = false;
+            int iv = v.toInt(&ok);
+            if ((!ok || (iv == 0 && v.isValid()))
+                && v.constData()
+                && v.metaType().sizeOf() == int(sizeof(int)))
+            {
+                std::memcpy(&iv, v.constData(), sizeof(int));
+            }
+
+            f.tag = TAG_INT32;
+            f.a = quint32(iv);
+            return f;
+        }
+
+        // Switch on the VALUE's metatype, not the declared property
+        // metatype: this reliably reports QPointF for Transform.position
+        // and Transform.scale (a stale/odd declared metatype would
+        // otherwise drop them to the stringify fallback).
+        switch (v.metaType().id())
+        {
+        case QMetaType::Bool:
+            f.tag = TAG_BOOL; f.a = v.toBool() ? 1 : 0; break;
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::Short:
+        case QMetaType::UShort:
+        case QMetaType::Char:
+        case QMetaType::UChar:
+            f.tag = TAG_INT32; f.a = quint32(v.toInt()); break;
+        case QMetaType::LongLong:
+        case QMetaType::ULongLong:
+        case QMetaType::Long:
+        case QMetaType::ULong:
+            f.tag = TAG_INT64; f.a = quint64(v.toLongLong()); break;
+        case QMetaType::Double:
+        case QMetaType::Float:
+        {
+            const double d = v.toDouble();
+            f.tag = TAG_DOUBLE; std::memcpy(&f.a, &d, 8);
+            break;
+        }
+        case QMetaType::QColor:
+            f.tag = TAG_COLOR;
+            f.a = quint32(v.value<QColor>().rgba()); // 0xAARRGGBB
+            break;
+        case QMetaType::QPointF:
+        case QMetaType::QPoint:
+        {
+            const QPointF pt = v.toPointF();
+            const double x = pt.x();
+            const double y = pt.y();
+            f.tag = TAG_POINT; std::memcpy(&f.a, &x, 8); std::memcpy(&f.b, &y, 8);
+            break;
+        }
+        case QMetaType::QString:
+            f.tag = TAG_STRING; f.str = v.toString(); break;
+        default:
+            if (v.canConvert<QString>())
+            {
+                f.tag = TAG_STRING; f.str = v.toString();
+            }
+            break;
+        }
+
+        return f;
+    }
+
+    bool IsAssetIdentity(const char* name)
+    {
+        return std::strcmp(name, "assetDomain") == 0 || std::strcmp(name, "assetRegistryValue") == 0;
+    }
+
+    bool IsAssetPath(const char* name)
+    {
+        const size_t n = std::strlen(name);
+        return n >= 4 && std::memcmp(name + n - 4, "Path", 4) == 0;
+    }
 
-        const int countAt = w.pos();
-        w.U16(0); // field count, patched below
-        quint16 fieldCount = 0;
+    // Encodes one element record (name, UUID, components - not children) in
+    // the relocatable form of BakeCache::Node: every string id and asset
+    // index is local to the record and its offset is listed in patches.
+    //
+    // In the aligned (v5) layout every record, component header and field is
+    // padded to a multiple of 8 bytes relative to the record start. Records
+    // are placed at 8-aligned tree offsets, so relative alignment is absolute
+    // alignment and cached records stay relocatable.
+    struct NodeEncoder
+    {
+        BakeCache::Node node;
+        Writer w;
+        bool aligned = false;
+        QHash<QString, quint32> stringIndex;
+        QHash<QString, quint32> assetIndex;
+
+        void Str(const QString& s)
+        {
+            quint32 id;
+            auto it = stringIndex.find(s);
+            if (it != stringIndex.end())
+            {
+                id = it.value();
+            }
+            else
+            {
+                id = quint32(node.strings.size());
+                node.strings.push_back(s);
+                stringIndex.insert(s, id);
+            }
+
+            node.patches.push_back((quint32(w.pos()) << 2) | BakeCache::Node::PATCH_STRING);
+            w.U32(id);
+        }
+
+        void Asset(const QString& rel, const QString& domain, const QString& registry, bool atlasImage)
+        {
+            if (rel.isEmpty() && domain.isEmpty() && registry.isEmpty())
+            {
+                w.U32(kNoAsset);
+                return;
+            }
+
+            const QString key = domain + QChar(0x1F) + registry + QChar(0x1F) + rel;
+
+            quint32 idx;
+            auto it = assetIndex.find(key);
+            if (it != assetIndex.end())
+            {
+                idx = it.value();
+                node.assets[int(idx)].atlasImage &= atlasImage;
+            }
+            else
+            {
+                idx = quint32(node.assets.size());
+                node.assets.push_back(BakeCache::Node::AssetKey { rel, domain, registry, atlasImage });
+                assetIndex.insert(key, idx);
+            }
+
+            node.patches.push_back((quint32(w.pos()) << 2) | BakeCache::Node::PATCH_ASSET);
+            w.U32(idx);
+        }
+
+        void Schema(const BakeCache::Node::Schema& s)
+        {
+            quint32 idx = 0;
+            while (idx < quint32(node.schemas.size())
+                   && !(node.schemas[int(idx)].type == s.type
+                        && node.schemas[int(idx)].names == s.names
+                        && node.schemas[int(idx)].tags == s.tags))
+                ++idx;
+
+            if (idx == quint32(node.schemas.size()))
+                node.schemas.push_back(s);
+
+            node.patches.push_back((quint32(w.pos()) << 2) | BakeCache::Node::PATCH_SCHEMA);
+            w.U32(idx);
+        }
+    };
+
+    // Whether a path property holds a plain UI image that may be packed into
+    // an atlas page: Image/Icon/Button.imagePath and DragSlot.iconPath.
+    // Sprites keep their own sheet layout and fonts are never images.
+    bool IsAtlasImage(const QString& type, const char* name)
+    {
+        if (std::strcmp(name, "imagePath") == 0)
+            return type == QLatin1String("Image") || type == QLatin1String("Icon") || type == QLatin1String("Button");
+        if (std::strcmp(name, "iconPath") == 0)
+            return type == QLatin1String("DragSlot");
+        return false;
+    }
+
+    // Everything EncodeComponent and HashComponent need from a component
+    // class, resolved once per QMetaObject: which properties are emitted, in
+    // order, under which name and as what kind of field. Instances are then
+    // read by property index, with no per-instance name lookups or string
+    // compares.
+    struct ComponentPlan
+    {
+        struct Property
+        {
+            QMetaProperty meta;
+            bool assetPath = false;     // encoded as ASSET_REF
+            bool atlasImage = false;    // see IsAtlasImage
+            bool enumOrFlags = false;   // see IsEnumOrFlags
+        };
+
+        QString type;
+        QVector<Property> properties;
+        QVector<QString> names;         // per property, shared by every schema
+        int domainIndex = -1;           // assetDomain property, or -1
+        int registryIndex = -1;         // assetRegistryValue property, or -1
+    };
+
+    ComponentPlan BuildPlan(const Component* comp)
+    {
+        const QMetaObject* mo = comp->metaObject();
 
-        const QString domain   = comp->property("assetDomain").toString();
-        const QString registry = comp->property("assetRegistryValue").toString();
+        ComponentPlan plan;
+        plan.type = comp->GetTypeName();
 
         for (int i = mo->propertyOffset(); i < mo->propertyCount(); ++i)
         {
             const QMetaProperty p = mo->property(i);
-            const QString name = QString::fromLatin1(p.name());
 
             // The engine identity is folded into the asset record, not emitted
             // as plain fields.
-            if (name == QLatin1String("assetDomain") || name == QLatin1String("assetRegistryValue"))
-                continue;
-
-            w.U32(bake.Intern(name));
-
-            if (name.endsWith(QLatin1String("Path")))
+            if (IsAssetIdentity(p.name()))
             {
-                w.U8(TAG_ASSET_REF);
-                w.U32(bake.RegisterAsset(comp->property(p.name()).toString(), domain, registry));
-                ++fieldCount;
+                if (std::strcmp(p.name(), "assetDomain") == 0)
+                    plan.domainIndex = i;
+                else
+                    plan.registryIndex = i;
                 continue;
             }
 
-            const QVariant v = comp->property(p.name());
-
-            // Detect enum AND QFlags properties. p.isEnumType() only returns
-            // true when the flag is registered (Q_ENUM / Q_FLAG) in the SAME
-            // class as the Q_PROPERTY. AnchorFlags lives in EnumHolder, so
-            // TransformComponent's moc never marks its anchors/stretch
-            // properties as enum and they would otherwise fall through to
-            // canConvert<QString>(), which serialises QFlags(0) as "NONE" and
-            // composite bitmasks as "" - both useless to a runtime decoder.
-            //
-            // We also accept the QMetaType::IsEnumeration flag on the value
-            // and a defensive "...Flags" type-name check, which catches the
-            // externally-registered case.
-            const QByteArray typeName(p.typeName());
-            const bool looksLikeFlags = typeName.endsWith("Flags");
-            const bool isEnumOrFlags =
-                p.isEnumType()
-                || (v.metaType().flags() & QMetaType::IsEnumeration)
-                || looksLikeFlags;
-
-            if (isEnumOrFlags)
-            {
-                // Q_ENUM converts cleanly via toInt(); externally-registered
-                // QFlags often does not. QFlags<T> is layout-compatible with
-                // its underlying int, so fall back to a direct read of the
-                // stored value when the QVariant conversion fails.
-                bool ok = false;
-                int iv = v.toInt(&ok);
-                if ((!ok || (iv == 0 && v.isValid()))
-                    && v.constData()
-                    && v.metaType().sizeOf() == int(sizeof(int)))
-                {
-                    std::memcpy(&iv, v.constData(), sizeof(int));
-                }
+            ComponentPlan::Property prop;
+            prop.meta = p;
+            prop.assetPath = IsAssetPath(p.name());
+            prop.atlasImage = prop.assetPath && IsAtlasImage(plan.type, p.name());
+            prop.enumOrFlags = !prop.assetPath && IsEnumOrFlags(p);
+            plan.properties.push_back(prop);
+            plan.names.push_back(QString::fromLatin1(p.name()));
+        }
+
+        return plan;
+    }
+
+    // The plan of comp's class, built on first use. QMetaObjects are static,
+    // so plans live for the process and are shared by every bake (batch
+    // bakes run on several threads, hence the lock).
+    const ComponentPlan& PlanFor(const Component* comp)
+    {
+        static QReadWriteLock lock;
+        static std::unordered_map<const QMetaObject*, ComponentPlan> plans;
+
+        const QMetaObject* mo = comp->metaObject();
+        {
+            QReadLocker read(&lock);
+            auto it = plans.find(mo);
+            if (it != plans.end())
+                return it->second;
+        }
 
-                w.U8(TAG_INT32);
-                w.I32(iv);
+        QWriteLocker write(&lock);
+        // unordered_map never moves its elements, so the reference stays
+        // valid while other threads insert.
+        return plans.try_emplace(mo, BuildPlan(comp)).first->second;
+    }
+
+    // String value of the identity property at index, or empty.
+    QString IdentityValue(const Component* comp, int index)
+    {
+        return index < 0 ? QString() : comp->metaObject()->property(index).read(comp).toString();
+    }
+
+    // One property as EncodeComponent emits it: an asset path is encoded as
+    // TAG_ASSET_REF from assetPath, anything else from value.
+    struct EncodedField
+    {
+        FieldValue value;
+        QString assetPath;
+        bool atlasImage = false;
+    };
+
+    void EncodeValue(NodeEncoder& enc, const EncodedField& f, const QString& domain, const QString& registry)
+    {
+        Writer& w = enc.w;
+        switch (f.value.tag)
+        {
+        case TAG_BOOL:      w.U8(quint8(f.value.a));                            break;
+        case TAG_INT32:
+        case TAG_COLOR:     w.U32(quint32(f.value.a));                          break;
+        case TAG_INT64:
+        case TAG_DOUBLE:    w.U64(f.value.a);                                   break;
+        case TAG_POINT:     w.U64(f.value.a); w.U64(f.value.b);                 break;
+        case TAG_STRING:    enc.Str(f.value.str);                               break;
+        case TAG_ASSET_REF: enc.Asset(f.assetPath, domain, registry, f.atlasImage); break;
+        default:                                                                break;
+        }
+    }
+
+    // Value offsets of a schema's fields relative to the first value, and
+    // the size of the values block. Packed in v4; in v5 each value sits at
+    // its natural alignment (at most 8) and the block is padded to 8, which
+    // keeps the record a multiple of 8 bytes.
+    quint32 SchemaOffsets(const QVector<quint8>& tags, bool aligned, QVector<quint32>* offsets)
+    {
+        quint32 at = 0;
+        for (quint8 tag : tags)
+        {
+            const quint32 width = quint32(qMax(0, TagWidth(tag)));
+            if (aligned && width > 1)
+                at = AlignUp(at, qMin<quint32>(width, 8));
+            offsets->push_back(at);
+            at += width;
+        }
+        return aligned ? AlignUp(at, kSectionAlignment) : at;
+    }
+
+    void EncodeComponent(NodeEncoder& enc, const Component* comp, bool useSchemas)
+    {
+        Writer& w = enc.w;
+        const ComponentPlan& plan = PlanFor(comp);
+
+        const QString domain   = IdentityValue(comp, plan.domainIndex);
+        const QString registry = IdentityValue(comp, plan.registryIndex);
+
+        QVector<EncodedField> fields(plan.properties.size());
+        for (int i = 0; i < plan.properties.size(); ++i)
+        {
+            const ComponentPlan::Property& p = plan.properties[i];
+            EncodedField& f = fields[i];
+            if (p.assetPath)
+            {
+                f.value.tag = TAG_ASSET_REF;
+                f.assetPath = p.meta.read(comp).toString();
+                f.atlasImage = p.atlasImage;
             }
             else
             {
-                // Switch on the VALUE's metatype, not the declared property
-                // metatype: this reliably reports QPointF for Transform.position
-                // and Transform.scale (a stale/odd declared metatype would
-                // otherwise drop them to the stringify fallback).
-                switch (v.metaType().id())
-                {
-                case QMetaType::Bool:
-                    w.U8(TAG_BOOL);  w.U8(v.toBool() ? 1 : 0); break;
-                case QMetaType::Int:
-                case QMetaType::UInt:
-                case QMetaType::Short:
-                case QMetaType::UShort:
-                case QMetaType::Char:
-                case QMetaType::UChar:
-                    w.U8(TAG_INT32); w.I32(v.toInt()); break;
-                case QMetaType::LongLong:
-                case QMetaType::ULongLong:
-                case QMetaType::Long:
-                case QMetaType::ULong:
-                    w.U8(TAG_INT64); w.I64(v.toLongLong()); break;
-                case QMetaType::Double:
-                case QMetaType::Float:
-                    w.U8(TAG_DOUBLE); w.F64(v.toDouble()); break;
-                case QMetaType::QColor:
-                    w.U8(TAG_COLOR);
-                    w.U32(quint32(v.value<QColor>().rgba())); // 0xAARRGGBB
-                    break;
-                case QMetaType::QPointF:
-                {
-                    const QPointF pt = v.toPointF();
-                    w.U8(TAG_POINT); w.F64(pt.x()); w.F64(pt.y());
-                    break;
-                }
-                case QMetaType::QPoint:
-                {
-                    const QPoint pt = v.toPoint();
-                    w.U8(TAG_POINT); w.F64(pt.x()); w.F64(pt.y());
-                    break;
-                }
-                case QMetaType::QString:
-                    w.U8(TAG_STRING); w.U32(bake.Intern(v.toString())); break;
-                default:
-                    if (v.canConvert<QString>())
-                    {
-                        w.U8(TAG_STRING); w.U32(bake.Intern(v.toString()));
-                    }
-                    else
-                    {
-                        w.U8(TAG_NONE);
-                    }
-                    break;
-                }
+                f.value = ClassifyValue(p.enumOrFlags, p.meta.read(comp));
+            }
+        }
+
+        enc.Str(plan.type);
+
+        const int lenAt = w.pos();
+        w.U32(0); // payload length, patched below
+
+        // Schema form: the (name, tag) list goes to the shared schema table
+        // and the record keeps only the values. A component without fields
+        // gains nothing from it and stays TLV, as does one whose values would
+        // not fit the table's u16 offsets.
+        BakeCache::Node::Schema schema;
+        QVector<quint32> offsets;
+        quint32 valuesSize = 0;
+        if (useSchemas && !fields.isEmpty() && fields.size() < kSchemaRecord)
+        {
+            schema.type = plan.type;
+            schema.names = plan.names;
+            for (const EncodedField& f : fields)
+                schema.tags.push_back(f.value.tag);
+            valuesSize = SchemaOffsets(schema.tags, enc.aligned, &offsets);
+        }
+
+        if (!offsets.isEmpty() && valuesSize <= 0xFFFF)
+        {
+            w.U16(kSchemaRecord);
+            if (enc.aligned)
+                w.U16(0);
+            enc.Schema(schema);
+
+            const int valuesAt = w.pos();
+            for (int i = 0; i < fields.size(); ++i)
+            {
+                while (w.pos() < valuesAt + int(offsets[i]))
+                    w.U8(0);
+                EncodeValue(enc, fields[i], domain, registry);
             }
+            while (w.pos() < valuesAt + int(valuesSize))
+                w.U8(0);
+        }
+        else
+        {
+            w.U16(quint16(fields.size()));
+            if (enc.aligned)
+                w.Align(8);
 
-            ++fieldCount;
+            for (int i = 0; i < fields.size(); ++i)
+            {
+                enc.Str(plan.names[i]);
+                w.U8(fields[i].value.tag);
+                if (enc.aligned)
+                    w.Align(8);
+                EncodeValue(enc, fields[i], domain, registry);
+                if (enc.aligned)
+                    w.Align(8);
+            }
         }
 
-        // Back-fill count and payload length (everything after the length slot).
-        w.buffer()[countAt + 0] = char(fieldCount);
-        w.buffer()[countAt + 1] = char(fieldCount >> 8);
+        // Back-fill the payload length (everything after the length slot).
         w.PatchU32(lenAt, quint32(w.pos() - (lenAt + 4)));
     }
 
-    void WriteElement(Bake& bake, Writer& w, const UiElement* el)
+    BakeCache::Node EncodeNode(const UiElement* el, bool aligned, bool useSchemas)
     {
-        w.U32(bake.Intern(el->GetName()));
+        NodeEncoder enc;
+        enc.aligned = aligned;
+
+        enc.Str(el->GetName());
+
+        const std::vector<Component*> comps = el->GetComponents();
+
+        // v5 moves the component count (plus a reserved u16) ahead of the
+        // UUID so the 24-byte element header keeps 8-byte alignment.
+        if (aligned)
+        {
+            enc.w.U16(quint16(comps.size()));
+            enc.w.U16(0);
+        }
 
         QByteArray uuid = el->GetId().toRfc4122(); // exactly 16 bytes
         uuid.resize(16);
-        w.Raw(uuid.constData(), 16);
+        enc.w.Raw(uuid.constData(), 16);
 
-        const std::vector<Component*> comps = el->GetComponents();
-        w.U16(quint16(comps.size()));
+        if (!aligned)
+            enc.w.U16(quint16(comps.size()));
         for (const Component* c : comps)
-            WriteComponent(bake, w, c);
+            EncodeComponent(enc, c, useSchemas);
+
+        enc.node.bytes = enc.w.buffer();
+        return enc.node;
+    }
+
+    quint64 HashStr(quint64 h, const QString& s)
+    {
+        const quint32 len = quint32(s.size());
+        h = Hash64(reinterpret_cast<const char*>(&len), 4, h);
+        return Hash64(reinterpret_cast<const char*>(s.utf16()), qsizetype(len) * 2, h);
+    }
+
+    // Content hash of everything EncodeComponent reads from comp.
+    quint64 HashComponent(const Component* comp)
+    {
+        const ComponentPlan& plan = PlanFor(comp);
+        quint64 h = HashStr(kHashSeed, plan.type);
+        h = HashStr(h, IdentityValue(comp, plan.domainIndex));
+        h = HashStr(h, IdentityValue(comp, plan.registryIndex));
+
+        for (int i = 0; i < plan.properties.size(); ++i)
+        {
+            const ComponentPlan::Property& p = plan.properties[i];
+            h = HashStr(h, plan.names[i]);
+
+            const QVariant v = p.meta.read(comp);
+
+            if (p.assetPath)
+            {
+                h = HashStr(h, v.toString());
+                continue;
+            }
+
+            const FieldValue f = ClassifyValue(p.enumOrFlags, v);
+            const quint8 tag = f.tag;
+            h = Hash64(reinterpret_cast<const char*>(&tag), 1, h);
+            h = Hash64(reinterpret_cast<const char*>(&f.a), 8, h);
+            h = Hash64(reinterpret_cast<const char*>(&f.b), 8, h);
+            if (tag == TAG_STRING)
+                h = HashStr(h, f.str);
+        }
+
+        return h;
+    }
+
+    // Cache key of an element record: its own inputs only (children are
+    // separate records), salted with the container version and record form
+    // so records from another encoding never match.
+    quint64 NodeKey(BakeCache& cache, const UiElement* el, bool aligned, bool useSchemas)
+    {
+        quint64 h = Hash64(aligned ? kMagicV5 : kMagic, 4, kHashSeed);
+        h = Hash64(reinterpret_cast<const char*>(aligned ? &kVersionV5 : &kVersion), 2, h);
+        if (useSchemas)
+            h = Hash64(reinterpret_cast<const char*>(&kFlagSchemas), 2, h);
+        h = HashStr(h, el->GetName());
+
+        const QByteArray uuid = el->GetId().toRfc4122();
+        h = Hash64(uuid.constData(), uuid.size(), h);
+
+        for (const Component* c : el->GetComponents())
+        {
+            const quint64 ch = cache.ComponentHash(c, c->Revision(), [c]() { return HashComponent(c); });
+            h = Hash64(reinterpret_cast<const char*>(&ch), 8, h);
+        }
+
+        return h;
+    }
+
+    // Appends a relocatable element record to the tree, rewriting its local
+    // string ids / asset indexes / schema ids to global ones. Interning
+    // happens in record byte order, so ids come out exactly as a direct
+    // pre-order walk would assign them.
+    void Splice(Bake& bake, Writer& tree, const BakeCache::Node& node)
+    {
+        const int base = tree.pos();
+        tree.Raw(node.bytes.constData(), node.bytes.size());
+
+        const uchar* src = reinterpret_cast<const uchar*>(node.bytes.constData());
+
+        for (quint32 patch : node.patches)
+        {
+            const quint32 off = patch >> 2;
+            const quint32 local = quint32(src[off])
+                                | (quint32(src[off + 1]) << 8)
+                                | (quint32(src[off + 2]) << 16)
+                                | (quint32(src[off + 3]) << 24);
+
+            quint32 global;
+            switch (patch & 3u)
+            {
+            case BakeCache::Node::PATCH_ASSET:
+            {
+                const BakeCache::Node::AssetKey& a = node.assets[int(local)];
+                global = bake.RegisterAsset(a.path, a.domain, a.registry, a.atlasImage);
+                break;
+            }
+            case BakeCache::Node::PATCH_SCHEMA:
+                global = bake.RegisterSchema(node.schemas[int(local)]);
+                break;
+            default:
+                global = bake.Intern(node.strings[int(local)]);
+                break;
+            }
+
+            tree.PatchU32(base + int(off), global);
+        }
+    }
+
+    void WriteElement(Bake& bake, Writer& w, const UiElement* el, quint32 parent)
+    {
+        // A cancelled walk leaves the tree short; BakeFile discards it.
+        if (bake.Cancelled())
+            return;
+
+        const quint32 self = quint32(bake.spans.size());
+        bake.spans.push_back(Bake::Span { el->GetId().toRfc4122(), parent, quint32(w.pos()), 0 });
+
+        if (BakeCache* cache = bake.bakeCache)
+        {
+            const quint64 key = NodeKey(*cache, el, bake.aligned, bake.useSchemas);
+
+            if (const BakeCache::Node* hit = cache->FindNode(key))
+            {
+                Splice(bake, w, *hit);
+            }
+            else
+            {
+                const BakeCache::Node node = EncodeNode(el, bake.aligned, bake.useSchemas);
+                Splice(bake, w, node);
+                cache->InsertNode(key, node);
+            }
+        }
+        else
+        {
+            Splice(bake, w, EncodeNode(el, bake.aligned, bake.useSchemas));
+        }
 
         QVector<UiElement*> kids;
         for (QObject* o : el->children())
@@ -243,76 +807,888 @@ namespace
                 kids.push_back(ce);
 
         w.U32(quint32(kids.size()));
+        const int sizeAt = w.pos();
+        if (bake.subtreeSizes)
+            w.U32(0);
+        if (bake.aligned)
+            w.Align(8);
+
+        const int childrenAt = w.pos();
         for (const UiElement* ce : kids)
-            WriteElement(bake, w, ce);
+            WriteElement(bake, w, ce, self);
+
+        if (bake.subtreeSizes)
+            w.PatchU32(sizeAt, quint32(w.pos() - childrenAt));
+
+        Bake::Span& span = bake.spans[int(self)];
+        span.size = quint32(w.pos()) - span.offset;
+
+        if (bake.progress)
+            bake.progress->Advance();
     }
-}
 
-bool UiBinWriter::Write(const SceneDocument* doc, const QString& filePath)
-{
-    if (!doc || !doc->GetRoot())
-        return false;
+    // Points every asset whose bytes equal an earlier asset's at that one,
+    // so the blob is stored - and later atlased, decoded, compressed and
+    // read - once, while each record keeps its own identity. Runs before
+    // every stage that rewrites blobs; those then skip the sharers, whose
+    // data is cleared here.
+    void ShareAssetBlobs(Bake& bake)
+    {
+        // Only assets the AssetCache did not hash (no cache, or bytes read
+        // another way) are hashed here.
+        const int n = int(bake.assets.size());
+        QVector<quint64> hashes(n);
+        quint64* h = hashes.data();
+        const Bake::Asset* assets = bake.assets.constData();
+        ParallelFor(n, [h, assets](int i)
+        {
+            const Bake::Asset& a = assets[i];
+            h[i] = a.hashed ? a.hash : Hash64(a.data.constData(), a.data.size());
+        });
 
-    Bake bake;
-    bake.baseDir = doc->GetBaseDir();
-    bake.Intern(QString()); // id 0 == empty string, by contract
-
-    Writer tree;
-    WriteElement(bake, tree, doc->GetRoot());
-
-    // --- String table -----------------------------------------------------
-    Writer strW;
-    for (const QString& s : bake.strings)
-    {
-        const QByteArray u = s.toUtf8();
-        strW.U32(quint32(u.size()));
-        strW.Raw(u.constData(), u.size());
-    }
-
-    // --- Asset table ------------------------------------------------------
-    Writer assetW;
-    for (const Bake::Asset& a : bake.assets)
-    {
-        assetW.U32(a.domainId);
-        assetW.U32(a.registryId);
-        assetW.U32(quint32(a.data.size()));
-        assetW.Raw(a.data.constData(), a.data.size());
-    }
-
-    const quint32 strOff   = kHeaderSize;
-    const quint32 assetOff  = strOff + quint32(strW.buffer().size());
-    const quint32 treeOff   = assetOff + quint32(assetW.buffer().size());
-    const quint32 fileSize  = treeOff + quint32(tree.buffer().size());
-
-    Writer hdr;
-    hdr.Raw(kMagic, 4);
-    hdr.U16(kVersion);
-    hdr.U16(0);                              // flags
-    hdr.U32(strOff);
-    hdr.U32(quint32(bake.strings.size()));
-    hdr.U32(assetOff);
-    hdr.U32(quint32(bake.assets.size()));
-    hdr.U32(treeOff);
-    hdr.U32(fileSize);
-
-    // Assemble everything that follows the header into a single body buffer
-    // and apply the cosmetic XOR mask so the file is undecipherable in a hex
-    // dump. Header offsets/counts stay clear; a v4 reader demasks the same
-    // range before parsing. See uibin::Obfuscate.
-    QByteArray body;
-    body.reserve(int(fileSize - kHeaderSize));
-    body.append(strW.buffer());
-    body.append(assetW.buffer());
-    body.append(tree.buffer());
-    Obfuscate(body.data(), body.size());
-
-    QFile out(filePath);
-    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
-        return false;
+        // Hash collisions are confirmed byte for byte.
+        QMultiHash<quint64, quint32> owners;
+        for (int i = 0; i < n; ++i)
+        {
+            Bake::Asset& a = bake.assets[i];
+            if (a.data.isEmpty())
+                continue;
 
-    out.write(hdr.buffer());
-    out.write(body);
-    out.close();
+            quint32 owner = kNoAsset;
+            for (auto it = owners.constFind(h[i]); it != owners.constEnd() && it.key() == h[i]; ++it)
+            {
+                if (bake.assets[int(it.value())].data == a.data)
+                {
+                    owner = it.value();
+                    break;
+                }
+            }
+
+            if (owner == kNoAsset)
+            {
+                owners.insert(h[i], quint32(i));
+                continue;
+            }
+
+            // Pack the shared blob only if every record using it may be.
+            Bake::Asset& o = bake.assets[int(owner)];
+            o.atlasImage &= a.atlasImage;
+            a.atlasImage = false;
+            a.sharedWith = owner;
+            a.data.clear();
+            bake.sharedBlobs = true;
+        }
+    }
+
+    // Turns each sharer into its CODEC_SHARED record: the owner's index as
+    // the stored bytes, and the owner's decoded length.
+    void WriteSharedRecords(Bake& bake)
+    {
+        for (Bake::Asset& a : bake.assets)
+        {
+            if (a.sharedWith == kNoAsset)
+                continue;
+
+            Writer w;
+            w.U32(a.sharedWith);
+            a.data = w.buffer();
+            a.rawSize = bake.assets[int(a.sharedWith)].rawSize;
+            a.codec = CODEC_SHARED;
+        }
+    }
+
+    // Packs every atlas-eligible image asset into shared pages. Each page is
+    // appended to the asset table as a PNG with an empty identity; packed
+    // assets keep their record (and identity) but lose their bytes, and the
+    // ATLS extension maps each of them to (page asset, sub-rect). Images that
+    // fail to decode or exceed half a page in either axis stay standalone.
+    void BuildAtlas(Bake& bake, const UiBinWriteOptions& options)
+    {
+        struct Item
+        {
+            quint32 asset;
+            QImage image;
+            int page = -1;
+            QPoint pos;
+        };
+
+        QVector<Item> items;
+        for (int i = 0; i < bake.assets.size(); ++i)
+            if (bake.assets[i].atlasImage)
+                items.push_back(Item { quint32(i), QImage() });
+
+        if (items.isEmpty())
+            return;
+
+        const int pageSize = qBound(64, options.atlasPageSize, 0xFFFF);
+        const int padding = qBound(0, options.atlasPadding, 64);
+
+        Item* decode = items.data();
+        const Bake::Asset* assets = bake.assets.constData();
+        ParallelFor(int(items.size()), [decode, assets](int i)
+        {
+            const QImage img = QImage::fromData(assets[decode[i].asset].data);
+            if (!img.isNull())
+                decode[i].image = img.convertToFormat(QImage::Format_ARGB32);
+        });
+
+        items.erase(std::remove_if(items.begin(), items.end(), [pageSize](const Item& it)
+        {
+            return it.image.isNull() || it.image.width() > pageSize / 2 || it.image.height() > pageSize / 2;
+        }), items.end());
+
+        if (items.isEmpty())
+            return;
+
+        // Tallest first keeps the skyline flat.
+        std::stable_sort(items.begin(), items.end(), [](const Item& a, const Item& b)
+        {
+            if (a.image.height() != b.image.height())
+                return a.image.height() > b.image.height();
+            return a.image.width() > b.image.width();
+        });
+
+        QVector<AtlasPacker> packers;
+        for (Item& it : items)
+        {
+            const int w = it.image.width() + padding;
+            const int h = it.image.height() + padding;
+
+            for (int p = 0; p < packers.size() && it.page < 0; ++p)
+                if (packers[p].Insert(w, h, &it.pos))
+                    it.page = p;
+
+            if (it.page < 0)
+            {
+                packers.push_back(AtlasPacker(pageSize, pageSize));
+                if (packers.back().Insert(w, h, &it.pos))
+                    it.page = int(packers.size()) - 1;
+            }
+        }
+
+        // Compose and encode the pages, cropped to their used extent.
+        QVector<QByteArray> pages(packers.size());
+        const Item* placed = items.constData();
+        const int placedCount = int(items.size());
+        const AtlasPacker* pk = packers.constData();
+        QByteArray* out = pages.data();
+        ParallelFor(int(packers.size()), [placed, placedCount, pk, out](int p)
+        {
+            QImage page(pk[p].UsedWidth(), pk[p].UsedHeight(), QImage::Format_ARGB32);
+            page.fill(Qt::transparent);
+
+            for (int i = 0; i < placedCount; ++i)
+            {
+                const Item& it = placed[i];
+                if (it.page != p)
+                    continue;
+
+                const qsizetype rowBytes = qsizetype(it.image.width()) * 4;
+                for (int y = 0; y < it.image.height(); ++y)
+                    std::memcpy(page.scanLine(it.pos.y() + y) + qsizetype(it.pos.x()) * 4, it.image.constScanLine(y), size_t(rowBytes));
+            }
+
+            QBuffer buf(&out[p]);
+            buf.open(QIODevice::WriteOnly);
+            page.save(&buf, "PNG");
+        });
+
+        const quint32 firstPage = quint32(bake.assets.size());
+        for (const QByteArray& png : pages)
+        {
+            Bake::Asset a;
+            a.domainId = bake.Intern(QString());
+            a.registryId = a.domainId;
+            a.data = png;
+            a.rawSize = quint32(png.size());
+            bake.assets.push_back(a);
+        }
+
+        // A packed blob's sharers (ShareAssetBlobs) are placed with it and
+        // become plain packed records.
+        struct Placement { quint32 asset; const Item* item; };
+        QVector<Placement> placements;
+        QHash<quint32, const Item*> packed;
+        for (const Item& it : items)
+        {
+            if (it.page < 0)
+                continue;
+            placements.push_back(Placement { it.asset, &it });
+            packed.insert(it.asset, &it);
+        }
+        for (int i = 0; i < bake.assets.size(); ++i)
+        {
+            Bake::Asset& a = bake.assets[i];
+            if (a.sharedWith == kNoAsset || !packed.contains(a.sharedWith))
+                continue;
+            placements.push_back(Placement { quint32(i), packed.value(a.sharedWith) });
+            a.sharedWith = kNoAsset;
+        }
+
+        std::sort(placements.begin(), placements.end(), [](const Placement& a, const Placement& b) { return a.asset < b.asset; });
+
+        Writer w;
+        w.U32(0);  // count, patched below
+        quint32 count = 0;
+        for (const Placement& pl : placements)
+        {
+            const Item& it = *pl.item;
+
+            Bake::Asset& a = bake.assets[int(pl.asset)];
+            a.data.clear();
+            a.rawSize = 0;
+
+            w.U32(pl.asset);
+            w.U32(firstPage + quint32(it.page));
+            w.U16(quint16(it.pos.x()));
+            w.U16(quint16(it.pos.y()));
+            w.U16(quint16(it.image.width()));
+            w.U16(quint16(it.image.height()));
+            ++count;
+        }
+        w.PatchU32(0, count);
+
+        bake.extensions.push_back(Bake::Extension { QByteArray(kExtAtlas, 4), w.buffer() });
+    }
+
+    // Decodes every asset QImage can read - the same loader the editor
+    // previews with - into CODEC_PIXELS: a pixel header, then premultiplied
+    // RGBA8 rows. Fonts and anything else that does not decode are left as
+    // they are.
+    void DecodeImages(Bake& bake)
+    {
+        Bake::Asset* assets = bake.assets.data();
+
+        ParallelFor(int(bake.assets.size()), [assets](int i)
+        {
+            Bake::Asset& a = assets[i];
+            if (a.data.isEmpty() || a.codec != CODEC_STORED)
+                return;
+
+            const QImage img = QImage::fromData(a.data).convertToFormat(QImage::Format_RGBA8888_Premultiplied);
+            if (img.isNull())
+                return;
+
+            const int row = img.width() * 4;
+            if (qint64(row) * img.height() + kPixelHeaderSize > std::numeric_limits<int>::max())
+                return;
+
+            Writer w;
+            w.buffer().reserve(int(kPixelHeaderSize) + row * img.height());
+            w.U32(quint32(img.width()));
+            w.U32(quint32(img.height()));
+            w.U32(quint32(row));
+            w.U16(PIXELS_RGBA8_PREMULTIPLIED);
+            w.U16(0);
+            for (int y = 0; y < img.height(); ++y)
+                w.Raw(reinterpret_cast<const char*>(img.constScanLine(y)), row);
+
+            a.data = w.buffer();
+            a.rawSize = quint32(a.data.size());
+            a.codec = CODEC_PIXELS;
+        });
+    }
+
+    // Text-drawing components and the properties holding the strings they
+    // draw. TextInput content changes at runtime, so its faces are editable.
+    struct TextSource
+    {
+        const char* type;
+        const char* props[2];
+        bool editable;
+    };
+
+    const TextSource kTextSources[] =
+    {
+        { "Text",      { "text", nullptr },        false },
+        { "Button",    { "text", nullptr },        false },
+        { "Dropdown",  { "options", nullptr },     false },
+        { "Tooltip",   { "tooltipText", nullptr }, false },
+        { "TextInput", { "text", "placeholder" },  true  },
+    };
+
+    // The asset a component's fontPath was baked to (found under the key
+    // RegisterAsset used) and its bytes, or kNoAsset.
+    quint32 FontAsset(const Bake& bake, const Component* c, QByteArray* data)
+    {
+        const QString fontPath = c->property("fontPath").toString();
+        if (fontPath.isEmpty())
+            return kNoAsset;
+
+        const QString key = bake.AssetKey(fontPath, c->property("assetDomain").toString(),
+                                          c->property("assetRegistryValue").toString());
+        const quint32 index = bake.assetIndex.value(key, kNoAsset);
+        if (index != kNoAsset)
+            *data = bake.BlobOf(index).data;
+        return index;
+    }
+
+    void CollectText(Bake& bake, GlyphAtlasBuilder& glyphs, const UiElement* el)
+    {
+        for (const Component* c : el->GetComponents())
+        {
+            const QString type = c->GetTypeName();
+            for (const TextSource& src : kTextSources)
+            {
+                if (type != QLatin1String(src.type))
+                    continue;
+
+                const QString family = c->property("fontFamily").toString();
+                const int pixelSize = c->property("pixelSize").toInt();
+
+                QByteArray fontData;
+                const quint32 fontAsset = FontAsset(bake, c, &fontData);
+
+                for (const char* prop : src.props)
+                    if (prop)
+                        glyphs.Add(bake.Intern(family), family, fontAsset, fontData, pixelSize, c->property(prop).toString(), src.editable);
+            }
+        }
+
+        for (QObject* o : el->children())
+            if (auto* ce = qobject_cast<UiElement*>(o))
+                CollectText(bake, glyphs, ce);
+    }
+
+    // Rasterizes the glyphs the scenes' text uses into per-(face, size)
+    // coverage pages, appended as PNG assets with an empty identity, and
+    // emits the GLYF extension describing them. A bundle gets one set of
+    // pages, so a face its screens share is rasterized once.
+    void BuildGlyphs(Bake& bake, const QVector<UiBinScene>& scenes, const UiBinWriteOptions& options)
+    {
+        GlyphAtlasBuilder glyphs(options.atlasPageSize, options.atlasPadding);
+        for (const UiBinScene& scene : scenes)
+        {
+            bake.baseDir = scene.doc->GetBaseDir();
+            CollectText(bake, glyphs, scene.doc->GetRoot());
+        }
+        if (glyphs.IsEmpty())
+            return;
+
+        const QVector<QByteArray> pages = glyphs.Build();
+
+        const quint32 firstPage = quint32(bake.assets.size());
+        for (const QByteArray& png : pages)
+        {
+            Bake::Asset a;
+            a.domainId = bake.Intern(QString());
+            a.registryId = a.domainId;
+            a.data = png;
+            a.rawSize = quint32(png.size());
+            bake.assets.push_back(a);
+        }
+
+        bake.extensions.push_back(Bake::Extension { QByteArray(kExtGlyphs, 4), glyphs.Section(firstPage) });
+    }
+
+    // Shapes the label of every Text/Button, numbering elements in the same
+    // pre-order as the tree and components by their index on the element.
+    void CollectRuns(const Bake& bake, TextRunBuilder& runs, const UiElement* el, quint32& element)
+    {
+        const quint32 self = element++;
+
+        const std::vector<Component*> comps = el->GetComponents();
+        for (size_t i = 0; i < comps.size(); ++i)
+        {
+            const Component* c = comps[i];
+            const QString type = c->GetTypeName();
+            if (type != QLatin1String("Text") && type != QLatin1String("Button"))
+                continue;
+
+            QByteArray fontData;
+            const quint32 fontAsset = FontAsset(bake, c, &fontData);
+            runs.Add(self, quint16(i), fontAsset, fontData, c->property("fontFamily").toString(),
+                     c->property("pixelSize").toInt(), c->property("text").toString());
+        }
+
+        for (QObject* o : el->children())
+            if (auto* ce = qobject_cast<UiElement*>(o))
+                CollectRuns(bake, runs, ce, element);
+    }
+
+    void BuildTextRuns(Bake& bake, const UiElement* root)
+    {
+        TextRunBuilder runs;
+        quint32 element = 0;
+        CollectRuns(bake, runs, root, element);
+
+        if (!runs.IsEmpty())
+            bake.extensions.push_back(Bake::Extension { QByteArray(kExtTextRuns, 4), runs.Section() });
+    }
+
+    void BuildLayout(Bake& bake, const UiElement* root, const UiBinWriteOptions& options)
+    {
+        ResolvedLayoutBuilder layout;
+        for (const QSize& target : options.layoutTargets)
+            layout.AddTarget(root, target.width(), target.height());
+
+        if (!layout.IsEmpty())
+            bake.extensions.push_back(Bake::Extension { QByteArray(kExtLayout, 4), layout.Section() });
+    }
+
+    void BuildElementIndex(Bake& bake)
+    {
+        ElementIndexBuilder index;
+        for (const Bake::Span& s : bake.spans)
+            index.Add(s.uuid, s.parent, s.offset, s.size);
+
+        bake.extensions.push_back(Bake::Extension { QByteArray(kExtElementIndex, 4), index.Section() });
+    }
+
+    // Runs last among the sections that intern strings, so it covers the
+    // whole table.
+    void BuildStringLookup(Bake& bake)
+    {
+        StringLookupBuilder lookup;
+        for (const QString& s : bake.strings)
+            lookup.Add(s.toUtf8());
+
+        bake.extensions.push_back(Bake::Extension { QByteArray(kExtStringLookup, 4), lookup.Section() });
+    }
+
+    // zlib-compresses every stored asset blob in parallel, keeping the raw
+    // bytes of any that would not shrink. Decoded pixels stay uncompressed
+    // so they can be used straight from the file.
+    void CompressAssets(Bake& bake)
+    {
+        Bake::Asset* assets = bake.assets.data();
+
+        ParallelFor(int(bake.assets.size()), [assets](int i)
+        {
+            Bake::Asset& a = assets[i];
+            if (a.data.isEmpty() || a.codec != CODEC_STORED)
+                return;
+
+            const QByteArray z = qCompress(a.data);
+            if (z.size() < a.data.size())
+            {
+                a.data = z;
+                a.codec = CODEC_ZLIB;
+            }
+        });
+    }
+
+    // Whether asset records carry a codec (kFlagAssetCodecs).
+    bool UsesCodecs(const Bake& bake, const UiBinWriteOptions& options)
+    {
+        return options.compressAssets || options.decodeImages || bake.sharedBlobs;
+    }
+
+    quint32 ExtensionDirectorySize(const Bake& bake)
+    {
+        if (bake.extensions.isEmpty())
+            return 0;
+        return AlignUp(4 + quint32(bake.extensions.size()) * kExtensionEntrySize, kSectionAlignment);
+    }
+
+    // The directory that follows the header, given each section's offset.
+    QByteArray ExtensionDirectory(const Bake& bake, const QVector<quint64>& offsets)
+    {
+        Writer w;
+        w.U32(quint32(bake.extensions.size()));
+        for (int i = 0; i < bake.extensions.size(); ++i)
+        {
+            w.Raw(bake.extensions[i].tag.constData(), 4);
+            w.U32(quint32(offsets[i]));
+            w.U32(quint32(bake.extensions[i].data.size()));
+        }
+        w.Align(int(kSectionAlignment));
+        return w.buffer();
+    }
+
+    // The schema table that follows the extension directory, or empty when
+    // no record uses the schema form.
+    QByteArray SchemaTable(const Bake& bake)
+    {
+        if (bake.schemas.isEmpty())
+            return QByteArray();
+
+        Writer w;
+        w.U32(quint32(bake.schemas.size()));
+        for (const Bake::Schema& s : bake.schemas)
+        {
+            QVector<quint32> offsets;
+            const quint32 valuesSize = SchemaOffsets(s.tags, bake.aligned, &offsets);
+
+            w.U32(s.typeId);
+            w.U16(quint16(s.nameIds.size()));
+            w.U16(quint16(valuesSize));
+            for (int i = 0; i < s.nameIds.size(); ++i)
+            {
+                w.U32(s.nameIds[i]);
+                w.U8(s.tags[i]);
+                w.U8(0);
+                w.U16(quint16(offsets[i]));
+            }
+        }
+        w.Align(int(kSectionAlignment));
+        return w.buffer();
+    }
+
+    // v4: sections packed back to back, always masked. Extension sections,
+    // if any, follow the tree.
+    QByteArray AssembleV4(const Bake& bake, const Writer& tree, bool codecs)
+    {
+        // --- String table -------------------------------------------------
+        Writer strW;
+        for (const QString& s : bake.strings)
+        {
+            const QByteArray u = s.toUtf8();
+            strW.U32(quint32(u.size()));
+            strW.Raw(u.constData(), u.size());
+        }
+
+        // --- Asset table --------------------------------------------------
+        Writer assetW;
+        for (const Bake::Asset& a : bake.assets)
+        {
+            assetW.U32(a.domainId);
+            assetW.U32(a.registryId);
+            if (codecs)
+            {
+                assetW.U8(a.codec);
+                assetW.U32(a.rawSize);
+            }
+            assetW.U32(quint32(a.data.size()));
+            assetW.Raw(a.data.constData(), a.data.size());
+        }
+
+        const QByteArray schemas = SchemaTable(bake);
+        const quint32 dirSize  = ExtensionDirectorySize(bake);
+        const quint32 strOff   = kHeaderSize + dirSize + quint32(schemas.size());
+        const quint32 assetOff  = strOff + quint32(strW.buffer().size());
+        const quint32 treeOff   = assetOff + quint32(assetW.buffer().size());
+
+        QVector<quint64> extOff;
+        quint32 fileSize = treeOff + quint32(tree.buffer().size());
+        for (const Bake::Extension& e : bake.extensions)
+        {
+            extOff.push_back(fileSize);
+            fileSize += quint32(e.data.size());
+        }
+
+        quint16 flags = 0;
+        if (codecs)
+            flags |= kFlagAssetCodecs;
+        if (dirSize)
+            flags |= kFlagExtensions;
+        if (!schemas.isEmpty())
+            flags |= kFlagSchemas;
+        if (bake.subtreeSizes)
+            flags |= kFlagSubtreeSizes;
+
+        Writer hdr;
+        hdr.Raw(kMagic, 4);
+        hdr.U16(kVersion);
+        hdr.U16(flags);
+        hdr.U32(strOff);
+        hdr.U32(quint32(bake.strings.size()));
+        hdr.U32(assetOff);
+        hdr.U32(quint32(bake.assets.size()));
+        hdr.U32(treeOff);
+        hdr.U32(fileSize);
+
+        // Assemble everything that follows the header into a single body
+        // buffer and apply the cosmetic XOR mask so the file is undecipherable
+        // in a hex dump. Header offsets/counts stay clear; a v4 reader demasks
+        // the same range before parsing. See uibin::Obfuscate.
+        QByteArray body;
+        body.reserve(int(fileSize - kHeaderSize));
+        if (dirSize)
+            body.append(ExtensionDirectory(bake, extOff));
+        body.append(schemas);
+        body.append(strW.buffer());
+        body.append(assetW.buffer());
+        body.append(tree.buffer());
+        for (const Bake::Extension& e : bake.extensions)
+            body.append(e.data);
+        Obfuscate(body.data(), body.size());
+
+        return hdr.buffer() + body;
+    }
+
+    // v5: header, [extension directory,] [schema table,] string index +
+    // UTF-8 pool, fixed asset records, tree, [extension sections,] then the
+    // blobs, each at an assetAlignment boundary. All offsets are absolute
+    // so a mapped file is usable as is. Returns an empty array if the file
+    // would not fit the reader's 32-bit signed offsets.
+    QByteArray AssembleV5(const Bake& bake, const Writer& tree, const UiBinWriteOptions& options)
+    {
+        quint32 blobAlign = options.assetAlignment;
+        if (blobAlign < kSectionAlignment || (blobAlign & (blobAlign - 1)) != 0)
+            blobAlign = kAssetAlignment;
+
+        QVector<QByteArray> utf8;
+        utf8.reserve(bake.strings.size());
+        quint64 poolSize = 0;
+        for (const QString& s : bake.strings)
+        {
+            utf8.push_back(s.toUtf8());
+            poolSize += quint64(utf8.back().size()) + 1; // NUL-terminated for C callers
+        }
+
+        const QByteArray schemas = SchemaTable(bake);
+        const quint32 dirSize  = ExtensionDirectorySize(bake);
+        const quint64 strOff   = kHeaderSize + dirSize + quint64(schemas.size());
+        const quint64 poolOff  = strOff + quint64(utf8.size()) * kStringIndexEntrySize;
+        const quint64 assetOff = (poolOff + poolSize + kSectionAlignment - 1) & ~quint64(kSectionAlignment - 1);
+        const bool codecs = UsesCodecs(bake, options);
+        const quint32 recordSize = codecs ? kAssetRecordSizeV5Codecs : kAssetRecordSizeV5;
+        const quint64 treeOff  = assetOff + quint64(bake.assets.size()) * recordSize;
+
+        quint64 end = treeOff + quint64(tree.pos());
+
+        QVector<quint64> extOff;
+        for (const Bake::Extension& e : bake.extensions)
+        {
+            end = (end + kSectionAlignment - 1) & ~quint64(kSectionAlignment - 1);
+            extOff.push_back(end);
+            end += quint64(e.data.size());
+        }
+
+        QVector<quint64> blobOff;
+        blobOff.reserve(bake.assets.size());
+        for (const Bake::Asset& a : bake.assets)
+        {
+            if (a.data.isEmpty())
+            {
+                blobOff.push_back(0);
+                continue;
+            }
+            // A shared record's blob is only the owner's index.
+            const quint64 align = a.codec == CODEC_SHARED ? 4 : blobAlign;
+            const quint64 off = (end + align - 1) & ~quint64(align - 1);
+            blobOff.push_back(off);
+            end = off + quint64(a.data.size());
+        }
+
+        if (end > quint64(std::numeric_limits<int>::max()))
+            return QByteArray();
+
+        QByteArray file(qsizetype(end), '\0');
+        char* base = file.data();
+
+        Writer hdr;
+        hdr.Raw(kMagicV5, 4);
+        hdr.U16(kVersionV5);
+        quint16 flags = 0;
+        if (options.mask)
+            flags |= kFlagMasked;
+        if (codecs)
+            flags |= kFlagAssetCodecs;
+        if (dirSize)
+            flags |= kFlagExtensions;
+        if (!schemas.isEmpty())
+            flags |= kFlagSchemas;
+        if (bake.subtreeSizes)
+            flags |= kFlagSubtreeSizes;
+
+        hdr.U16(flags);
+        hdr.U32(quint32(strOff));
+        hdr.U32(quint32(bake.strings.size()));
+        hdr.U32(quint32(assetOff));
+        hdr.U32(quint32(bake.assets.size()));
+        hdr.U32(quint32(treeOff));
+        hdr.U32(quint32(end));
+        std::memcpy(base, hdr.buffer().constData(), kHeaderSize);
+
+        // --- Extension directory + sections ------------------------------
+        if (dirSize)
+        {
+            const QByteArray dir = ExtensionDirectory(bake, extOff);
+            std::memcpy(base + kHeaderSize, dir.constData(), size_t(dir.size()));
+            for (int i = 0; i < bake.extensions.size(); ++i)
+            {
+                const QByteArray& d = bake.extensions[i].data;
+                if (!d.isEmpty())
+                    std::memcpy(base + extOff[i], d.constData(), size_t(d.size()));
+            }
+        }
+
+        // --- Schema table ------------------------------------------------
+        if (!schemas.isEmpty())
+            std::memcpy(base + kHeaderSize + dirSize, schemas.constData(), size_t(schemas.size()));
+
+        // --- String index + pool -----------------------------------------
+        Writer idxW;
+        quint64 cur = poolOff;
+        for (const QByteArray& u : utf8)
+        {
+            idxW.U32(quint32(cur));
+            idxW.U32(quint32(u.size()));
+            std::memcpy(base + cur, u.constData(), size_t(u.size()));
+            cur += quint64(u.size()) + 1;
+        }
+        if (idxW.pos() > 0)
+            std::memcpy(base + strOff, idxW.buffer().constData(), size_t(idxW.pos()));
+
+        // --- Asset records + blobs ---------------------------------------
+        Writer assetW;
+        for (int i = 0; i < bake.assets.size(); ++i)
+        {
+            const Bake::Asset& a = bake.assets[i];
+            assetW.U32(a.domainId);
+            assetW.U32(a.registryId);
+            assetW.U32(quint32(blobOff[i]));
+            assetW.U32(quint32(a.data.size()));
+            if (codecs)
+            {
+                assetW.U8(a.codec);
+                assetW.U8(0);
+                assetW.U16(0);
+                assetW.U32(a.rawSize);
+            }
+            if (!a.data.isEmpty())
+                std::memcpy(base + blobOff[i], a.data.constData(), size_t(a.data.size()));
+        }
+        if (assetW.pos() > 0)
+            std::memcpy(base + assetOff, assetW.buffer().constData(), size_t(assetW.pos()));
+
+        // --- Tree --------------------------------------------------------
+        if (tree.pos() > 0)
+            std::memcpy(base + treeOff, tree.buffer().constData(), size_t(tree.pos()));
+
+        if (options.mask)
+            Obfuscate(base + kHeaderSize, int(end - kHeaderSize));
+
+        return file;
+    }
+
+    // Encodes scenes into one container. A bundle writes every tree back
+    // to back and names them in a SCNS directory; a single Write is the
+    // one-scene case without it. Returns an empty array on failure.
+    QByteArray BakeFile(const QVector<UiBinScene>& scenes, bool bundle, const UiBinWriteOptions& options)
+    {
+        Bake bake;
+        bake.cache = options.assetCache;
+        bake.hashAssets = options.dedupAssets;
+        bake.bakeCache = options.bakeCache;
+        bake.progress = options.progress;
+        bake.aligned = options.layout == UiBinLayout::V5Aligned;
+        bake.useSchemas = options.componentSchemas;
+        bake.subtreeSizes = options.subtreeSizes;
+        bake.Intern(QString()); // id 0 == empty string, by contract
+
+        if (bake.progress)
+        {
+            qint64 elements = 0;
+            for (const UiBinScene& scene : scenes)
+                elements += scene.doc->GetRoot()->findChildren<UiElement*>().size() + 1;
+            bake.progress->Begin(BakeProgress::PHASE_ENCODE, elements);
+        }
+
+        if (bake.bakeCache)
+            bake.bakeCache->BeginBake();
+
+        // Every tree ends 8-aligned in v5, so each scene's root does too.
+        Writer tree;
+        SceneDirectoryBuilder directory;
+        for (const UiBinScene& scene : scenes)
+        {
+            const quint32 offset = quint32(tree.pos());
+            const int firstElement = int(bake.spans.size());
+
+            bake.baseDir = scene.doc->GetBaseDir();
+            WriteElement(bake, tree, scene.doc->GetRoot(), kNoElement);
+
+            if (bundle)
+                directory.Add(bake.Intern(scene.name), offset, quint32(tree.pos()) - offset,
+                              quint32(bake.spans.size() - firstElement));
+        }
+
+        // A partial walk must not prune the cache down to what it reached.
+        if (bake.Cancelled())
+            return QByteArray();
+
+        if (bake.bakeCache)
+            bake.bakeCache->EndBake();
+
+        if (bake.progress)
+            bake.progress->Begin(BakeProgress::PHASE_FINISH);
+
+        if (bundle)
+            bake.extensions.push_back(Bake::Extension { QByteArray(kExtScenes, 4), directory.Section() });
+
+        if (options.dedupAssets)
+            ShareAssetBlobs(bake);
+
+        if (options.packAtlas)
+            BuildAtlas(bake, options);
+
+        if (options.bakeGlyphs)
+            BuildGlyphs(bake, scenes, options);
+
+        if (bake.Cancelled())
+            return QByteArray();
+
+        // TRUN, LAYT and EIDX number elements within one tree.
+        UiElement* root = scenes.first().doc->GetRoot();
+        if (!bundle)
+        {
+            if (options.shapeText)
+                BuildTextRuns(bake, root);
+
+            if (!options.layoutTargets.isEmpty())
+                BuildLayout(bake, root, options);
+
+            if (options.elementIndex)
+                BuildElementIndex(bake);
+        }
+
+        if (options.stringLookup)
+            BuildStringLookup(bake);
+
+        if (options.decodeImages)
+            DecodeImages(bake);
+
+        if (options.compressAssets)
+            CompressAssets(bake);
+
+        if (bake.sharedBlobs)
+            WriteSharedRecords(bake);
+
+        if (bake.Cancelled())
+            return QByteArray();
+
+        return bake.aligned ? AssembleV5(bake, tree, options) : AssembleV4(bake, tree, UsesCodecs(bake, options));
+    }
+
+    bool SaveFile(const QByteArray& file, const QString& filePath)
+    {
+        if (file.isEmpty())
+            return false;
+
+        QFile out(filePath);
+        if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return false;
+
+        out.write(file);
+        out.close();
+
+        return true;
+    }
+}
+
+bool UiBinWriter::Write(const SceneDocument* doc, const QString& filePath, const UiBinWriteOptions& options)
+{
+    if (!doc || !doc->GetRoot())
+        return false;
+
+    return SaveFile(BakeFile({ UiBinScene { QString(), doc } }, false, options), filePath);
+}
+
+bool UiBinWriter::WriteBundle(const QVector<UiBinScene>& scenes, const QString& filePath, const UiBinWriteOptions& options)
+{
+    if (scenes.isEmpty())
+        return false;
+
+    QSet<QString> names;
+    for (const UiBinScene& scene : scenes)
+    {
+        if (!scene.doc || !scene.doc->GetRoot() || names.contains(scene.name))
+            return false;
+        names.insert(scene.name);
+    }
 
-    return true;
+    return SaveFile(BakeFile(scenes, true, options), filePath);
 }
@@ -1,11 +1,128 @@
 #ifndef SCENE_UIBINWRITER_HPP
 #define SCENE_UIBINWRITER_HPP
 
+#include <QSize>
 #include <QString>
+#include <QVector>
 
 class SceneDocument;
+class AssetCache;
+class BakeCache;
+class BakeProgress;
 
-// Bakes a SceneDocument into the custom binary .uibin v4 container.
+// Container layout produced by UiBinWriter (see uibin_format_spec.txt).
+enum class UiBinLayout
+{
+    V4,         // packed, always masked - the default editor format
+    V5Aligned   // aligned sections/scalars/blobs for memory-mapped loading
+};
+
+// Knobs for a single UiBinWriter::Write call. Defaults reproduce the plain
+// editor bake.
+struct UiBinWriteOptions
+{
+    // Shared asset byte cache (see AssetCache). When null, every referenced
+    // file is read from disk for this bake only.
+    AssetCache* assetCache = nullptr;
+
+    // Incremental-bake cache (see BakeCache). When set, only elements whose
+    // inputs changed since the cached bake are re-encoded; the output is
+    // byte-identical to a full bake. Also serves asset reads when no shared
+    // assetCache is given.
+    BakeCache* bakeCache = nullptr;
+
+    // Progress and cancellation for a bake off the GUI thread. The writer
+    // reports the encode and finish phases and stops at its next checkpoint
+    // once cancelled, returning false without writing the file.
+    BakeProgress* progress = nullptr;
+
+    UiBinLayout layout = UiBinLayout::V4;
+
+    // V5Aligned only: apply the XOR mask (v4 is always masked). An unmasked
+    // file can be mapped and read in place with no demask copy.
+    bool mask = true;
+
+    // V5Aligned only: alignment of every asset blob, a power of two >= 8.
+    // 64 suits SIMD/cache-line reads; pass the page size (4096) to let the
+    // runtime map individual blobs.
+    quint32 assetAlignment = 64;
+
+    // zlib-compress asset blobs (qCompress, on the global thread pool) and
+    // mark each record with its codec. Blobs that would not shrink - PNG,
+    // JPG, most fonts' already-compressed tables - are stored raw.
+    bool compressAssets = false;
+
+    // Decode every image asset at bake time into premultiplied RGBA8 rows
+    // behind a width/height/stride/format header (codec CODEC_PIXELS), so a
+    // runtime uploads them with a memcpy - or straight from the mapping with
+    // an unmasked v5 layout. Costs file size: pixels are never compressed.
+    bool decodeImages = false;
+
+    // Store assets with byte-identical content once: later records with
+    // the same bytes keep their own domain/registry identity but carry
+    // codec CODEC_SHARED pointing at the first, so the blob is atlased,
+    // decoded, compressed and read once. Catches the same file reached
+    // through two registry keys or copied under two names.
+    bool dedupAssets = false;
+
+    // Pack Image/Icon/Button imagePath and DragSlot iconPath images into
+    // shared PNG pages of atlasPageSize (at most 65535) square, with
+    // atlasPadding transparent pixels between neighbours. Placements are
+    // written to the ATLS extension section; see UiBinAssetResolver::Atlas.
+    bool packAtlas = false;
+    int atlasPageSize = 2048;
+    int atlasPadding = 2;
+
+    // Rasterize the glyphs used by Text/Button/Dropdown/Tooltip/TextInput
+    // into per-(face, pixel size) coverage pages (same page size and
+    // padding as the atlas) with metrics and kerning, in the GLYF extension
+    // section. A runtime can then draw text without a font library.
+    bool bakeGlyphs = false;
+
+    // Shape every Text/Button label with QTextLayout at bake time and store
+    // glyph ids, positions, advances and the run box in the TRUN extension
+    // section, so a runtime skips shaping and measuring static strings.
+    bool shapeText = false;
+
+    // Resolve the editor layout (anchors, stretch, layout components) once
+    // per target canvas size and store every element's local rect and world
+    // affine in the LAYT extension section, indexed by pre-order element.
+    // Empty: no section.
+    QVector<QSize> layoutTargets;
+
+    // Describe each component type's (name, tag) field list once in a
+    // schema table and write component records as packed values at fixed
+    // offsets behind a schema id, instead of repeating a name id and tag
+    // per field. Components without fields stay in the TLV form.
+    bool componentSchemas = false;
+
+    // Store a hash table from string bytes to string id (64-bit FNV-1a,
+    // open addressing) in the STRH extension section, so a runtime finds a
+    // type, property or element name with one probe.
+    bool stringLookup = false;
+
+    // Store every element sorted by UUID with its record offset, parent and
+    // subtree byte size in the EIDX extension section, so a runtime can
+    // find one element and decode just its subtree.
+    bool elementIndex = false;
+
+    // Follow every child count with the byte size of the children that
+    // come after it (header flag kFlagSubtreeSizes), so a reader can skip
+    // a subtree without decoding it, or decode sibling subtrees on
+    // separate threads. v4 grows by 4 bytes per element; v5 stores the
+    // size in the child count's padding, at no cost.
+    bool subtreeSizes = false;
+};
+
+// One scene of a bundle: the name a runtime loads it by, and its document.
+struct UiBinScene
+{
+    QString name;
+    const SceneDocument* doc = nullptr;
+};
+
+// Bakes a SceneDocument into the custom binary .uibin v4 container, or the
+// aligned v5 profile when options.layout asks for it.
 //
 // imagePath / fontPath / iconPath are NOT encoded. Each is resolved against
 // the document's project root, the file's raw bytes are embedded once in the
@@ -15,7 +132,20 @@ class UiBinWriter
 {
 public:
 
-    static bool Write(const SceneDocument* doc, const QString& filePath);
+    static bool Write(const SceneDocument* doc, const QString& filePath, const UiBinWriteOptions& options = UiBinWriteOptions());
+
+    // Bakes several scenes into one bundle (spec section 11.7): one string
+    // table and one asset table shared by every scene - so a font or icon
+    // the screens have in common is stored once - then the scene trees
+    // back to back, named by a SCNS scene directory. Read one scene with
+    // UiBinBundle or UiBinReader::ReadScene; a plain Read gets the first.
+    //
+    // Each document's assets resolve against its own base directory. The
+    // per-tree sections (shapeText, layoutTargets, elementIndex) are not
+    // written to bundles; every other option applies as in Write. Returns
+    // false for an empty list, a null document or a repeated name.
+    static bool WriteBundle(const QVector<UiBinScene>& scenes, const QString& filePath,
+                            const UiBinWriteOptions& options = UiBinWriteOptions());
 };
 
 #endif